@@ -106,7 +106,9 @@ BINDIST_MANIFEST = [
     "examples/ex_askusingform.py",
     "examples/ex_uihook.py",
     "examples/ex_idphook_asm.py",
-    "examples/ex_imports.py"
+    "examples/ex_imports.py",
+    "examples/ex_script_overhead.py",
+    "examples/ex_gil_release.py"
 ]
 
 # -----------------------------------------------------------------------
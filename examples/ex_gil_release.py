@@ -0,0 +1,84 @@
+# -------------------------------------------------------------------------
+# This is an example measuring how background Python threads progress
+# while the main thread reads memory with get_many_bytes() and, if a
+# process is suspended, dbg_read_memory().
+#
+# Those functions release the GIL while IDA reads the memory, so the
+# background threads keep running during the reads. Before, they were
+# stalled until each read was over: their progress during the reads was
+# close to nothing.
+#
+# Load a database (and optionally suspend a process), then run the script.
+
+import threading
+import time
+import idaapi
+
+# -------------------------------------------------------------------------
+class worker_t(threading.Thread):
+    """A background thread doing pure Python work"""
+    def __init__(self):
+        threading.Thread.__init__(self)
+        self.daemon = True
+        self.count = 0
+        self.stop = False
+
+    def run(self):
+        while not self.stop:
+            t = 0
+            for i in xrange(1000):
+                t += i & 7
+            self.count += 1
+
+# -------------------------------------------------------------------------
+def measure(reader, nthreads, duration):
+    """
+    Runs 'reader' in a loop in the main thread for 'duration' seconds, with
+    'nthreads' background workers.
+    @return: tuple(number of reads, number of work units of the workers)
+    """
+    workers = [worker_t() for i in xrange(nthreads)]
+    for w in workers:
+        w.start()
+    reads = 0
+    t0 = time.time()
+    try:
+        while time.time() - t0 < duration:
+            reader()
+            reads += 1
+    finally:
+        for w in workers:
+            w.stop = True
+        for w in workers:
+            w.join()
+    return reads, sum(w.count for w in workers)
+
+# -------------------------------------------------------------------------
+def report(name, reader, nthreads, duration, idle):
+    reads, work = measure(reader, nthreads, duration)
+    print("%-18s %8d reads %8d work units (%5.1f%% of idle)" % (
+          name, reads, work, 100.0 * work / max(idle, 1)))
+
+# -------------------------------------------------------------------------
+def main(size=0x100000, nthreads=4, duration=2.0):
+    # The workers alone, the main thread sleeping: the reference throughput
+    idle = measure(lambda: time.sleep(0.01), nthreads, duration)[1]
+    print("%-18s %8s       %8d work units" % ("idle", "", idle))
+
+    ea = idaapi.get_first_seg().startEA
+    sz = min(size, idaapi.get_last_seg().endEA - ea)
+    report("get_many_bytes", lambda: idaapi.get_many_bytes(ea, sz), nthreads, duration, idle)
+
+    if idaapi.dbg_can_query() and idaapi.get_process_state() == idaapi.DSTATE_SUSP:
+        # (while debugging, the screen ea follows the instruction pointer)
+        page = idaapi.get_screen_ea() & ~0xFFF
+        report("dbg_read_memory", lambda: idaapi.dbg_read_memory(page, 0x1000), nthreads, duration, idle)
+        was = idaapi.dbg_enable_memory_cache(True)
+        try:
+            report("  (cached)", lambda: idaapi.dbg_read_memory(page, 0x1000), nthreads, duration, idle)
+        finally:
+            idaapi.dbg_enable_memory_cache(was)
+
+# -------------------------------------------------------------------------
+if __name__ == '__main__':
+    main()
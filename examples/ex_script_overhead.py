@@ -0,0 +1,48 @@
+# -------------------------------------------------------------------------
+# This is an example measuring the overhead of the script interruption
+# mechanism on a CPU bound script.
+#
+# Scripts are made breakable by a watchdog thread that periodically asks
+# the interpreter to check for Cancel. Earlier versions installed a trace
+# function that was called on every line; the second measurement emulates
+# this with a do-nothing line tracer (a Python tracer costs more than the
+# native one did, so that figure is an upper bound).
+#
+# Run it with File/Script file... so that the script timeout is active.
+
+import sys
+import time
+
+# -------------------------------------------------------------------------
+def work(n):
+    t = 0
+    for i in xrange(n):
+        t += i & 7
+    return t
+
+# -------------------------------------------------------------------------
+def tracer(frame, event, arg):
+    return tracer
+
+# -------------------------------------------------------------------------
+def measure(n, traced):
+    if traced:
+        sys.settrace(tracer)
+    try:
+        t0 = time.time()
+        work(n)
+        return time.time() - t0
+    finally:
+        if traced:
+            sys.settrace(None)
+
+# -------------------------------------------------------------------------
+def main(n=5000000, rounds=3):
+    plain = min(measure(n, False) for i in xrange(rounds))
+    traced = min(measure(n, True) for i in xrange(rounds))
+    print("watchdog (current):   %.3fs" % plain)
+    print("per-line trace:       %.3fs (x%.1f)" % (traced, traced / plain))
+
+# -------------------------------------------------------------------------
+if __name__ == '__main__':
+    main()
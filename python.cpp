@@ -11,6 +11,7 @@
 // python.cpp - Main plugin code
 //---------------------------------------------------------------------
 #include <Python.h>
+#include <frameobject.h>
 
 //-------------------------------------------------------------------------
 // This define fixes the redefinition of ssize_t
@@ -24,6 +25,8 @@
 #ifdef __MAC__
 #include <mach-o/dyld.h>
 #endif
+#include <list>
+#include <map>
 #include <ida.hpp>
 #include <idp.hpp>
 #include <expr.hpp>
@@ -85,36 +88,350 @@ extern "C" void init_idaapi(void);
 void idaapi run(int arg);
 
 //-------------------------------------------------------------------------
-// This is a simple tracing code for debugging purposes.
-// It might evolve into a tracing facility for user scripts.
+// Sampling profiler
+//
+// A background thread asks the interpreter for a sample every 'interval'
+// milliseconds with Py_AddPendingCall(). The sample is taken on the main
+// thread between two bytecodes, where the frame stack can be walked safely.
+// A profile function, which only looks at C calls, measures the time spent
+// in native functions (_idaapi and other builtins): long native calls are
+// recorded as samples of their own, the time of short ones is accumulated
+// and credited with the next sample. When a native function calls back
+// into Python (execfile(), map() with a lambda, ...), the time spent in the
+// Python code is not charged to it: only the innermost native call is.
+// Samples are aggregated per collapsed stack (the input of flame graph
+// tools), per function and per line.
+struct prof_func_stats_t
+{
+  uint64 self;
+  uint64 total;
+  prof_func_stats_t() : self(0), total(0) {}
+};
+typedef std::map<qstring, uint64> prof_counters_t;
+typedef std::map<qstring, prof_func_stats_t> prof_func_stats_map_t;
+
+// A native call in progress
+struct prof_native_call_t
+{
+  uint64 start;             // start of the running interval
+  uint64 elapsed;           // time accumulated by the previous intervals
+  PyFrameObject *callback;  // the Python frame it called, if suspended
+};
+
+struct profiler_t
+{
+  volatile bool running;
+  volatile bool stop;
+  volatile bool sample_pending;
+  int interval_ms;
+  uint64 interval_ns;
+  qthread_t thread;
+  qsemaphore_t sem;
+
+  // Native calls (only accessed from the main thread)
+  qvector<prof_native_call_t> native_calls;
+  uint64 short_native_ns;
+  const char *short_native_name;
+
+  // Collected samples
+  uint64 python_samples;
+  uint64 native_samples;
+  prof_counters_t stacks;
+  prof_counters_t lines;
+  prof_counters_t natives;
+  prof_func_stats_map_t funcs;
+};
+static profiler_t g_profiler;
+static bool g_profiler_enabled = false;   // profile from plugin start to IDA exit
+static int g_profiler_interval = 1;       // milliseconds
+static qstring g_profiler_output;         // collapsed stacks file (PROFILER_ENABLED)
 
-//#define ENABLE_PYTHON_PROFILING
-#ifdef ENABLE_PYTHON_PROFILING
-#include "compile.h"
-#include "frameobject.h"
+//-------------------------------------------------------------------------
+static void get_frame_func_name(qstring *out, PyFrameObject *f)
+{
+  PyCodeObject *code = f->f_code;
+  const char *file = PyString_Check(code->co_filename) ? PyString_AS_STRING(code->co_filename) : "?";
+  const char *name = PyString_Check(code->co_name) ? PyString_AS_STRING(code->co_name) : "?";
+  out->sprnt("%s (%s:%d)", name, qbasename(file), code->co_firstlineno);
+}
 
-int tracefunc(PyObject *obj, _frame *frame, int what, PyObject *arg)
+//-------------------------------------------------------------------------
+// Adds 'weight' samples for the given stack
+// 'native_name' is the native function called by the innermost frame (if any)
+static void profiler_record(
+        PyFrameObject *frame,
+        const char *native_name,
+        uint64 weight)
 {
-    PyObject *str;
+  profiler_t &p = g_profiler;
+
+  // Innermost frame first
+  qvector<qstring> names;
+  for ( PyFrameObject *f = frame; f != NULL; f = f->f_back )
+    get_frame_func_name(&names.push_back(), f);
+  if ( names.empty() && native_name == NULL )
+    return;
+
+  qstring stack;
+  for ( size_t i=names.size(); i > 0; i-- )
+  {
+    const qstring &name = names[i-1];
+    if ( !stack.empty() )
+      stack.append(';');
+    stack.append(name);
+
+    // Count recursive functions once per sample
+    bool seen = false;
+    for ( size_t j=names.size(); j > i && !seen; j-- )
+      seen = names[j-1] == name;
+    if ( !seen )
+      p.funcs[name].total += weight;
+  }
+
+  if ( native_name != NULL )
+  {
+    if ( !stack.empty() )
+      stack.append(';');
+    stack.append("[native] ");
+    stack.append(native_name);
+    p.natives[native_name] += weight;
+    p.native_samples += weight;
+  }
+  else
+  {
+    p.funcs[names[0]].self += weight;
+    PyCodeObject *code = frame->f_code;
+    qstring line;
+    line.sprnt("%s:%d",
+               PyString_Check(code->co_filename) ? PyString_AS_STRING(code->co_filename) : "?",
+               PyFrame_GetLineNumber(frame));
+    p.lines[line] += weight;
+    p.python_samples += weight;
+  }
+  p.stacks[stack] += weight;
+}
 
-    /* Catch line change events. */
-    /* Print the filename and line number */
-    if ( what == PyTrace_LINE )
+//-------------------------------------------------------------------------
+// Profile function: measures the native calls
+static int profiler_hook(PyObject *, PyFrameObject *frame, int what, PyObject *arg)
+{
+  profiler_t &p = g_profiler;
+  if ( what == PyTrace_C_CALL )
+  {
+    prof_native_call_t &nc = p.native_calls.push_back();
+    nc.start = get_nsec_stamp();
+    nc.elapsed = 0;
+    nc.callback = NULL;
+  }
+  else if ( what == PyTrace_CALL )
+  {
+    // A native function calling back into Python: suspend its interval
+    if ( !p.native_calls.empty() && p.native_calls.back().callback == NULL )
     {
-        str = PyObject_Str(frame->f_code->co_filename);
-        if ( str )
-        {
-            msg("PROFILING: %s:%d\n", PyString_AsString(str), frame->f_lineno);
-            Py_DECREF(str);
-        }
+      prof_native_call_t &nc = p.native_calls.back();
+      nc.elapsed += get_nsec_stamp() - nc.start;
+      nc.callback = frame;
     }
+  }
+  else if ( what == PyTrace_RETURN )
+  {
+    // Back from the callback: resume the interval
+    if ( !p.native_calls.empty() && p.native_calls.back().callback == frame )
+    {
+      prof_native_call_t &nc = p.native_calls.back();
+      nc.start = get_nsec_stamp();
+      nc.callback = NULL;
+    }
+  }
+  else if ( (what == PyTrace_C_RETURN || what == PyTrace_C_EXCEPTION) && !p.native_calls.empty() )
+  {
+    const prof_native_call_t &nc = p.native_calls.back();
+    uint64 elapsed = nc.elapsed;
+    if ( nc.callback == NULL )
+      elapsed += get_nsec_stamp() - nc.start;
+    p.native_calls.pop_back();
+
+    const char *name = PyCFunction_Check(arg) ? ((PyCFunctionObject *)arg)->m_ml->ml_name : "?";
+    if ( elapsed >= p.interval_ns )
+    {
+      profiler_record(frame, name, (elapsed + p.interval_ns / 2) / p.interval_ns);
+    }
+    else
+    {
+      p.short_native_ns += elapsed;
+      p.short_native_name = name;
+    }
+  }
+  return 0;
+}
+
+//-------------------------------------------------------------------------
+// This pending call is run by the interpreter on the main thread
+static int profiler_sample(void *)
+{
+  profiler_t &p = g_profiler;
+  p.sample_pending = false;
+  if ( !p.running )
     return 0;
+
+  PyFrameObject *frame = PyThreadState_GET()->frame;
+  if ( p.short_native_ns >= p.interval_ns )
+  {
+    profiler_record(frame, p.short_native_name, p.short_native_ns / p.interval_ns);
+    p.short_native_ns %= p.interval_ns;
+  }
+  profiler_record(frame, NULL, 1);
+  return 0;
+}
+
+//-------------------------------------------------------------------------
+static int idaapi profiler_thread(void *)
+{
+  profiler_t &p = g_profiler;
+  while ( !p.stop )
+  {
+    qsem_wait(p.sem, p.interval_ms);
+    if ( p.running && !p.sample_pending )
+    {
+      p.sample_pending = true;
+      if ( Py_AddPendingCall(profiler_sample, NULL) != 0 )
+        p.sample_pending = false;
+    }
+  }
+  return 0;
+}
+
+//-------------------------------------------------------------------------
+//lint -esym(714,profiler_start) Symbol not referenced
+bool profiler_start(int interval_ms)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  profiler_t &p = g_profiler;
+  if ( p.running )
+    return false;
+
+  if ( interval_ms <= 0 )
+    interval_ms = g_profiler_interval > 0 ? g_profiler_interval : 1;
+  p.interval_ms = interval_ms;
+  p.interval_ns = uint64(interval_ms) * 1000000;
+  p.native_calls.qclear();
+  p.short_native_ns = 0;
+  p.short_native_name = NULL;
+  p.python_samples = 0;
+  p.native_samples = 0;
+  p.stacks.clear();
+  p.lines.clear();
+  p.natives.clear();
+  p.funcs.clear();
+
+  p.stop = false;
+  p.sample_pending = false;
+  p.sem = qsem_create(NULL, 0);
+  p.thread = qthread_create(profiler_thread, NULL);
+  if ( p.thread == NULL )
+  {
+    qsem_free(p.sem);
+    p.sem = NULL;
+    return false;
+  }
+  p.running = true;
+  PyEval_SetProfile(profiler_hook, NULL);
+  return true;
+}
+
+//-------------------------------------------------------------------------
+static bool stop_profiler()
+{
+  profiler_t &p = g_profiler;
+  if ( !p.running )
+    return false;
+
+  p.running = false;
+  PyEval_SetProfile(NULL, NULL);
+  p.stop = true;
+  qsem_post(p.sem);
+  qthread_join(p.thread);
+  qthread_free(p.thread);
+  qsem_free(p.sem);
+  p.thread = NULL;
+  p.sem = NULL;
+  return true;
+}
+
+//-------------------------------------------------------------------------
+// Writes the samples as collapsed stacks ("f1;f2;f3 count" lines)
+static bool write_profile(const char *path)
+{
+  FILE *fp = qfopen(path, "w");
+  if ( fp == NULL )
+    return false;
+
+  const prof_counters_t &stacks = g_profiler.stacks;
+  for ( prof_counters_t::const_iterator it=stacks.begin(); it != stacks.end(); ++it )
+    qfprintf(fp, "%s %" FMT_64 "u\n", it->first.c_str(), it->second);
+  qfclose(fp);
+  return true;
+}
+
+//-------------------------------------------------------------------------
+static PyObject *prof_counters_to_dict(const prof_counters_t &counters)
+{
+  PyObject *py_dict = PyDict_New();
+  if ( py_dict == NULL )
+    return NULL;
+  for ( prof_counters_t::const_iterator it=counters.begin(); it != counters.end(); ++it )
+  {
+    newref_t py_count(PyLong_FromUnsignedLongLong(it->second));
+    if ( py_count == NULL || PyDict_SetItemString(py_dict, it->first.c_str(), py_count.o) != 0 )
+    {
+      Py_DECREF(py_dict);
+      return NULL;
+    }
+  }
+  return py_dict;
+}
+
+//-------------------------------------------------------------------------
+//lint -esym(714,profiler_stop) Symbol not referenced
+PyObject *profiler_stop(const char *path)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( !stop_profiler() )
+    Py_RETURN_NONE;
+
+  if ( path != NULL && path[0] != '\0' && !write_profile(path) )
+    msg("IDAPython: could not write the profile to '%s'\n", path);
+
+  const profiler_t &p = g_profiler;
+  newref_t py_funcs(PyDict_New());
+  if ( py_funcs == NULL )
+    return NULL;
+  for ( prof_func_stats_map_t::const_iterator it=p.funcs.begin(); it != p.funcs.end(); ++it )
+  {
+    newref_t py_stats(Py_BuildValue("(KK)",
+                                    (unsigned PY_LONG_LONG)it->second.self,
+                                    (unsigned PY_LONG_LONG)it->second.total));
+    if ( py_stats == NULL || PyDict_SetItemString(py_funcs.o, it->first.c_str(), py_stats.o) != 0 )
+      return NULL;
+  }
+
+  newref_t py_lines(prof_counters_to_dict(p.lines));
+  if ( py_lines == NULL )
+    return NULL;
+  newref_t py_natives(prof_counters_to_dict(p.natives));
+  if ( py_natives == NULL )
+    return NULL;
+
+  return Py_BuildValue("{s:K,s:K,s:O,s:O,s:O}",
+                       "python", (unsigned PY_LONG_LONG)p.python_samples,
+                       "native", (unsigned PY_LONG_LONG)p.native_samples,
+                       "functions", py_funcs.o,
+                       "lines", py_lines.o,
+                       "native_calls", py_natives.o);
 }
-#endif
 
 //-------------------------------------------------------------------------
 // Helper routines to make Python script execution breakable from IDA
-static int    ninsns = 0;      // number of times trace function was called
 static bool   box_displayed;  // has the wait box been displayed?
 static time_t start_time;   // the start time of the execution
 static int    script_timeout = 2;
@@ -122,24 +439,39 @@ static bool   g_ui_ready = false;
 static bool   g_alert_auto_scripts = true;
 static bool   g_remove_cwd_sys_path = false;
 static bool   g_use_local_python    = false;
+static size_t g_code_cache_size     = 64;
 
 static void end_execution(void);
 static void begin_execution(void);
 
 //------------------------------------------------------------------------
-// This callback is called on various interpreter events
-static int break_check(PyObject *obj, _frame *frame, int what, PyObject *arg)
+// Tracing every line to detect Cancel slows scripts down a lot.
+// Instead, while a script is executing, a watchdog thread periodically
+// schedules break_check() with Py_AddPendingCall(). The interpreter runs
+// it on the main thread between two bytecodes, where it is safe to check
+// for Cancel and to show the wait box.
+#define WATCHDOG_PERIOD_MS 100
+static volatile bool g_executing = false;   // is a breakable execution in progress?
+static volatile bool g_watchdog_stop = false;
+static volatile bool g_break_check_pending = false;
+static qthread_t g_watchdog = NULL;
+static qsemaphore_t g_watchdog_sem = NULL;
+
+//------------------------------------------------------------------------
+// This pending call is run by the interpreter on the main thread
+static int break_check(void *)
 {
+  g_break_check_pending = false;
+  if ( !g_executing )
+    return 0;
+
   if ( wasBreak() )
   {
     // User pressed Cancel in the waitbox; send KeyboardInterrupt exception
     PyErr_SetInterrupt();
   }
-  else if ( !box_displayed && ++ninsns > 10 )
+  else if ( !box_displayed )
   {
-    // We check the timer once every 10 calls
-    ninsns = 0;
-
     // Timeout disabled or elapsed?
     if ( script_timeout != 0 && (time(NULL) - start_time > script_timeout) )
     {
@@ -147,22 +479,62 @@ static int break_check(PyObject *obj, _frame *frame, int what, PyObject *arg)
       show_wait_box("Running Python script");
     }
   }
-#ifdef ENABLE_PYTHON_PROFILING
-  return tracefunc(obj, frame, what, arg);
-#else
-  qnotused(obj);
-  qnotused(frame);
-  qnotused(what);
-  qnotused(arg);
   return 0;
-#endif
+}
+
+//------------------------------------------------------------------------
+static int idaapi watchdog_thread(void *)
+{
+  while ( !g_watchdog_stop )
+  {
+    // Sleep until begin_execution() or stop_watchdog() wakes us up
+    if ( !g_executing )
+    {
+      qsem_wait(g_watchdog_sem, -1);
+      continue;
+    }
+    qsem_wait(g_watchdog_sem, WATCHDOG_PERIOD_MS);
+    if ( g_executing && !g_break_check_pending )
+    {
+      // Py_AddPendingCall() does not require the GIL
+      g_break_check_pending = true;
+      if ( Py_AddPendingCall(break_check, NULL) != 0 )
+        g_break_check_pending = false;
+    }
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------
+static void start_watchdog()
+{
+  if ( g_watchdog != NULL )
+    return;
+
+  g_watchdog_stop = false;
+  g_watchdog_sem = qsem_create(NULL, 0);
+  g_watchdog = qthread_create(watchdog_thread, NULL);
+}
+
+//------------------------------------------------------------------------
+static void stop_watchdog()
+{
+  if ( g_watchdog == NULL )
+    return;
+
+  g_watchdog_stop = true;
+  qsem_post(g_watchdog_sem);
+  qthread_join(g_watchdog);
+  qthread_free(g_watchdog);
+  qsem_free(g_watchdog_sem);
+  g_watchdog = NULL;
+  g_watchdog_sem = NULL;
 }
 
 //------------------------------------------------------------------------
 static void reset_execution_time()
 {
   start_time = time(NULL);
-  ninsns = 0;
 }
 
 //------------------------------------------------------------------------
@@ -175,7 +547,9 @@ static void begin_execution()
   PYW_GIL_CHECK_LOCKED_SCOPE();
   end_execution();
   reset_execution_time();
-  PyEval_SetTrace(break_check, NULL);
+  start_watchdog();
+  g_executing = true;
+  qsem_post(g_watchdog_sem);
 }
 
 //---------------------------------------------------------------------------
@@ -192,13 +566,8 @@ static void hide_script_waitbox()
 // Called after Python execution finishes
 static void end_execution()
 {
+  g_executing = false;
   hide_script_waitbox();
-  PYW_GIL_CHECK_LOCKED_SCOPE();
-#ifdef ENABLE_PYTHON_PROFILING
-  PyEval_SetTrace(tracefunc, NULL);
-#else
-  PyEval_SetTrace(NULL, NULL);
-#endif
 }
 
 //-------------------------------------------------------------------------
@@ -208,7 +577,7 @@ void disable_script_timeout()
   // Clear timeout
   script_timeout = 0;
 
-  // Uninstall the trace function and hide the waitbox (if it was shown)
+  // Stop the break checks and hide the waitbox (if it was shown)
   end_execution();
 }
 
@@ -254,6 +623,105 @@ static PyObject *GetMainGlobals()
   return module == NULL ? NULL : PyModule_GetDict(module);
 }
 
+//-------------------------------------------------------------------------
+// Cache of compiled code objects used by the extlang compile and calcexpr
+// callbacks: IDC tends to evaluate the same small expressions many times.
+// The code objects are kept in LRU order and looked up by compile mode
+// and source text.
+struct code_cache_entry_t
+{
+  qstring key;
+  ref_t code;
+};
+typedef std::list<code_cache_entry_t> code_cache_lru_t;
+typedef std::map<qstring, code_cache_lru_t::iterator> code_cache_map_t;
+
+static code_cache_lru_t code_cache_lru; // most recently used first
+static code_cache_map_t code_cache_map;
+static uint64 code_cache_hits = 0;
+static uint64 code_cache_misses = 0;
+
+//-------------------------------------------------------------------------
+static void trim_code_cache(size_t maxsize)
+{
+  while ( code_cache_lru.size() > maxsize )
+  {
+    code_cache_map.erase(code_cache_lru.back().key);
+    code_cache_lru.pop_back();
+  }
+}
+
+//-------------------------------------------------------------------------
+// Compiles the string or returns the cached code object for it
+// The returned reference is new. The code object must not be modified.
+static PyCodeObject *compile_string_cached(const char *str, int mode)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( g_code_cache_size == 0 )
+    return (PyCodeObject *)Py_CompileString(str, "<string>", mode);
+
+  char prefix[16];
+  qsnprintf(prefix, sizeof(prefix), "%d:", mode);
+  qstring key(prefix);
+  key.append(str);
+
+  code_cache_map_t::iterator p = code_cache_map.find(key);
+  if ( p != code_cache_map.end() )
+  {
+    ++code_cache_hits;
+    code_cache_lru.splice(code_cache_lru.begin(), code_cache_lru, p->second);
+    PyObject *code = p->second->code.o;
+    Py_INCREF(code);
+    return (PyCodeObject *)code;
+  }
+
+  ++code_cache_misses;
+  PyObject *code = Py_CompileString(str, "<string>", mode);
+  if ( code == NULL )
+    return NULL;
+
+  code_cache_lru.push_front(code_cache_entry_t());
+  code_cache_entry_t &e = code_cache_lru.front();
+  e.key.swap(key);
+  e.code = borref_t(code);
+  code_cache_map[e.key] = code_cache_lru.begin();
+  trim_code_cache(g_code_cache_size);
+  return (PyCodeObject *)code;
+}
+
+//-------------------------------------------------------------------------
+//lint -esym(714,get_code_cache_stats) Symbol not referenced
+PyObject *get_code_cache_stats()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  return Py_BuildValue("(KKnn)",
+                       (unsigned PY_LONG_LONG)code_cache_hits,
+                       (unsigned PY_LONG_LONG)code_cache_misses,
+                       Py_ssize_t(code_cache_lru.size()),
+                       Py_ssize_t(g_code_cache_size));
+}
+
+//-------------------------------------------------------------------------
+//lint -esym(714,clear_code_cache) Symbol not referenced
+void clear_code_cache()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  trim_code_cache(0);
+  code_cache_hits = 0;
+  code_cache_misses = 0;
+}
+
+//-------------------------------------------------------------------------
+//lint -esym(714,set_code_cache_size) Symbol not referenced
+int set_code_cache_size(int size)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  int old_size = int(g_code_cache_size);
+  g_code_cache_size = size < 0 ? 0 : size_t(size);
+  trim_code_cache(g_code_cache_size);
+  return old_size;
+}
+
 //------------------------------------------------------------------------
 static void PythonEvalOrExec(
     const char *str,
@@ -375,6 +843,29 @@ const char *idaapi set_python_options(
         g_use_local_python = *(uval_t *)value != 0;
         break;
       }
+      else if ( qstrcmp(keyword, "CODE_CACHE_SIZE") == 0 )
+      {
+        g_code_cache_size = size_t(*(uval_t *)value);
+        break;
+      }
+      else if ( qstrcmp(keyword, "PROFILER_ENABLED") == 0 )
+      {
+        g_profiler_enabled = *(uval_t *)value != 0;
+        break;
+      }
+      else if ( qstrcmp(keyword, "PROFILER_INTERVAL") == 0 )
+      {
+        g_profiler_interval = int(*(uval_t *)value);
+        break;
+      }
+    }
+    else if ( value_type == IDPOPT_STR )
+    {
+      if ( qstrcmp(keyword, "PROFILER_OUTPUT") == 0 )
+      {
+        g_profiler_output = (const char *)value;
+        break;
+      }
     }
     return IDPOPT_BADKEY;
   } while (false);
@@ -649,7 +1140,7 @@ bool idaapi IDAPython_extlang_compile(
   PYW_GIL_GET;
   PyObject *globals = GetMainGlobals();
 
-  PyCodeObject *code = (PyCodeObject *)Py_CompileString(expr, "<string>", Py_eval_input);
+  newref_t code((PyObject *)compile_string_cached(expr, Py_eval_input));
   if ( code == NULL )
   {
     handle_python_error(errbuf, errbufsize);
@@ -657,28 +1148,125 @@ bool idaapi IDAPython_extlang_compile(
   }
 
   // Set the desired function name
-  Py_XDECREF(code->co_name);
-  code->co_name = PyString_FromString(name);
+  // The cached code object is shared, so a renamed copy is used
+  PyCodeObject *c = (PyCodeObject *)code.o;
+  newref_t py_name(PyString_FromString(name));
+  newref_t named_code((PyObject *)PyCode_New(
+                            c->co_argcount,
+                            c->co_nlocals,
+                            c->co_stacksize,
+                            c->co_flags,
+                            c->co_code,
+                            c->co_consts,
+                            c->co_names,
+                            c->co_varnames,
+                            c->co_freevars,
+                            c->co_cellvars,
+                            c->co_filename,
+                            py_name.o,
+                            c->co_firstlineno,
+                            c->co_lnotab));
 
   // Create a function out of code
-  PyObject *func = PyFunction_New((PyObject *)code, globals);
-
-  if ( func == NULL )
+  newref_t func(named_code == NULL ? NULL : PyFunction_New(named_code.o, globals));
+  if ( func == NULL || PyDict_SetItemString(globals, name, func.o) != 0 )
   {
-ERR:
     handle_python_error(errbuf, errbufsize);
-    Py_XDECREF(code);
     return false;
   }
 
-  int err = PyDict_SetItemString(globals, name, func);
-  Py_XDECREF(func);
-  if ( err )
-    goto ERR;
-
   return true;
 }
 
+//-------------------------------------------------------------------------
+// Cache of the callables resolved by IDAPython_extlang_run(), keyed by the
+// full "modname.funcname" name.
+// An entry is used only while its module is still the one registered in
+// sys.modules and the function is still bound to the same name in it:
+// reloading the module or redefining the function makes the entry stale
+// and the name is resolved again.
+struct extlang_callable_t
+{
+  ref_t py_modname;
+  ref_t py_funcname;
+  ref_t module;
+  ref_t func;
+};
+typedef std::map<qstring, extlang_callable_t> extlang_callables_t;
+static extlang_callables_t extlang_callables;
+#define MAX_EXTLANG_CALLABLES 1024
+
+//-------------------------------------------------------------------------
+static void clear_extlang_callables()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  extlang_callables.clear();
+}
+
+//-------------------------------------------------------------------------
+static bool is_extlang_callable_current(const extlang_callable_t &c)
+{
+  return PyDict_GetItem(PyImport_GetModuleDict(), c.py_modname.o) == c.module.o
+      && PyDict_GetItem(PyModule_GetDict(c.module.o), c.py_funcname.o) == c.func.o;
+}
+
+//-------------------------------------------------------------------------
+// Returns the callable designated by "funcname" (in __main__) or
+// "modname.funcname", importing the module if needed
+static const extlang_callable_t *resolve_extlang_callable(
+  const char *name,
+  char *errbuf,
+  size_t errbufsize)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  qstring key(name);
+  extlang_callables_t::iterator p = extlang_callables.find(key);
+  if ( p != extlang_callables.end() && is_extlang_callable_current(p->second) )
+    return &p->second;
+
+  // Extract the module name (if any) from the function name
+  const char *dot = strchr(name, '.');
+  qstring modname = dot == NULL ? qstring(S_MAIN) : qstring(name, dot - name);
+  const char *funcname = dot == NULL ? name : dot + 1;
+
+  ref_t module;
+  if ( dot != NULL )
+    module = newref_t(PyImport_ImportModule(modname.c_str()));
+  else
+    module = borref_t(PyImport_AddModule(S_MAIN));
+  if ( module == NULL || !PyModule_Check(module.o) )
+  {
+    handle_python_error(errbuf, errbufsize);
+    if ( errbuf[0] == '\0' )
+      qsnprintf(errbuf, errbufsize, "Could not import module '%s'!", modname.c_str());
+    return NULL;
+  }
+
+  newref_t py_funcname(PyString_InternFromString(funcname));
+  PyObject *func = PyDict_GetItem(PyModule_GetDict(module.o), py_funcname.o);
+  if ( func == NULL )
+  {
+    qsnprintf(errbuf, errbufsize, "undefined function %s", name);
+    return NULL;
+  }
+
+  // Importing the module ran Python code, which may have re-entered
+  // this function and modified (or flushed) the cache: look it up again
+  p = extlang_callables.find(key);
+  if ( p == extlang_callables.end() )
+  {
+    if ( extlang_callables.size() >= MAX_EXTLANG_CALLABLES )
+      extlang_callables.clear();
+    p = extlang_callables.insert(std::make_pair(key, extlang_callable_t())).first;
+  }
+  extlang_callable_t &c = p->second;
+  c.py_modname = newref_t(PyString_InternFromString(modname.c_str()));
+  c.py_funcname = py_funcname;
+  c.module = module;
+  c.func = borref_t(func);
+  return &c;
+}
+
 //-------------------------------------------------------------------------
 // Run callback for Python external language evaluator
 bool idaapi IDAPython_extlang_run(
@@ -690,57 +1278,22 @@ bool idaapi IDAPython_extlang_run(
   size_t errbufsize)
 {
   PYW_GIL_GET;
-  // Try to extract module name (if any) from the funcname
-  char modname[MAXSTR] = {0};
-  char funcname[MAXSTR] = {0};
-  bool imported_module = parse_py_modname(name, modname, funcname, MAXSTR);
 
-  bool ok = true;
-  PyObject *module = NULL;
+  // Convert arguments to python
   ref_vec_t pargs;
-  do
-  {
-    // Convert arguments to python
-    ok = pyw_convert_idc_args(args, nargs, pargs, false, errbuf, errbufsize);
-    if ( !ok )
-      break;
-
-    if ( imported_module )
-    {
-      module = PyImport_ImportModule(modname);
-    }
-    else
-    {
-      module = PyImport_AddModule(S_MAIN);
-      QASSERT(30156, module != NULL);
-    }
-
-    PyObject *globals = PyModule_GetDict(module);
-    QASSERT(30157, globals != NULL);
-
-    PyObject *func = PyDict_GetItemString(globals, funcname);
-    if ( func == NULL )
-    {
-      qsnprintf(errbuf, errbufsize, "undefined function %s", name);
-      ok = false;
-      break;
-    }
+  if ( !pyw_convert_idc_args(args, nargs, pargs, true, errbuf, errbufsize) )
+    return false;
 
-    borref_t code(PyFunction_GetCode(func));
-    qvector<PyObject*> pargs_ptrs;
-    pargs.to_pyobject_pointers(&pargs_ptrs);
-    newref_t py_res(PyEval_EvalCodeEx(
-                            (PyCodeObject*) code.o,
-                            globals, NULL,
-                            pargs_ptrs.begin(),
-                            nargs,
-                            NULL, 0, NULL, 0, NULL));
-    ok = return_python_result(result, py_res, errbuf, errbufsize);
-  } while ( false );
+  const extlang_callable_t *c = resolve_extlang_callable(name, errbuf, errbufsize);
+  if ( c == NULL )
+    return false;
 
-  if ( imported_module )
-    Py_XDECREF(module);
-  return ok;
+  // Call the function object (and not just its code), so that
+  // default arguments and closures are honoured.
+  // The reference is held because the call may flush the cache.
+  ref_t func(c->func);
+  newref_t py_res(PyObject_CallObject(func.o, pargs.empty() ? NULL : pargs[0].o));
+  return return_python_result(result, py_res, errbuf, errbufsize);
 }
 
 //-------------------------------------------------------------------------
@@ -1020,7 +1573,9 @@ bool idaapi IDAPython_extlang_calcexpr(
   if ( ok )
   {
     begin_execution();
-    result = newref_t(PyRun_String(expr, Py_eval_input, globals, globals));
+    newref_t code((PyObject *)compile_string_cached(expr, Py_eval_input));
+    if ( code != NULL )
+      result = newref_t(PyEval_EvalCode((PyCodeObject *)code.o, globals, globals));
     end_execution();
     ok = return_python_result(rv, result, errbuf, errbufsize);
   }
@@ -1515,9 +2070,9 @@ bool IDAPython_Init(void)
     return false;
   }
 
-#ifdef ENABLE_PYTHON_PROFILING
-  PyEval_SetTrace(tracefunc, NULL);
-#endif
+  // Profile everything if requested
+  if ( g_profiler_enabled )
+    profiler_start(0);
 
   // Batch-mode operation:
   parse_plugin_options();
@@ -1583,6 +2138,25 @@ void IDAPython_Term(void)
   // De-init pywraps
   deinit_pywraps();
 
+  // Release the cached code objects and callables
+  clear_code_cache();
+  clear_extlang_callables();
+
+  // Stop the script watchdog
+  stop_watchdog();
+
+  // Save the profile collected since the plugin start
+  if ( g_profiler_enabled && stop_profiler() )
+  {
+    char path[QMAXPATH];
+    if ( g_profiler_output.empty() )
+      qmakepath(path, sizeof(path), get_user_idadir(), "idapython.folded", NULL);
+    else
+      qstrncpy(path, g_profiler_output.c_str(), sizeof(path));
+    if ( write_profile(path) )
+      msg("IDAPython: profile written to '%s'\n", path);
+  }
+
   // Uninstall IDC function
   set_idc_func_ex(S_IDC_RUNPYTHON_STATEMENT, NULL, NULL, 0);
 
@@ -297,6 +297,31 @@ def Entries():
         yield (i, ordinal, ea, name)
 
 
+def PatchedBytes(start=None, end=None, chunk_size=0x10000):
+    """
+    Get the patched bytes, in chunks of at most 'chunk_size' entries
+
+    @param start:      start address (default: inf.minEA)
+    @param end:        end address (default: inf.maxEA)
+    @param chunk_size: maximal number of patched bytes per chunk
+
+    @return: List of tuples (eas, fposes, org_vals, patch_vals).
+             Each tuple item is an array.array column.
+    """
+    if not start: start = idaapi.cvar.inf.minEA
+    if not end:   end = idaapi.cvar.inf.maxEA
+
+    while start < end:
+        chunk = idaapi.get_patched_bytes(start, end, chunk_size)
+        eas = chunk[0]
+        if not eas:
+            break
+        yield chunk
+        if len(eas) < chunk_size:
+            break
+        start = eas[-1] + 1
+
+
 def FuncItems(start):
     """
     Get a list of function items
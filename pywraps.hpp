@@ -111,6 +111,82 @@ public:
 // Declare a variable to acquire/release the GIL
 #define PYW_GIL_GET gil_lock_t lock;
 
+//---------------------------------------------------------------------------
+// Latency statistics of the kernel to Python hook dispatchers
+enum pyw_hook_class_t
+{
+  PYW_HOOK_IDP,
+  PYW_HOOK_IDB,
+  PYW_HOOK_DBG,
+  PYW_HOOK_UI,
+  PYW_HOOK_CHOOSE2,
+  PYW_HOOK_LAST
+};
+bool PyW_HookStatsEnabled();
+void PyW_RecordHookLatency(pyw_hook_class_t hclass, int code, uint64 total_ns, uint64 gil_ns);
+
+// Acquires/releases the GIL for a hook dispatcher. When hook statistics
+// are enabled, it also measures the GIL wait and the whole dispatch time.
+class hook_gil_lock_t
+{
+private:
+  pyw_hook_class_t hclass;
+  int code;
+  uint64 start;
+  uint64 gil_ns;
+  PyGILState_STATE state;
+public:
+  hook_gil_lock_t(pyw_hook_class_t _hclass, int _code)
+    : hclass(_hclass), code(_code), start(0), gil_ns(0)
+  {
+    if ( PyW_HookStatsEnabled() )
+      start = get_nsec_stamp();
+    state = PyGILState_Ensure();
+    if ( start != 0 )
+      gil_ns = get_nsec_stamp() - start;
+  }
+
+  ~hook_gil_lock_t()
+  {
+    if ( start != 0 )
+      PyW_RecordHookLatency(hclass, code, get_nsec_stamp() - start, gil_ns);
+    PyGILState_Release(state);
+  }
+};
+// Declare a variable to acquire/release the GIL in a hook dispatcher
+#define PYW_GIL_GET_HOOK(hclass, code) hook_gil_lock_t lock(hclass, code);
+
+//---------------------------------------------------------------------------
+// A notification code and the name of the hooks method handling it
+struct pyw_hook_event_t
+{
+  int code;
+  const char *method;
+};
+
+// The set of notifications a hooks instance handles in Python.
+// It is computed when the hooks are installed, so that the dispatcher can
+// return before taking the GIL for the notifications nobody overrides.
+class hook_event_mask_t
+{
+private:
+  qvector<uchar> codes; // indexed by notification code
+  bool all;
+public:
+  hook_event_mask_t() : all(true) {}
+  bool has(int code) const
+  {
+    return all || (code >= 0 && size_t(code) < codes.size() && codes[code] != 0);
+  }
+  // 'self' is the Python hooks object (NULL selects all the events),
+  // 'clsname' is the idaapi class with the default handlers
+  void compute(
+        PyObject *self,
+        const char *clsname,
+        const pyw_hook_event_t *events,
+        size_t nevents);
+};
+
 #define GIL_CHKCONDFAIL (((debug & IDA_DEBUG_PLUGIN) == IDA_DEBUG_PLUGIN) \
                       && PyGILState_GetThisThreadState() != _PyThreadState_Current)
 
@@ -251,6 +327,71 @@ struct ref_vec_t : public qvector<ref_t>
   }
 };
 
+//------------------------------------------------------------------------
+// The memory of a buffer object (str, bytearray, array.array, mmap...)
+// The objects that support the new buffer interface can't be resized while
+// the buffer is held ('locked' is true): their memory can be used with the
+// GIL released. The old style buffers (array.array...) give no such
+// guarantee: another thread could resize them, so keep the GIL.
+struct pyw_buffer_t
+{
+  void *ptr;
+  Py_ssize_t size;
+  bool locked;
+
+  pyw_buffer_t() : ptr(NULL), size(0), locked(false), obj(NULL) { view.obj = NULL; }
+  ~pyw_buffer_t() { release(); }
+
+  // Returns false and sets a Python exception on failure
+  bool acquire(PyObject *o, bool writable)
+  {
+    release();
+    if ( PyObject_CheckBuffer(o) )
+    {
+      if ( PyObject_GetBuffer(o, &view, writable ? PyBUF_WRITABLE : PyBUF_SIMPLE) != 0 )
+      {
+        view.obj = NULL;
+        return false;
+      }
+      ptr = view.buf;
+      size = view.len;
+      locked = true;
+      return true;
+    }
+    // Old style buffer (array.array, mmap): keep the object alive
+    int rc = writable
+           ? PyObject_AsWriteBuffer(o, &ptr, &size)
+           : PyObject_AsReadBuffer(o, (const void **)&ptr, &size);
+    if ( rc != 0 )
+    {
+      ptr = NULL;
+      size = 0;
+      return false;
+    }
+    Py_INCREF(o);
+    obj = o;
+    return true;
+  }
+
+  void release()
+  {
+    if ( view.obj != NULL )
+      PyBuffer_Release(&view);
+    view.obj = NULL;
+    Py_XDECREF(obj);
+    obj = NULL;
+    ptr = NULL;
+    size = 0;
+    locked = false;
+  }
+
+private:
+  Py_buffer view;
+  PyObject *obj;
+  pyw_buffer_t(const pyw_buffer_t &); // No.
+  pyw_buffer_t &operator=(const pyw_buffer_t &); // No.
+};
+
 
 // Returns a new reference to a class
 // Return value: New reference.
@@ -352,6 +493,16 @@ bool PyW_PyListToIntVec(PyObject *py_list, intvec_t &intvec);
 // Converts a Python list to a qstrvec
 bool PyW_PyListToStrVec(PyObject *py_list, qstrvec_t &strvec);
 
+// Returns the array.array typecode for unsigned items of the given size
+// (or '\0' if the array module has no such typecode)
+char PyW_ArrayTypecode(size_t itemsize);
+
+// Creates an array.array object out of raw items
+ref_t PyW_CreateArray(char typecode, const void *items, size_t nbytes);
+
+// Converts an eavec_t to an array.array (or to a list if ea_t has no typecode)
+ref_t PyW_EaVecToPyArray(const eavec_t &eavec);
+
 //---------------------------------------------------------------------------
 //
 // notify_when()
@@ -363,6 +514,13 @@ bool pywraps_nw_init();
 //---------------------------------------------------------------------------
 bool pywraps_check_autoscripts(char *buf, size_t bufsize);
 
+//---------------------------------------------------------------------------
+// Drops the debugger memory snapshot cache and its hook
+void dbgmem_cache_term();
+
+// Drops the register snapshots of dbg_get_reg_values_delta() and their hook
+void dbg_reg_snapshots_term();
+
 // [De]Initializes PyWraps
 bool init_pywraps();
 void deinit_pywraps();
@@ -92,6 +92,39 @@ static PyObject *ex_choose2_get_embedded_selection(PyObject *self, PyObject *arg
     return choose2_get_embedded_selection(obj);
 }
 
+//-------------------------------------------------------------------------
+static PyObject *ex_choose2_set_table(PyObject *self, PyObject *args)
+{
+  PyObject *obj, *table;
+  if ( !PyArg_ParseTuple(args, "OO", &obj, &table) )
+    return NULL;
+  else
+    return choose2_set_table(obj, table);
+}
+
+//-------------------------------------------------------------------------
+static PyObject *ex_choose2_sort(PyObject *self, PyObject *args)
+{
+  PyObject *obj;
+  int col, descending;
+  if ( !PyArg_ParseTuple(args, "Oii", &obj, &col, &descending) )
+    return NULL;
+  else
+    return PyBool_FromLong(choose2_sort(obj, col, descending != 0));
+}
+
+//-------------------------------------------------------------------------
+static PyObject *ex_choose2_filter(PyObject *self, PyObject *args)
+{
+  PyObject *obj;
+  char *text;
+  int col;
+  if ( !PyArg_ParseTuple(args, "Osi", &obj, &text, &col) )
+    return NULL;
+  else
+    return PyBool_FromLong(choose2_filter(obj, text, col));
+}
+
 //-------------------------------------------------------------------------
 static PyMethodDef py_methods_chooser[] =
 {
@@ -104,6 +137,9 @@ static PyMethodDef py_methods_chooser[] =
   {"py_choose2_get_test_embedded", ex_choose2_get_test_embedded, METH_VARARGS, ""},
   {"py_choose2_get_embedded", ex_choose2_get_embedded, METH_VARARGS, ""},
   {"py_choose2_get_embedded_selection", ex_choose2_get_embedded_selection, METH_VARARGS, ""},
+  {"py_choose2_set_table", ex_choose2_set_table, METH_VARARGS, ""},
+  {"py_choose2_sort", ex_choose2_sort, METH_VARARGS, ""},
+  {"py_choose2_filter", ex_choose2_filter, METH_VARARGS, ""},
   {NULL, NULL, 0, NULL} // End of methods
 };
 DRIVER_INIT_METHODS(chooser);
@@ -141,9 +141,11 @@ static PyObject *ex_pyscv_init(PyObject *self, PyObject *args)
 {
   const char *title;
   PyObject *py_link;
-  if ( !PyArg_ParseTuple(args, "Os", &py_link, &title) )
+  int lines_mode = 0;
+  Py_ssize_t cache_size = 1024;
+  if ( !PyArg_ParseTuple(args, "Os|in", &py_link, &title, &lines_mode, &cache_size) )
     return NULL;
-  return pyscv_init(py_link, title);
+  return pyscv_init(py_link, title, lines_mode, size_t(cache_size));
 }
 
 static PyObject *ex_pyscv_add_line(PyObject *self, PyObject *args)
@@ -154,6 +156,23 @@ static PyObject *ex_pyscv_add_line(PyObject *self, PyObject *args)
   return Py_BuildValue("i", pyscv_add_line(py_this, py_sl));
 }
 
+static PyObject *ex_pyscv_add_lines(PyObject *self, PyObject *args)
+{
+  PyObject *py_this, *py_lines;
+  if ( !PyArg_ParseTuple(args, "OO", &py_this, &py_lines) )
+    return NULL;
+  return Py_BuildValue(PY_FMT64, pyul_t(pyscv_add_lines(py_this, py_lines)));
+}
+
+static PyObject *ex_pyscv_set_line_count(PyObject *self, PyObject *args)
+{
+  PyObject *py_this;
+  Py_ssize_t count;
+  if ( !PyArg_ParseTuple(args, "On", &py_this, &count) )
+    return NULL;
+  return Py_BuildValue("i", pyscv_set_line_count(py_this, size_t(count)));
+}
+
 static PyObject *ex_pyscv_delete(PyObject *self, PyObject *args)
 {
   PyObject *py_this;
@@ -335,6 +354,8 @@ static PyMethodDef py_methods_custview[] =
   {"pyscv_init",  ex_pyscv_init, METH_VARARGS, ""},
   {"pyscv_close",  ex_pyscv_close, METH_VARARGS, ""},
   {"pyscv_add_line",  ex_pyscv_add_line, METH_VARARGS, ""},
+  {"pyscv_add_lines",  ex_pyscv_add_lines, METH_VARARGS, ""},
+  {"pyscv_set_line_count",  ex_pyscv_set_line_count, METH_VARARGS, ""},
   {"pyscv_delete",  ex_pyscv_delete, METH_VARARGS, ""},
   {"pyscv_refresh",  ex_pyscv_refresh, METH_VARARGS, ""},
   {"pyscv_clear_lines", ex_pyscv_clear_lines, METH_VARARGS, ""},
@@ -18,19 +18,59 @@ else:
 # ----------------------------------------------------------------------------------------------------------------------------------------------
 #<pycode(py_idd)>
 import types
+import array
+import sys
 
 # -----------------------------------------------------------------------
 class Appcall_array__(object):
-    """This class is used with Appcall.array() method"""
+    """
+    This class is used with Appcall.array() method.
+    Arrays of scalars (integers, enums, pointers, floating point numbers)
+    are packed and unpacked natively through array.array objects. Other
+    arrays (including arrays of chars, which are strings) go through the
+    type system.
+    """
     def __init__(self, tp):
         self.__type = tp
+        self.__typecode = None # Resolved on first use
+        self.__size = None     # Set by pack()
+
+    def __get_typecode(self):
+        """Returns the array.array typecode of the element type, or '' if it is not a scalar"""
+        if self.__typecode is None:
+            tc = None
+            r = Appcall__.proto_cache.parse(self.__type + ";", 1 | 2 | 4) # PT_SIL | PT_NDC | PT_TYP
+            if r is not None:
+                tc = _idaapi.get_scalar_typecode(_idaapi.cvar.idati, r[0])
+            self.__typecode = tc or ''
+        return self.__typecode
+
+    @staticmethod
+    def __must_swap():
+        """Do the database and Python use different byte orders?"""
+        return bool(_idaapi.cvar.inf.mf) != (sys.byteorder == 'big')
 
     def pack(self, L):
-        """Packs a list or tuple into a byref buffer"""
-        t = type(L)
-        if not (t == types.ListType or t == types.TupleType):
-            raise ValueError, "Either a list or a tuple must be passed"
+        """
+        Packs a list or tuple into a byref buffer.
+        Arrays of scalars can also be packed from an array.array.
+        """
+        tc = self.__get_typecode()
+        if tc and isinstance(L, array.array):
+            a = L if L.typecode == tc else array.array(tc, L)
+        else:
+            t = type(L)
+            if not (t == types.ListType or t == types.TupleType):
+                raise ValueError, "Either a list or a tuple must be passed"
+            a = array.array(tc, L) if tc else None
         self.__size = len(L)
+        if a is not None:
+            # One memcpy (and one byte swap pass, if needed)
+            if self.__must_swap():
+                a = array.array(tc, a)
+                a.byteswap()
+            return Appcall__.byref(a.tostring())
+
         if self.__size == 1:
             self.__typedobj = Appcall__.typedobj(self.__type + ";")
         else:
@@ -51,7 +91,12 @@ class Appcall_array__(object):
         return [getattr(obj, str(x)) for x in xrange(0, self.__size)]
 
     def unpack(self, buf, as_list=True):
-        """Unpacks an array back into a list or an object"""
+        """
+        Unpacks an array back into a list or an object.
+        Arrays of scalars are unpacked into an array.array if 'as_list' is False.
+        They hold as many items as were packed, or as 'buf' holds if pack()
+        was not called.
+        """
         # take the value from the special ref object
         if isinstance(buf, PyIdc_cvt_refclass__):
             buf = buf.value
@@ -59,7 +104,19 @@ class Appcall_array__(object):
         # we can only unpack from strings
         if type(buf) != types.StringType:
             raise ValueError, "Cannot unpack this type!"
-        # now unpack
+
+        tc = self.__get_typecode()
+        if tc:
+            a = array.array(tc)
+            n = len(buf) // a.itemsize
+            if self.__size is not None:
+                n = min(n, self.__size)
+            a.fromstring(buf[:n * a.itemsize])
+            if self.__must_swap():
+                a.byteswap()
+            return a.tolist() if as_list else a
+
+        # now unpack (one unpack_object_from_bv() for the whole array)
         ok, obj = self.__typedobj.retrieve(buf)
         if not ok:
             raise ValueError, "Failed while unpacking!"
@@ -125,9 +182,11 @@ class Appcall_callable__(object):
         # convert arguments to a list
         arg_list = list(args)
 
-        # Save appcall options and set new global options
+        # Save appcall options and set new global options (if they differ)
         old_opt = Appcall__.get_appcall_options()
-        Appcall__.set_appcall_options(self.options)
+        opt = self.options
+        if opt != old_opt:
+            Appcall__.set_appcall_options(opt)
 
         # Do the Appcall (use the wrapped version)
         e_obj = None
@@ -142,7 +201,52 @@ class Appcall_callable__(object):
             e_obj = e
 
         # Restore appcall options
-        Appcall__.set_appcall_options(old_opt)
+        if opt != old_opt:
+            Appcall__.set_appcall_options(old_opt)
+
+        # Return or re-raise exception
+        if e_obj:
+            raise Exception, e_obj
+
+        return r
+
+    def batch(self, args_list, stop_on_error=True):
+        """
+        Calls the function once per item of 'args_list'.
+        The arguments are converted into the same (reused) slots for all
+        the calls and only the mutable arguments (byref, objects...) get the
+        values back.
+        @param args_list: A sequence of argument tuples (or lists)
+        @param stop_on_error: If True, the first failing call raises an exception.
+                              Otherwise, the exception object is stored in place of the
+                              result of the call and the next calls are still done.
+        @return: A list with the results of the calls
+        """
+        if self.ea is None:
+            raise ValueError, "Object not callable!"
+
+        # Save appcall options and set new global options (if they differ)
+        old_opt = Appcall__.get_appcall_options()
+        opt = self.options
+        if opt != old_opt:
+            Appcall__.set_appcall_options(opt)
+
+        # Do the Appcalls
+        e_obj = None
+        try:
+            r = _idaapi.appcall_batch(
+               self.ea,
+               _idaapi.get_current_thread(),
+               self.type,
+               self.fields,
+               args_list,
+               stop_on_error)
+        except Exception as e:
+            e_obj = e
+
+        # Restore appcall options
+        if opt != old_opt:
+            Appcall__.set_appcall_options(old_opt)
 
         # Return or re-raise exception
         if e_obj:
@@ -237,6 +341,71 @@ class Appcall_consts__(object):
     def __getattr__(self, attr):
         return Appcall__.valueof(attr, self.__default)
 
+# -----------------------------------------------------------------------
+class Appcall_proto_cache__(object):
+    """
+    Process-wide cache of parsed declarations, keyed by the declaration
+    text, the parse flags and the TIL. It is used by Appcall.proto() and
+    Appcall.typedobj(), so that creating the same callable again does not
+    parse its prototype again.
+    The parsed types belong to the database: the cache is emptied when the
+    database is closed.
+    """
+    MAX_ENTRIES = 1024
+    """The cache is emptied when it holds that many declarations"""
+
+    def __init__(self):
+        self.__entries = {}
+        self.__notified = False
+        self.hits = 0
+        self.misses = 0
+
+    def __on_closeidb(self, nw_code):
+        self.__entries.clear()
+
+    def parse(self, decl, flags, til=None):
+        """
+        Parses a declaration, or returns it from the cache
+        @param decl: The C declaration
+        @param flags: The PT_xxx flags of idc_parse_decl()
+        @param til: The TIL (None means idaapi.cvar.idati)
+        @return: A tuple(type, fields) ready to be passed to appcall(), or None on failure
+        """
+        if til is None:
+            til = _idaapi.cvar.idati
+        # The proxy objects change from access to access: key on the til_t pointer
+        try:
+            til_key = int(til.this)
+        except:
+            til_key = id(til)
+        key = (decl, flags, til_key)
+        r = self.__entries.get(key)
+        if r is not None:
+            self.hits += 1
+            return r
+        self.misses += 1
+        if not self.__notified:
+            # (registered on first use: notify_when() is not ready when the module is imported)
+            self.__notified = notify_when(NW_CLOSEIDB, self.__on_closeidb)
+        result = _idaapi.idc_parse_decl(til, decl, flags)
+        if result is None:
+            return None
+        if len(self.__entries) >= self.MAX_ENTRIES:
+            self.__entries.clear()
+        r = (result[1], result[2])
+        self.__entries[key] = r
+        return r
+
+    def clear(self):
+        """
+        Forgets all the parsed declarations.
+        Call it after changing the types that the cached declarations use.
+        """
+        self.__entries.clear()
+
+    def __len__(self):
+        return len(self.__entries)
+
 # -----------------------------------------------------------------------
 class Appcall__(object):
     APPCALL_MANUAL = 0x1
@@ -261,6 +430,9 @@ class Appcall__(object):
     If timed out, errbuf will contain "timeout".
     """
 
+    proto_cache = Appcall_proto_cache__()
+    """The cache of the prototypes parsed by proto() and typedobj()"""
+
     def __init__(self):
         self.__consts = Appcall_consts__()
     def __get_consts(self):
@@ -306,12 +478,28 @@ class Appcall__(object):
         if flags is None:
             flags = 1 | 2 | 4 # PT_SIL | PT_NDC | PT_TYP
 
-        result = _idaapi.idc_parse_decl(_idaapi.cvar.idati, prototype, flags)
+        result = Appcall__.proto_cache.parse(prototype, flags)
         if result is None:
             raise ValueError, "Could not parse type: " + prototype
 
         # Return the callable method with type info
-        return Appcall_callable__(ea, result[1], result[2])
+        return Appcall_callable__(ea, result[0], result[1])
+
+    @staticmethod
+    def batch(func, args_list, stop_on_error=True):
+        """
+        Calls the same function once per item of 'args_list'.
+        Example (the prototype is parsed once for all the calls):
+          strlen = Appcall.proto("strlen", "int __cdecl strlen(const char *);")
+          lengths = Appcall.batch(strlen, [("a",), ("bb",), ("ccc",)])
+        @param func: A callable Appcall instance, a function name or an ea
+        @param args_list: A sequence of argument tuples (or lists)
+        @param stop_on_error: See Appcall_callable__.batch()
+        @return: A list with the results of the calls
+        """
+        if not isinstance(func, Appcall_callable__):
+            func = Appcall_callable__(Appcall__.__name_or_ea(func))
+        return func.batch(args_list, stop_on_error)
 
     def __getattr__(self, name_or_ea):
         """Allows you to call functions as if they were member functions (by returning a callable object)"""
@@ -396,11 +584,11 @@ class Appcall__(object):
         @return: Appcall object or raises ValueError exception
         """
         # parse the type
-        result = _idaapi.idc_parse_decl(_idaapi.cvar.idati, typestr, 1 | 2 | 4) # PT_SIL | PT_NDC | PT_TYP
+        result = Appcall__.proto_cache.parse(typestr, 1 | 2 | 4) # PT_SIL | PT_NDC | PT_TYP
         if result is None:
             raise ValueError, "Could not parse type: " + typestr
         # Return the callable method with type info
-        return Appcall_callable__(ea, result[1], result[2])
+        return Appcall_callable__(ea, result[0], result[1])
 
     @staticmethod
     def set_appcall_options(opt):
@@ -42,6 +42,534 @@ static int idaapi py_visit_patched_bytes_cb(
   PyW_ShowCbErr("visit_patched_bytes");
   return (py_result != NULL && PyInt_Check(py_result.o)) ? PyInt_AsLong(py_result.o) : 0;
 }
+
+//---------------------------------------------------------------------------
+// Columns collected by get_patched_bytes()
+struct patched_bytes_cols_t
+{
+  eavec_t eas;
+  qvector<int32> fpos;
+  qvector<uint32> orig;
+  qvector<uint32> patched;
+  size_t limit;
+};
+
+//---------------------------------------------------------------------------
+static int idaapi py_collect_patched_bytes_cb(
+      ea_t ea,
+      int32 fpos,
+      uint32 o,
+      uint32 v,
+      void *ud)
+{
+  patched_bytes_cols_t &cols = *(patched_bytes_cols_t *)ud;
+  cols.eas.push_back(ea);
+  cols.fpos.push_back(fpos);
+  cols.orig.push_back(o);
+  cols.patched.push_back(v);
+  return cols.limit != 0 && cols.eas.size() >= cols.limit ? 1 : 0;
+}
+//------------------------------------------------------------------------
+// bytes_view: a read-only buffer object over the database bytes.
+// The bytes are fetched lazily, a chunk at a time, into a block taken
+// from a process-wide arena. Slices share the block of the view they
+// were taken from, so slicing never copies.
+//------------------------------------------------------------------------
+#define BV_CHUNK_SHIFT 12
+#define BV_CHUNK_SIZE  (1 << BV_CHUNK_SHIFT)
+#define BV_ARENA_MAX   (16 * 1024 * 1024) // bytes kept around for reuse
+
+//------------------------------------------------------------------------
+// Keeps the blocks released by dead views so the next views can reuse them
+class bytes_view_arena_t
+{
+  struct block_t
+  {
+    uchar *ptr;
+    size_t cap;
+  };
+  qvector<block_t> blocks;
+  size_t total;
+
+public:
+  bytes_view_arena_t() : total(0) {}
+  ~bytes_view_arena_t() { clear(); }
+
+  uchar *alloc(size_t size, size_t *cap)
+  {
+    // Best fit, but do not waste a big block on a small view
+    size_t best = blocks.size();
+    for ( size_t i=0; i < blocks.size(); i++ )
+    {
+      const block_t &b = blocks[i];
+      if ( b.cap < size || b.cap / 4 > size )
+        continue;
+      if ( best == blocks.size() || b.cap < blocks[best].cap )
+        best = i;
+    }
+    if ( best != blocks.size() )
+    {
+      block_t b = blocks[best];
+      blocks.erase(blocks.begin() + best);
+      total -= b.cap;
+      *cap = b.cap;
+      return b.ptr;
+    }
+    *cap = (size + BV_CHUNK_SIZE - 1) & ~size_t(BV_CHUNK_SIZE - 1);
+    return (uchar *)qalloc(*cap);
+  }
+
+  void release(uchar *ptr, size_t cap)
+  {
+    if ( total + cap > BV_ARENA_MAX )
+    {
+      qfree(ptr);
+      return;
+    }
+    block_t b;
+    b.ptr = ptr;
+    b.cap = cap;
+    blocks.push_back(b);
+    total += cap;
+  }
+
+  void clear()
+  {
+    for ( size_t i=0; i < blocks.size(); i++ )
+      qfree(blocks[i].ptr);
+    blocks.clear();
+    total = 0;
+  }
+};
+static bytes_view_arena_t bv_arena;
+
+//------------------------------------------------------------------------
+struct py_bytes_view_t
+{
+  PyObject_HEAD
+  py_bytes_view_t *owner; // view owning the block (NULL for the owner itself)
+  uchar *data;            // first byte of this view
+  Py_ssize_t size;        // number of bytes in this view
+  ea_t ea;                // address of the first byte
+  // Only valid in the owner:
+  size_t cap;             // capacity of the block (data points to its start)
+  qvector<uchar> *loaded; // one "fetched" flag per chunk
+};
+
+//------------------------------------------------------------------------
+// Makes sure that bytes [off, off+len) of the view are fetched
+static void bv_fetch(py_bytes_view_t *self, Py_ssize_t off, Py_ssize_t len)
+{
+  if ( len <= 0 )
+    return;
+  py_bytes_view_t *o = self->owner == NULL ? self : self->owner;
+  off += self->data - o->data;
+  size_t c = size_t(off) >> BV_CHUNK_SHIFT;
+  size_t c_end = (size_t(off + len - 1) >> BV_CHUNK_SHIFT) + 1;
+  qvector<uchar> &loaded = *o->loaded;
+  while ( c < c_end )
+  {
+    if ( loaded[c] )
+    {
+      ++c;
+      continue;
+    }
+    // Fetch the whole run of missing chunks at once
+    size_t c2 = c + 1;
+    while ( c2 < c_end && !loaded[c2] )
+      ++c2;
+    size_t start = c << BV_CHUNK_SHIFT;
+    size_t end = qmin(c2 << BV_CHUNK_SHIFT, size_t(o->size));
+    uchar *p = o->data + start;
+    ea_t ea = o->ea + start;
+    // The GIL is kept: releasing it would let another thread fetch
+    // the same chunks (or read them half-filled) concurrently
+    if ( !get_many_bytes(ea, p, end - start) )
+    {
+      for ( size_t i=0; i < end - start; i++ )
+        p[i] = get_byte(ea + i);
+    }
+    for ( ; c < c2; c++ )
+      loaded[c] = 1;
+  }
+}
+
+//------------------------------------------------------------------------
+static PyObject *bv_new_slice(py_bytes_view_t *self, Py_ssize_t start, Py_ssize_t len);
+
+//------------------------------------------------------------------------
+static void bv_dealloc(PyObject *self)
+{
+  py_bytes_view_t *bv = (py_bytes_view_t *)self;
+  if ( bv->owner != NULL )
+  {
+    Py_DECREF((PyObject *)bv->owner);
+  }
+  else
+  {
+    if ( bv->data != NULL )
+      bv_arena.release(bv->data, bv->cap);
+    delete bv->loaded;
+  }
+  Py_TYPE(self)->tp_free(self);
+}
+
+//------------------------------------------------------------------------
+static PyObject *bv_repr(PyObject *self)
+{
+  py_bytes_view_t *bv = (py_bytes_view_t *)self;
+  char buf[MAXSTR];
+  qsnprintf(buf, sizeof(buf), "<bytes_view ea=%a size=%" FMT_Z ">", bv->ea, size_t(bv->size));
+  return PyString_FromString(buf);
+}
+
+//------------------------------------------------------------------------
+static PyObject *bv_tobytes(PyObject *self, PyObject * /*args*/)
+{
+  py_bytes_view_t *bv = (py_bytes_view_t *)self;
+  bv_fetch(bv, 0, bv->size);
+  return PyString_FromStringAndSize((const char *)bv->data, bv->size);
+}
+
+//------------------------------------------------------------------------
+// Only the bytes needed by the format are fetched
+static PyObject *bv_unpack_from(PyObject *self, PyObject *args)
+{
+  py_bytes_view_t *bv = (py_bytes_view_t *)self;
+  PyObject *py_fmt;
+  Py_ssize_t offset = 0;
+  if ( !PyArg_ParseTuple(args, "O|n:unpack_from", &py_fmt, &offset) )
+    return NULL;
+  ref_t py_struct(PyW_TryImportModule("struct"));
+  if ( py_struct == NULL )
+  {
+    PyErr_SetString(PyExc_ImportError, "cannot import struct");
+    return NULL;
+  }
+  newref_t py_size(PyObject_CallMethod(py_struct.o, (char *)"calcsize", (char *)"O", py_fmt));
+  if ( py_size == NULL )
+    return NULL;
+  Py_ssize_t n = PyInt_AsSsize_t(py_size.o);
+  if ( offset < 0 )
+    offset += bv->size;
+  if ( offset < 0 || n > bv->size - offset )
+  {
+    PyErr_Format(PyExc_ValueError, "unpack_from requires %zd bytes at offset %zd", n, offset);
+    return NULL;
+  }
+  newref_t py_slice(bv_new_slice(bv, offset, n));
+  if ( py_slice == NULL )
+    return NULL;
+  return PyObject_CallMethod(py_struct.o, (char *)"unpack_from", (char *)"OO", py_fmt, py_slice.o);
+}
+
+//------------------------------------------------------------------------
+static PyObject *bv_get_ea(PyObject *self, void * /*closure*/)
+{
+  return Py_BuildValue(PY_FMT64, pyul_t(((py_bytes_view_t *)self)->ea));
+}
+
+//------------------------------------------------------------------------
+static Py_ssize_t bv_length(PyObject *self)
+{
+  return ((py_bytes_view_t *)self)->size;
+}
+
+//------------------------------------------------------------------------
+static PyObject *bv_subscript(PyObject *self, PyObject *item)
+{
+  py_bytes_view_t *bv = (py_bytes_view_t *)self;
+  if ( PyIndex_Check(item) )
+  {
+    Py_ssize_t i = PyNumber_AsSsize_t(item, PyExc_IndexError);
+    if ( i == -1 && PyErr_Occurred() )
+      return NULL;
+    if ( i < 0 )
+      i += bv->size;
+    if ( i < 0 || i >= bv->size )
+    {
+      PyErr_SetString(PyExc_IndexError, "bytes_view index out of range");
+      return NULL;
+    }
+    bv_fetch(bv, i, 1);
+    return PyString_FromStringAndSize((const char *)bv->data + i, 1);
+  }
+  if ( PySlice_Check(item) )
+  {
+    Py_ssize_t start, stop, step, len;
+    if ( PySlice_GetIndicesEx((PySliceObject *)item, bv->size, &start, &stop, &step, &len) < 0 )
+      return NULL;
+    if ( step == 1 )
+      return bv_new_slice(bv, start, len);
+
+    // Strided slices cannot be views: copy them
+    PyObject *py_str = PyString_FromStringAndSize(NULL, len);
+    if ( py_str == NULL )
+      return NULL;
+    char *p = PyString_AS_STRING(py_str);
+    for ( Py_ssize_t i=0; i < len; i++, start += step )
+    {
+      bv_fetch(bv, start, 1);
+      p[i] = bv->data[start];
+    }
+    return py_str;
+  }
+  PyErr_SetString(PyExc_TypeError, "bytes_view indices must be integers or slices");
+  return NULL;
+}
+
+//------------------------------------------------------------------------
+// New-style buffer protocol (memoryview, struct.unpack_from, ...)
+// The buffer covers the whole view: all its bytes are fetched
+static int bv_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+  py_bytes_view_t *bv = (py_bytes_view_t *)self;
+  bv_fetch(bv, 0, bv->size);
+  return PyBuffer_FillInfo(view, self, bv->data, bv->size, 1, flags);
+}
+
+//------------------------------------------------------------------------
+// Old-style buffer protocol
+static Py_ssize_t bv_getreadbuf(PyObject *self, Py_ssize_t segment, void **ptr)
+{
+  if ( segment != 0 )
+  {
+    PyErr_SetString(PyExc_SystemError, "accessing non-existent bytes_view segment");
+    return -1;
+  }
+  py_bytes_view_t *bv = (py_bytes_view_t *)self;
+  bv_fetch(bv, 0, bv->size);
+  *ptr = bv->data;
+  return bv->size;
+}
+
+static Py_ssize_t bv_getsegcount(PyObject *self, Py_ssize_t *lenp)
+{
+  if ( lenp != NULL )
+    *lenp = ((py_bytes_view_t *)self)->size;
+  return 1;
+}
+
+static Py_ssize_t bv_getcharbuf(PyObject *self, Py_ssize_t segment, char **ptr)
+{
+  return bv_getreadbuf(self, segment, (void **)ptr);
+}
+
+//------------------------------------------------------------------------
+static PySequenceMethods bv_as_sequence =
+{
+  bv_length,              // sq_length
+};
+
+static PyMappingMethods bv_as_mapping =
+{
+  bv_length,              // mp_length
+  bv_subscript,           // mp_subscript
+  NULL,                   // mp_ass_subscript
+};
+
+static PyBufferProcs bv_as_buffer =
+{
+  bv_getreadbuf,          // bf_getreadbuffer
+  NULL,                   // bf_getwritebuffer
+  bv_getsegcount,         // bf_getsegcount
+  bv_getcharbuf,          // bf_getcharbuffer
+  bv_getbuffer,           // bf_getbuffer
+  NULL,                   // bf_releasebuffer
+};
+
+static PyMethodDef bv_methods[] =
+{
+  { "tobytes", bv_tobytes, METH_NOARGS, "Returns a copy of the bytes as a string" },
+  { "unpack_from", bv_unpack_from, METH_VARARGS, "unpack_from(fmt, offset=0): struct.unpack_from() that only fetches the needed bytes" },
+  { NULL, NULL, 0, NULL }
+};
+
+static PyGetSetDef bv_getset[] =
+{
+  { (char *)"ea", bv_get_ea, NULL, (char *)"Address of the first byte", NULL },
+  { NULL, NULL, NULL, NULL, NULL }
+};
+
+static PyTypeObject bytes_view_type =
+{
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "idaapi.bytes_view",                    // tp_name
+  sizeof(py_bytes_view_t),                // tp_basicsize
+  0,                                      // tp_itemsize
+  bv_dealloc,                             // tp_dealloc
+  NULL,                                   // tp_print
+  NULL,                                   // tp_getattr
+  NULL,                                   // tp_setattr
+  NULL,                                   // tp_compare
+  bv_repr,                                // tp_repr
+  NULL,                                   // tp_as_number
+  &bv_as_sequence,                        // tp_as_sequence
+  &bv_as_mapping,                         // tp_as_mapping
+  NULL,                                   // tp_hash
+  NULL,                                   // tp_call
+  NULL,                                   // tp_str
+  NULL,                                   // tp_getattro
+  NULL,                                   // tp_setattro
+  &bv_as_buffer,                          // tp_as_buffer
+  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER, // tp_flags
+  "Read-only view over database bytes",   // tp_doc
+  NULL,                                   // tp_traverse
+  NULL,                                   // tp_clear
+  NULL,                                   // tp_richcompare
+  0,                                      // tp_weaklistoffset
+  NULL,                                   // tp_iter
+  NULL,                                   // tp_iternext
+  bv_methods,                             // tp_methods
+  NULL,                                   // tp_members
+  bv_getset,                              // tp_getset
+};
+
+//------------------------------------------------------------------------
+static py_bytes_view_t *bv_alloc()
+{
+  if ( (bytes_view_type.tp_flags & Py_TPFLAGS_READY) == 0
+    && PyType_Ready(&bytes_view_type) < 0 )
+  {
+    return NULL;
+  }
+  return PyObject_New(py_bytes_view_t, &bytes_view_type);
+}
+
+//------------------------------------------------------------------------
+static PyObject *bv_new_slice(py_bytes_view_t *self, Py_ssize_t start, Py_ssize_t len)
+{
+  py_bytes_view_t *owner = self->owner == NULL ? self : self->owner;
+  py_bytes_view_t *bv = bv_alloc();
+  if ( bv == NULL )
+    return NULL;
+  Py_INCREF((PyObject *)owner);
+  bv->owner = owner;
+  bv->data = self->data + start;
+  bv->size = len;
+  bv->ea = self->ea + start;
+  bv->cap = 0;
+  bv->loaded = NULL;
+  return (PyObject *)bv;
+}
+//------------------------------------------------------------------------
+// find_flags(): native (next|prev)that() for the common "flags & mask == value"
+// predicate. Flags are fetched in batches and tested without calling Python.
+// All the addresses of a segment have flags: inside segments the flags of
+// consecutive addresses are fetched directly, and nextaddr()/prevaddr()
+// are only called to cross the gaps between them.
+//------------------------------------------------------------------------
+#define FF_BATCH_SIZE 256
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FF_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------
+// Tests a batch of flags and stores the indexes of the matching ones
+static size_t ff_test_batch(
+        const flags_t *flags,
+        size_t n,
+        flags_t mask,
+        flags_t value,
+        uint32 *hits)
+{
+  size_t nhits = 0;
+  size_t i = 0;
+#ifdef FF_USE_SSE2
+  // 8 flag words per iteration
+  const __m128i vmask = _mm_set1_epi32(int(mask));
+  const __m128i vvalue = _mm_set1_epi32(int(value));
+  for ( ; i + 8 <= n; i += 8 )
+  {
+    __m128i lo = _mm_loadu_si128((const __m128i *)(flags + i));
+    __m128i hi = _mm_loadu_si128((const __m128i *)(flags + i + 4));
+    lo = _mm_cmpeq_epi32(_mm_and_si128(lo, vmask), vvalue);
+    hi = _mm_cmpeq_epi32(_mm_and_si128(hi, vmask), vvalue);
+    int bits = _mm_movemask_ps(_mm_castsi128_ps(lo))
+             | (_mm_movemask_ps(_mm_castsi128_ps(hi)) << 4);
+    for ( int j=0; bits != 0; j++, bits >>= 1 )
+    {
+      if ( (bits & 1) != 0 )
+        hits[nhits++] = uint32(i + j);
+    }
+  }
+#endif
+  for ( ; i < n; i++ )
+  {
+    if ( (flags[i] & mask) == value )
+      hits[nhits++] = uint32(i);
+  }
+  return nhits;
+}
+
+//------------------------------------------------------------------------
+// Scans the addresses [start, end), in the search direction.
+// Returns false once 'limit' addresses were found
+static bool ff_scan_range(
+        ea_t start,
+        ea_t end,
+        flags_t mask,
+        flags_t value,
+        bool forward,
+        size_t limit,
+        eavec_t *out)
+{
+  flags_t flags[FF_BATCH_SIZE];
+  uint32 hits[FF_BATCH_SIZE];
+  while ( start < end )
+  {
+    size_t n = size_t(qmin(end - start, ea_t(FF_BATCH_SIZE)));
+    ea_t first = forward ? start : end - 1;
+    for ( size_t i=0; i < n; i++ )
+      flags[i] = getFlags(forward ? first + i : first - i);
+    if ( forward )
+      start += n;
+    else
+      end -= n;
+
+    size_t nhits = ff_test_batch(flags, n, mask, value, hits);
+    for ( size_t i=0; i < nhits; i++ )
+    {
+      out->push_back(forward ? first + hits[i] : first - hits[i]);
+      if ( limit != 0 && out->size() >= limit )
+        return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+// Same search range as (next|prev)that(): (ea, bound) forward, [bound, ea) backward
+static void ff_scan(
+        ea_t ea,
+        ea_t bound,
+        flags_t mask,
+        flags_t value,
+        bool forward,
+        size_t limit,
+        eavec_t *out)
+{
+  ea = forward ? nextaddr(ea) : prevaddr(ea);
+  while ( ea != BADADDR && (forward ? ea < bound : ea >= bound) )
+  {
+    // The run of addresses with flags around ea: its segment, if any
+    ea_t start = ea;
+    ea_t end = ea + 1;
+    segment_t *s = getseg(ea);
+    if ( s != NULL )
+    {
+      if ( forward )
+        end = qmin(s->endEA, bound);
+      else
+        start = qmax(s->startEA, bound);
+    }
+    if ( !ff_scan_range(start, end, mask, value, forward, limit, out) )
+      return;
+    ea = forward ? nextaddr(end - 1) : prevaddr(start);
+  }
+}
 //</code(py_bytes)>
 //------------------------------------------------------------------------
 
@@ -75,6 +603,55 @@ static int py_visit_patched_bytes(ea_t ea1, ea_t ea2, PyObject *py_callable)
     return visit_patched_bytes(ea1, ea2, py_visit_patched_bytes_cb, py_callable);
 }
 
+//------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_patched_bytes(ea1, ea2, limit = 0):
+    """
+    Collects the patched bytes in the given range.
+    Unlike visit_patched_bytes(), no Python code is called per patched byte:
+    the result is returned as four parallel array.array columns.
+    See idautils.PatchedBytes() to walk a large range in bounded memory.
+
+    @param ea1: start address
+    @param ea2: end address
+    @param limit: maximal number of patched bytes to collect (0 means no limit)
+    @return: tuple(eas, fposes, org_vals, patch_vals)
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *py_get_patched_bytes(ea_t ea1, ea_t ea2, size_t limit = 0)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  patched_bytes_cols_t cols;
+  cols.limit = limit;
+  Py_BEGIN_ALLOW_THREADS;
+  visit_patched_bytes(ea1, ea2, py_collect_patched_bytes_cb, &cols);
+  Py_END_ALLOW_THREADS;
+
+  // (stop at the first failure: its exception is set)
+  ref_t py_eas(PyW_EaVecToPyArray(cols.eas));
+  if ( py_eas == NULL )
+    return NULL;
+  ref_t py_fpos(PyW_CreateArray('i', cols.fpos.begin(), cols.fpos.size() * sizeof(int32)));
+  if ( py_fpos == NULL )
+    return NULL;
+  char tc = PyW_ArrayTypecode(sizeof(uint32));
+  if ( tc == '\0' )
+  {
+    PyErr_SetString(PyExc_SystemError, "no array typecode for 32-bit items");
+    return NULL;
+  }
+  ref_t py_orig(PyW_CreateArray(tc, cols.orig.begin(), cols.orig.size() * sizeof(uint32)));
+  if ( py_orig == NULL )
+    return NULL;
+  ref_t py_patched(PyW_CreateArray(tc, cols.patched.begin(), cols.patched.size() * sizeof(uint32)));
+  if ( py_patched == NULL )
+    return NULL;
+  return Py_BuildValue("(OOOO)", py_eas.o, py_fpos.o, py_orig.o, py_patched.o);
+}
+
 //------------------------------------------------------------------------
 /*
 #<pydoc>
@@ -87,6 +664,8 @@ def nextthat(ea, maxea, callable):
     @param callable: a Python callable with the following prototype:
                      callable(flags). Return True to stop enumeration.
     @return: the found address or BADADDR.
+
+    For simple 'flags & mask == value' tests use the much faster find_flags().
     """
     pass
 #</pydoc>
@@ -102,6 +681,47 @@ static ea_t py_prevthat(ea_t ea, ea_t minea, PyObject *callable)
   return py_npthat(ea, minea, callable, false);
 }
 
+//------------------------------------------------------------------------
+/*
+#<pydoc>
+def find_flags(ea, bound, mask, value, direction = 1, limit = 0):
+    """
+    Find all addresses whose flags satisfy (flags & mask) == value.
+    This is the native equivalent of nextthat()/prevthat() for this kind
+    of predicate: no Python code is called while the database is scanned.
+
+    @param ea: start address (not included in the search range)
+    @param bound: if direction >= 0, the search goes forward up to 'bound' (excluded)
+                  otherwise it goes backward down to 'bound' (included)
+    @param mask: flag bits to test (for example MS_CLS)
+    @param value: expected value of the masked flags (for example FF_CODE)
+    @param direction: search direction
+    @param limit: maximal number of addresses to return (0 means no limit)
+    @return: array.array of the matching addresses, in search order
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *py_find_flags(
+        ea_t ea,
+        ea_t bound,
+        flags_t mask,
+        flags_t value,
+        int direction = 1,
+        size_t limit = 0)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  eavec_t eas;
+  Py_BEGIN_ALLOW_THREADS;
+  ff_scan(ea, bound, mask, value & mask, direction >= 0, limit, &eas);
+  Py_END_ALLOW_THREADS;
+  ref_t py_eas(PyW_EaVecToPyArray(eas));
+  if ( py_eas == NULL )
+    return NULL;
+  py_eas.incref();
+  return py_eas.o;
+}
+
 //------------------------------------------------------------------------
 /*
 #<pydoc>
@@ -128,8 +748,13 @@ static PyObject *py_get_many_bytes(ea_t ea, unsigned int size)
     if ( py_buf == NULL )
       break;
 
-    // Read bytes
-    if ( !get_many_bytes(ea, PyString_AsString(py_buf.o), size) )
+    // Read bytes (nobody else can see the string yet)
+    char *buf = PyString_AS_STRING(py_buf.o);
+    bool ok;
+    Py_BEGIN_ALLOW_THREADS;
+    ok = get_many_bytes(ea, buf, size);
+    Py_END_ALLOW_THREADS;
+    if ( !ok )
       Py_RETURN_NONE;
 
     py_buf.incref();
@@ -138,6 +763,50 @@ static PyObject *py_get_many_bytes(ea_t ea, unsigned int size)
   Py_RETURN_NONE;
 }
 
+//------------------------------------------------------------------------
+/*
+#<pydoc>
+def bytes_view(ea, size):
+    """
+    Returns a read-only view over the specified program bytes.
+    The object supports the buffer protocol (memoryview(), struct.unpack_from(), ...),
+    len(), indexing and slicing. Slicing does not copy the bytes.
+    The bytes are read from the database lazily, when they are accessed by
+    indexing or slicing. Using a view as a buffer (memoryview(), struct.unpack_from(),
+    ...) reads all its bytes first: slice it to the needed range, or use the
+    view's unpack_from(fmt, offset), which only reads the bytes it unpacks.
+    Use tobytes() to get a copy as a string.
+    @param ea: program address
+    @param size: number of bytes in the view
+    @return: None or the bytes_view object
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *py_bytes_view(ea_t ea, unsigned int size)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( size == 0 )
+    Py_RETURN_NONE;
+
+  py_bytes_view_t *bv = bv_alloc();
+  if ( bv == NULL )
+    return NULL;
+  bv->owner = NULL;
+  bv->ea = ea;
+  bv->size = Py_ssize_t(size);
+  bv->data = bv_arena.alloc(size, &bv->cap);
+  bv->loaded = NULL;
+  if ( bv->data == NULL )
+  {
+    Py_DECREF((PyObject *)bv);
+    return PyErr_NoMemory();
+  }
+  bv->loaded = new qvector<uchar>();
+  bv->loaded->resize((size_t(size) + BV_CHUNK_SIZE - 1) >> BV_CHUNK_SHIFT, 0);
+  return (PyObject *)bv;
+}
+
 //---------------------------------------------------------------------------
 /*
 #<pydoc>
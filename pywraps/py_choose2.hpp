@@ -7,6 +7,7 @@
 // Some defines
 #define POPUP_NAMES_COUNT 4
 #define MAX_CHOOSER_MENU_COMMANDS 20
+#define CHOOSE2_ROWS_PER_BLOCK 128
 #define thisobj ((py_choose2_t *) obj)
 #define thisdecl py_choose2_t *_this = thisobj
 #define MENU_COMMAND_CB(id) \
@@ -39,6 +40,306 @@ void choose2_del_instance(PyObject *self)
     choosers.erase(it);
 }
 
+//------------------------------------------------------------------------
+// Columnar table owned by a chooser. Its rows are displayed, sorted and
+// filtered without calling Python.
+class chooser_table_t
+{
+  struct column_t
+  {
+    enum { STR, INT, UINT, DBL };
+    int kind;
+    bool hex;
+    qvector<int64> ints;      // INT and UINT values
+    qvector<double> dbls;     // DBL values
+    qvector<char> chars;      // STR values, as consecutive NUL-terminated strings
+    qvector<uint32> offs;     // offsets of the STR values in 'chars'
+
+    const char *str(int row) const { return &chars[offs[row]]; }
+  };
+  qvector<column_t> columns;
+  size_t nrows;
+
+  // Displayed rows -> table rows
+  intvec_t view;
+  int sort_col;
+  bool sort_desc;
+  qstring filter;
+  int filter_col;
+
+  struct row_less_t
+  {
+    const column_t &col;
+    row_less_t(const column_t &c) : col(c) {}
+    bool operator()(int a, int b) const
+    {
+      switch ( col.kind )
+      {
+        case column_t::STR:  return stricmp(col.str(a), col.str(b)) < 0;
+        case column_t::INT:  return col.ints[a] < col.ints[b];
+        case column_t::UINT: return uint64(col.ints[a]) < uint64(col.ints[b]);
+        default:             return col.dbls[a] < col.dbls[b];
+      }
+    }
+  };
+  struct row_greater_t : public row_less_t
+  {
+    row_greater_t(const column_t &c) : row_less_t(c) {}
+    bool operator()(int a, int b) const { return row_less_t::operator()(b, a); }
+  };
+
+  static bool load_array(column_t *col, PyObject *py_arr, qstring *errbuf)
+  {
+    ref_t py_code(PyW_TryGetAttrString(py_arr, "typecode"));
+    const char *code = py_code == NULL ? NULL : PyString_AsString(py_code.o);
+    const void *buf;
+    Py_ssize_t len;
+    if ( code == NULL || PyObject_AsReadBuffer(py_arr, &buf, &len) != 0 )
+    {
+      PyErr_Clear();
+      *errbuf = "columns must be lists or arrays";
+      return false;
+    }
+
+#define LOAD_ARRAY(T, vec)                        \
+    do                                            \
+    {                                             \
+      const T *p = (const T *)buf;                \
+      size_t n = len / sizeof(T);                 \
+      col->vec.resize(n);                         \
+      for ( size_t k = 0; k < n; k++ )            \
+        col->vec[k] = p[k];                       \
+    } while ( false )
+    switch ( *code )
+    {
+      case 'b': col->kind = column_t::INT;  LOAD_ARRAY(signed char, ints);    break;
+      case 'B': col->kind = column_t::UINT; LOAD_ARRAY(unsigned char, ints);  break;
+      case 'h': col->kind = column_t::INT;  LOAD_ARRAY(short, ints);          break;
+      case 'H': col->kind = column_t::UINT; LOAD_ARRAY(unsigned short, ints); break;
+      case 'i': col->kind = column_t::INT;  LOAD_ARRAY(int, ints);            break;
+      case 'I': col->kind = column_t::UINT; LOAD_ARRAY(unsigned int, ints);   break;
+      case 'l': col->kind = column_t::INT;  LOAD_ARRAY(long, ints);           break;
+      case 'L': col->kind = column_t::UINT; LOAD_ARRAY(unsigned long, ints);  break;
+      case 'f': col->kind = column_t::DBL;  LOAD_ARRAY(float, dbls);          break;
+      case 'd': col->kind = column_t::DBL;  LOAD_ARRAY(double, dbls);         break;
+      default:
+        errbuf->sprnt("unsupported array type '%s'", code);
+        return false;
+    }
+#undef LOAD_ARRAY
+    return true;
+  }
+
+  static bool load_list(column_t *col, PyObject *py_list, qstring *errbuf)
+  {
+    newref_t seq(PySequence_Fast(py_list, "columns must be lists or arrays"));
+    if ( seq == NULL )
+    {
+      PyErr_Clear();
+      *errbuf = "columns must be lists or arrays";
+      return false;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq.o);
+    PyObject **items = PySequence_Fast_ITEMS(seq.o);
+
+    // Numbers are kept as such if the column only contains numbers
+    bool numbers = n > 0;
+    bool negative = false;
+    for ( Py_ssize_t i = 0; numbers && i < n; i++ )
+    {
+      if ( PyInt_Check(items[i]) )
+        negative |= PyInt_AS_LONG(items[i]) < 0;
+      else if ( PyLong_Check(items[i]) )
+        negative |= _PyLong_Sign(items[i]) < 0;
+      else
+        numbers = false;
+    }
+    if ( numbers )
+    {
+      col->kind = negative ? column_t::INT : column_t::UINT;
+      col->ints.resize(n);
+      for ( Py_ssize_t i = 0; i < n; i++ )
+      {
+        col->ints[i] = negative
+                     ? PyLong_AsLongLong(items[i])
+                     : int64(PyInt_AsUnsignedLongLongMask(items[i]));
+      }
+      if ( PyErr_Occurred() )
+      {
+        PyErr_Clear();
+        *errbuf = "integer value out of range";
+        return false;
+      }
+      return true;
+    }
+
+    col->kind = column_t::STR;
+    col->offs.resize(n);
+    for ( Py_ssize_t i = 0; i < n; i++ )
+    {
+      newref_t py_str(PyObject_Str(items[i]));
+      const char *str = py_str == NULL ? NULL : PyString_AsString(py_str.o);
+      if ( str == NULL )
+      {
+        PyErr_Clear();
+        str = "";
+      }
+      size_t off = col->chars.size();
+      size_t len = strlen(str) + 1;
+      col->offs[i] = uint32(off);
+      col->chars.resize(off + len);
+      memcpy(&col->chars[off], str, len);
+    }
+    return true;
+  }
+
+  size_t column_size(const column_t &col) const
+  {
+    switch ( col.kind )
+    {
+      case column_t::STR: return col.offs.size();
+      case column_t::DBL: return col.dbls.size();
+      default:            return col.ints.size();
+    }
+  }
+
+  bool match_filter(int row) const
+  {
+    char buf[MAXSTR];
+    for ( size_t i = 0; i < columns.size(); i++ )
+    {
+      if ( filter_col >= 0 && size_t(filter_col) != i )
+        continue;
+      get_cell(row, i, buf, sizeof(buf));
+      if ( stristr(buf, filter.c_str()) != NULL )
+        return true;
+    }
+    return false;
+  }
+
+  void update_view()
+  {
+    view.qclear();
+    view.reserve(nrows);
+    for ( size_t i = 0; i < nrows; i++ )
+    {
+      if ( filter.empty() || match_filter(int(i)) )
+        view.push_back(int(i));
+    }
+    if ( sort_col >= 0 && size_t(sort_col) < columns.size() )
+    {
+      const column_t &col = columns[sort_col];
+      if ( sort_desc )
+        std::stable_sort(view.begin(), view.end(), row_greater_t(col));
+      else
+        std::stable_sort(view.begin(), view.end(), row_less_t(col));
+    }
+  }
+
+public:
+  chooser_table_t() : nrows(0), sort_col(-1), sort_desc(false), filter_col(-1) {}
+
+  // Copies the columns (a list of lists or array.array objects)
+  bool init(PyObject *py_table, const intvec_t &widths, qstring *errbuf)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t seq(PySequence_Fast(py_table, "the table must be a list of columns"));
+    if ( seq == NULL )
+    {
+      PyErr_Clear();
+      *errbuf = "the table must be a list of columns";
+      return false;
+    }
+    Py_ssize_t ncols = PySequence_Fast_GET_SIZE(seq.o);
+    if ( size_t(ncols) < widths.size() )
+    {
+      errbuf->sprnt("the table has %d columns, %d expected", int(ncols), int(widths.size()));
+      return false;
+    }
+    ncols = widths.size();
+
+    qvector<column_t> cols;
+    cols.resize(ncols);
+    for ( Py_ssize_t i = 0; i < ncols; i++ )
+    {
+      PyObject *py_col = PySequence_Fast_GET_ITEM(seq.o, i);
+      column_t &col = cols[i];
+      col.hex = (widths[i] & CHCOL_FORMAT) == CHCOL_HEX;
+      bool ok = PyList_Check(py_col) || PyTuple_Check(py_col)
+              ? load_list(&col, py_col, errbuf)
+              : load_array(&col, py_col, errbuf);
+      if ( !ok )
+        return false;
+      if ( i > 0 && column_size(col) != column_size(cols[0]) )
+      {
+        *errbuf = "all the columns must have the same length";
+        return false;
+      }
+    }
+    columns.swap(cols);
+    nrows = columns.empty() ? 0 : column_size(columns[0]);
+    update_view();
+    return true;
+  }
+
+  size_t size() const
+  {
+    return view.size();
+  }
+
+  // Displayed row -> table row (both 0-based)
+  int get_row(int n) const
+  {
+    return n >= 0 && size_t(n) < view.size() ? view[n] : n;
+  }
+
+  // Table row -> displayed row, -1 if filtered out
+  int find_view(int row) const
+  {
+    for ( size_t i = 0; i < view.size(); i++ )
+      if ( view[i] == row )
+        return int(i);
+    return -1;
+  }
+
+  void get_cell(int row, size_t colidx, char *buf, size_t bufsize) const
+  {
+    const column_t &col = columns[colidx];
+    switch ( col.kind )
+    {
+      case column_t::STR:
+        qstrncpy(buf, col.str(row), bufsize);
+        break;
+      case column_t::INT:
+        qsnprintf(buf, bufsize, "%" FMT_64 "d", col.ints[row]);
+        break;
+      case column_t::UINT:
+        qsnprintf(buf, bufsize, col.hex ? "%" FMT_64 "X" : "%" FMT_64 "u", uint64(col.ints[row]));
+        break;
+      default:
+        qsnprintf(buf, bufsize, "%g", col.dbls[row]);
+        break;
+    }
+  }
+
+  // Displays the rows sorted by the given column (-1: table order)
+  void sort(int col, bool descending)
+  {
+    sort_col = col;
+    sort_desc = descending;
+    update_view();
+  }
+
+  // Displays the rows that contain the text (case insensitive) in the
+  // given column (-1: in any column)
+  void set_filter(const char *text, int col)
+  {
+    filter = text == NULL ? "" : text;
+    filter_col = col;
+    update_view();
+  }
+};
+
 //------------------------------------------------------------------------
 class py_choose2_t
 {
@@ -56,7 +357,25 @@ private:
     CHOOSE2_HAVE_ONCLOSE   = 0x0100,
     CHOOSE2_HAVE_SELECT    = 0x0200,
     CHOOSE2_HAVE_REFRESHED = 0x0400,
+    CHOOSE2_HAVE_GETLINE   = 0x0800,
+    CHOOSE2_HAVE_GETLINES  = 0x1000,
+    CHOOSE2_HAVE_GETSIZE   = 0x2000,
+  };
+
+  // A row returned by OnGetLines()
+  struct cached_row_t
+  {
+    enum { ATTR_UNKNOWN, ATTR_NONE, ATTR_SET };
+    qstrvec_t cells;
+    int attr_state;
+    int color;
+    int attr_flags;
+    cached_row_t() : attr_state(ATTR_UNKNOWN), color(0), attr_flags(0) {}
   };
+  typedef qvector<cached_row_t> cached_rows_t;
+  // Block number -> rows of the block
+  typedef std::map<int, cached_rows_t> row_cache_t;
+
   // Chooser flags
   int flags;
 
@@ -82,6 +401,13 @@ private:
   const char **popup_names;
   bool ui_cb_hooked;
 
+  // Rows fetched with OnGetLines(), until the next refresh
+  row_cache_t row_cache;
+  ssize_t cached_size;
+
+  // Rows given up front in the 'table' attribute, if any
+  chooser_table_t *table;
+
   // The number of declarations should follow the MAX_CHOOSER_MENU_COMMANDS value
   MENU_COMMAND_CB(0)   MENU_COMMAND_CB(1)
   MENU_COMMAND_CB(2)   MENU_COMMAND_CB(3)
@@ -100,9 +426,6 @@ private:
   //------------------------------------------------------------------------
   static int idaapi ui_cb(void *obj, int notification_code, va_list va)
   {
-    // This hook gets called from the kernel. Ensure we hold the GIL.
-    PYW_GIL_GET;
-
     // UI callback to handle chooser items with attributes
     if ( notification_code != ui_get_chooser_item_attrs )
       return 0;
@@ -114,7 +437,12 @@ private:
 
     int n = int(va_arg(va, uint32));
     chooser_item_attrs_t *attr = va_arg(va, chooser_item_attrs_t *);
-    thisobj->on_get_line_attr(n, attr);
+    if ( !thisobj->get_cached_line_attr(n, attr) )
+    {
+      // This hook gets called from the kernel. Ensure we hold the GIL.
+      PYW_GIL_GET_HOOK(PYW_HOOK_CHOOSE2, notification_code);
+      thisobj->on_get_line_attr(n, attr);
+    }
     return 1;
   }
 
@@ -210,11 +538,161 @@ private:
     }
   }
 
-  void on_get_line(int lineno, char * const *line_arr)
+  //------------------------------------------------------------------------
+  // Row cache: OnGetLines() is asked for whole blocks of rows, which are
+  // then served without calling Python until the chooser is refreshed
+  //------------------------------------------------------------------------
+  bool use_row_cache() const
   {
-    // Called from s_getl, which itself can be called from the kernel. Ensure GIL
-    PYW_GIL_GET;
+    return table == NULL && (cb_flags & CHOOSE2_HAVE_GETLINES) != 0;
+  }
 
+  // Kernel line number (1-based, in display order) -> Python row number
+  int to_row(int lineno) const
+  {
+    return table == NULL ? lineno - 1 : table->get_row(lineno - 1);
+  }
+
+  // Python row number -> kernel line number
+  int to_lineno(int row) const
+  {
+    return table == NULL ? row + 1 : table->find_view(row) + 1;
+  }
+
+  void invalidate_rows()
+  {
+    row_cache.clear();
+    cached_size = -1;
+  }
+
+  void fetch_rows(int start, cached_rows_t *rows)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t py_rows(
+            PyObject_CallMethod(
+                    self,
+                    (char *)S_ON_GET_LINES,
+                    "ii",
+                    start,
+                    CHOOSE2_ROWS_PER_BLOCK));
+    if ( py_rows == NULL )
+      return;
+
+    newref_t seq(PySequence_Fast(py_rows.o, "OnGetLines() must return a list"));
+    if ( seq == NULL )
+      return;
+
+    Py_ssize_t nrows = qmin(PySequence_Fast_GET_SIZE(seq.o), Py_ssize_t(CHOOSE2_ROWS_PER_BLOCK));
+    rows->resize(nrows);
+    for ( Py_ssize_t r = 0; r < nrows; r++ )
+    {
+      cached_row_t &row = (*rows)[r];
+      PyObject *py_cols = PySequence_Fast_GET_ITEM(seq.o, r);
+      PyObject *py_attr = NULL;
+
+      // A row is either [col1, col2, ...] or ([col1, col2, ...], attrs)
+      if ( PyTuple_Check(py_cols)
+        && PyTuple_GET_SIZE(py_cols) == 2
+        && PySequence_Check(PyTuple_GET_ITEM(py_cols, 0))
+        && !PyString_Check(PyTuple_GET_ITEM(py_cols, 0)) )
+      {
+        py_attr = PyTuple_GET_ITEM(py_cols, 1);
+        py_cols = PyTuple_GET_ITEM(py_cols, 0);
+      }
+
+      row.cells.resize(cols.size());
+      newref_t py_cells(PySequence_Fast(py_cols, "OnGetLines() rows must be lists"));
+      if ( py_cells == NULL )
+      {
+        PyErr_Clear();
+        continue;
+      }
+      Py_ssize_t ncells = qmin(PySequence_Fast_GET_SIZE(py_cells.o), Py_ssize_t(cols.size()));
+      for ( Py_ssize_t i = 0; i < ncells; i++ )
+      {
+        const char *str = PyString_AsString(PySequence_Fast_GET_ITEM(py_cells.o, i));
+        if ( str != NULL )
+          row.cells[i] = str;
+        else
+          PyErr_Clear();
+      }
+
+      if ( py_attr != NULL )
+        set_row_attr(&row, py_attr);
+    }
+  }
+
+  static void set_row_attr(cached_row_t *row, PyObject *py_attr)
+  {
+    row->attr_state = cached_row_t::ATTR_NONE;
+    if ( PyList_Check(py_attr) && PyList_Size(py_attr) >= 2 )
+    {
+      row->color = PyInt_AsLong(PyList_GetItem(py_attr, 0));
+      row->attr_flags = PyInt_AsLong(PyList_GetItem(py_attr, 1));
+      // Not integers: the row has no attributes
+      if ( PyErr_Occurred() )
+        PyErr_Clear();
+      else
+        row->attr_state = cached_row_t::ATTR_SET;
+    }
+  }
+
+  cached_row_t *find_cached_row(int n)
+  {
+    row_cache_t::iterator p = row_cache.find(n / CHOOSE2_ROWS_PER_BLOCK);
+    if ( p == row_cache.end() )
+      return NULL;
+    size_t idx = n % CHOOSE2_ROWS_PER_BLOCK;
+    return idx < p->second.size() ? &p->second[idx] : NULL;
+  }
+
+  // Returns the row (0-based), asking Python for its block if needed
+  cached_row_t *get_cached_row(int n)
+  {
+    if ( n < 0 )
+      return NULL;
+    int block = n / CHOOSE2_ROWS_PER_BLOCK;
+    if ( row_cache.find(block) == row_cache.end() )
+    {
+      // Python may refresh the chooser while the rows are fetched:
+      // only insert the block once it is complete
+      PYW_GIL_GET;
+      cached_rows_t rows;
+      fetch_rows(block * CHOOSE2_ROWS_PER_BLOCK, &rows);
+      row_cache[block].swap(rows);
+    }
+    return find_cached_row(n);
+  }
+
+  // Fills the attributes of a cached row without entering Python
+  bool get_cached_line_attr(int lineno, chooser_item_attrs_t *attr)
+  {
+    if ( !use_row_cache() )
+      return false;
+    cached_row_t *row = get_cached_row(lineno - 1);
+    if ( row == NULL )
+      return false;
+    if ( row->attr_state == cached_row_t::ATTR_UNKNOWN )
+    {
+      if ( (cb_flags & CHOOSE2_HAVE_GETATTR) == 0 )
+        return true;
+      PYW_GIL_GET;
+      newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_GET_LINE_ATTR, "i", lineno - 1));
+      row = find_cached_row(lineno - 1);
+      if ( pyres == NULL || row == NULL )
+        return true;
+      set_row_attr(row, pyres.o);
+    }
+    if ( row->attr_state == cached_row_t::ATTR_SET )
+    {
+      attr->color = row->color;
+      attr->flags = row->attr_flags;
+    }
+    return true;
+  }
+
+  void on_get_line(int lineno, char * const *line_arr)
+  {
     // Get headers?
     if ( lineno == 0 )
     {
@@ -229,6 +707,30 @@ private:
     for ( int i=ncols-1; i>=0; i-- )
       line_arr[i][0] = '\0';
 
+    if ( table != NULL )
+    {
+      int row = table->get_row(lineno - 1);
+      for ( int i=ncols-1; i>=0; i-- )
+        table->get_cell(row, i, line_arr[i], MAXSTR);
+      return;
+    }
+
+    if ( use_row_cache() )
+    {
+      const cached_row_t *row = get_cached_row(lineno - 1);
+      if ( row != NULL )
+      {
+        for ( int i=ncols-1; i>=0; i-- )
+          qstrncpy(line_arr[i], row->cells[i].c_str(), MAXSTR);
+        return;
+      }
+      if ( (cb_flags & CHOOSE2_HAVE_GETLINE) == 0 )
+        return;
+    }
+
+    // Called from s_getl, which itself can be called from the kernel. Ensure GIL
+    PYW_GIL_GET;
+
     // Call Python
     PYW_GIL_CHECK_LOCKED_SCOPE();
     newref_t list(PyObject_CallMethod(self, (char *)S_ON_GET_LINE, "i", lineno - 1));
@@ -250,16 +752,24 @@ private:
 
   size_t on_get_size()
   {
+    if ( table != NULL )
+      return table->size();
+
+    if ( use_row_cache() && cached_size >= 0 )
+      return cached_size;
+
     PYW_GIL_GET;
     newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_GET_SIZE, NULL));
     if ( pyres == NULL )
       return 0;
 
-    return PyInt_AsLong(pyres.o);
+    cached_size = PyInt_AsLong(pyres.o);
+    return cached_size;
   }
 
   void on_refreshed()
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_REFRESHED, NULL));
   }
@@ -267,7 +777,13 @@ private:
   void on_select(const intvec_t &intvec)
   {
     PYW_GIL_GET;
-    ref_t py_list(PyW_IntVecToPyList(intvec));
+    intvec_t rows = intvec;
+    if ( table != NULL )
+    {
+      for ( size_t i = 0; i < rows.size(); i++ )
+        rows[i] = to_row(rows[i]);
+    }
+    ref_t py_list(PyW_IntVecToPyList(rows));
     newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_SELECT, "O", py_list.o));
   }
 
@@ -283,30 +799,33 @@ private:
 
   int on_delete_line(int lineno)
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(
             PyObject_CallMethod(
                     self,
                     (char *)S_ON_DELETE_LINE,
                     "i",
-                    lineno - 1));
-    return pyres == NULL ? lineno : PyInt_AsLong(pyres.o) + 1;
+                    to_row(lineno)));
+    return pyres == NULL ? lineno : to_lineno(PyInt_AsLong(pyres.o));
   }
 
   int on_refresh(int lineno)
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(
             PyObject_CallMethod(
                     self,
                     (char *)S_ON_REFRESH,
                     "i",
-                    lineno - 1));
-    return pyres == NULL ? lineno : PyInt_AsLong(pyres.o) + 1;
+                    to_row(lineno)));
+    return pyres == NULL ? lineno : to_lineno(PyInt_AsLong(pyres.o));
   }
 
   void on_insert_line()
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_INSERT_LINE, NULL));
   }
@@ -319,29 +838,31 @@ private:
                     self,
                     (char *)S_ON_SELECT_LINE,
                     "i",
-                    lineno - 1));
+                    to_row(lineno)));
   }
 
   void on_edit_line(int lineno)
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(
             PyObject_CallMethod(
                     self,
                     (char *)S_ON_EDIT_LINE,
                     "i",
-                    lineno - 1));
+                    to_row(lineno)));
   }
 
   int on_command(int cmd_id, int lineno)
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(
             PyObject_CallMethod(
                     self,
                     (char *)S_ON_COMMAND,
                     "ii",
-                    lineno - 1,
+                    to_row(lineno),
                     cmd_id));
     return pyres == NULL ? lineno : PyInt_AsLong(pyres.o);
   }
@@ -354,14 +875,14 @@ private:
                     self,
                     (char *)S_ON_GET_ICON,
                     "i",
-                    lineno - 1));
+                    to_row(lineno)));
     return PyInt_AsLong(pyres.o);
   }
 
   void on_get_line_attr(int lineno, chooser_item_attrs_t *attr)
   {
     PYW_GIL_GET;
-    newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_GET_LINE_ATTR, "i", lineno - 1));
+    newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_GET_LINE_ATTR, "i", to_row(lineno)));
     if ( pyres != NULL )
     {
       if ( PyList_Check(pyres.o) )
@@ -381,7 +902,8 @@ public:
   //------------------------------------------------------------------------
   py_choose2_t(): flags(0), cb_flags(0),
                   embedded(NULL), menu_cb_idx(0),
-                  self(NULL), popup_names(NULL), ui_cb_hooked(false)
+                  self(NULL), popup_names(NULL), ui_cb_hooked(false),
+                  cached_size(-1), table(NULL)
   {
   }
 
@@ -394,6 +916,7 @@ public:
     install_hooks(false);
 
     delete embedded;
+    delete table;
     Py_XDECREF(self);
     clear_popup_names();
   }
@@ -534,11 +1057,27 @@ public:
       widths.push_back(width);
     }
 
+    // Get the table, if the rows are given up front
+    ref_t table_attr(PyW_TryGetAttrString(self, "table"));
+    if ( table_attr != NULL && table_attr.o != Py_None )
+    {
+      qstring errbuf;
+      table = new chooser_table_t();
+      if ( !table->init(table_attr.o, widths, &errbuf) )
+      {
+        msg("Choose2: %s\n", errbuf.c_str());
+        return -1;
+      }
+    }
+
     // Get *deflt
     int deflt = -1;
     ref_t deflt_attr(PyW_TryGetAttrString(self, "deflt"));
     if ( deflt_attr != NULL )
       deflt = PyInt_AsLong(deflt_attr.o);
+    // *deflt is a 1-based row number: map it to its displayed line
+    if ( deflt > 0 )
+      deflt = to_lineno(deflt - 1);
 
     // Get *icon
     int icon = -1;
@@ -565,9 +1104,10 @@ public:
       unsigned int have; // 0 = mandatory callback
     } callbacks[] =
     {
-      {S_ON_GET_SIZE,      0},
-      {S_ON_GET_LINE,      0},
       {S_ON_CLOSE,         0},
+      {S_ON_GET_SIZE,         CHOOSE2_HAVE_GETSIZE},
+      {S_ON_GET_LINE,         CHOOSE2_HAVE_GETLINE},
+      {S_ON_GET_LINES,        CHOOSE2_HAVE_GETLINES},
       {S_ON_EDIT_LINE,        CHOOSE2_HAVE_EDIT},
       {S_ON_INSERT_LINE,      CHOOSE2_HAVE_INS},
       {S_ON_DELETE_LINE,      CHOOSE2_HAVE_DEL},
@@ -596,6 +1136,14 @@ public:
       }
     }
 
+    // Without a table, the rows come from Python: either row provider will do
+    if ( table == NULL
+      && ((cb_flags & CHOOSE2_HAVE_GETSIZE) == 0
+       || (cb_flags & (CHOOSE2_HAVE_GETLINE|CHOOSE2_HAVE_GETLINES)) == 0) )
+    {
+      return -1;
+    }
+
     // Get *popup names
     // An array of 4 strings: ("Insert", "Delete", "Edit", "Refresh"
     ref_t pn_attr(PyW_TryGetAttrString(self, S_POPUP_NAMES));
@@ -612,8 +1160,10 @@ public:
     }
 
     // Adjust flags (if needed)
-    if ( (cb_flags & CHOOSE2_HAVE_GETATTR) != 0 )
+    // (OnGetLines() may return the row attributes along with the row)
+    if ( (cb_flags & (CHOOSE2_HAVE_GETATTR|CHOOSE2_HAVE_GETLINES)) != 0 )
       flags |= CH_ATTRS;
+    invalidate_rows();
 
     // Increase object reference
     Py_INCREF(self);
@@ -689,8 +1239,9 @@ public:
       clear_popup_names();
 
       // Modal chooser return the index of the selected item
+      // (to_row() gives -1 if it was cancelled)
       if ( is_modal() )
-        r--;
+        r = to_row(r);
     }
     // Embedded chooser?
     else
@@ -709,6 +1260,7 @@ public:
 
   void refresh()
   {
+    invalidate_rows();
     refresh_chooser(title.c_str());
   }
 
@@ -722,10 +1274,53 @@ public:
     return &embedded_sel;
   }
 
+  // The selection of the embedded chooser as 0-based Python row numbers
+  void get_selected_rows(intvec_t *rows) const
+  {
+    *rows = embedded_sel;
+    for ( size_t i = 0; i < rows->size(); i++ )
+      (*rows)[i] = to_row((*rows)[i]);
+  }
+
   chooser_info_t *get_embedded() const
   {
     return embedded;
   }
+
+  PyObject *set_table(PyObject *py_table)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    qstring errbuf;
+    chooser_table_t *t = new chooser_table_t();
+    if ( !t->init(py_table, widths, &errbuf) )
+    {
+      delete t;
+      PyErr_SetString(PyExc_ValueError, errbuf.c_str());
+      return NULL;
+    }
+    delete table;
+    table = t;
+    refresh();
+    Py_RETURN_TRUE;
+  }
+
+  bool sort_table(int col, bool descending)
+  {
+    if ( table == NULL )
+      return false;
+    table->sort(col, descending);
+    refresh();
+    return true;
+  }
+
+  bool filter_table(const char *text, int col)
+  {
+    if ( table == NULL )
+      return false;
+    table->set_filter(text, col);
+    refresh();
+    return true;
+  }
 };
 
 //------------------------------------------------------------------------
@@ -748,6 +1343,7 @@ chooser_cb_t *py_choose2_t::menu_cbs[MAX_CHOOSER_MENU_COMMANDS] =
 
 #undef POPUP_NAMES_COUNT
 #undef MAX_CHOOSER_MENU_COMMANDS
+#undef CHOOSE2_ROWS_PER_BLOCK
 #undef thisobj
 #undef thisdecl
 #undef MENU_COMMAND_CB
@@ -831,14 +1427,10 @@ PyObject *choose2_get_embedded_selection(PyObject *self)
   if ( c2 == NULL || (embedded = c2->get_embedded()) == NULL )
     Py_RETURN_NONE;
 
-  // Returned as 1-based
-  intvec_t &intvec = *c2->get_sel_vec();
+  intvec_t rows;
+  c2->get_selected_rows(&rows);
 
-  // Make 0-based
-  for ( intvec_t::iterator it=intvec.begin(); it != intvec.end(); ++it)
-    (*it)--;
-
-  ref_t ret(PyW_IntVecToPyList(intvec));
+  ref_t ret(PyW_IntVecToPyList(rows));
   ret.incref();
   return ret.o;
 }
@@ -881,6 +1473,30 @@ PyObject *choose2_find(const char *title)
   py_choose2_t *c2 = py_choose2_t::find_chooser(title);
   return c2 == NULL ? NULL : c2->get_self();
 }
+
+//------------------------------------------------------------------------
+PyObject *choose2_set_table(PyObject *self, PyObject *table)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  py_choose2_t *c2 = choose2_find_instance(self);
+  if ( c2 == NULL )
+    Py_RETURN_FALSE;
+  return c2->set_table(table);
+}
+
+//------------------------------------------------------------------------
+bool choose2_sort(PyObject *self, int col, bool descending)
+{
+  py_choose2_t *c2 = choose2_find_instance(self);
+  return c2 != NULL && c2->sort_table(col, descending);
+}
+
+//------------------------------------------------------------------------
+bool choose2_filter(PyObject *self, const char *text, int col)
+{
+  py_choose2_t *c2 = choose2_find_instance(self);
+  return c2 != NULL && c2->filter_table(text, col);
+}
 //</code(py_kernwin)>
 
 //---------------------------------------------------------------------------
@@ -893,6 +1509,9 @@ int choose2_create(PyObject *self, bool embedded);
 void choose2_activate(PyObject *self);
 PyObject *choose2_get_embedded(PyObject *self);
 PyObject *choose2_get_embedded_selection(PyObject *self);
+PyObject *choose2_set_table(PyObject *self, PyObject *table);
+bool choose2_sort(PyObject *self, int col, bool descending);
+bool choose2_filter(PyObject *self, const char *text, int col);
 //</inline(py_kernwin)>
 
 //---------------------------------------------------------------------------
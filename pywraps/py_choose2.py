@@ -20,6 +20,9 @@ try:
     _idaapi.choose2_add_command   = pywraps.py_choose2_add_command
     _idaapi.choose2_get_embedded  = pywraps.py_choose2_get_embedded
     _idaapi.choose2_get_embedded_selection = pywraps.py_choose2_get_embedded_selection
+    _idaapi.choose2_set_table     = pywraps.py_choose2_set_table
+    _idaapi.choose2_sort          = pywraps.py_choose2_sort
+    _idaapi.choose2_filter        = pywraps.py_choose2_filter
 
     try:
         # Get function address
@@ -67,7 +70,7 @@ class Choose2(object):
 
     def __init__(self, title, cols, flags=0, popup_names=None,
                  icon=-1, x1=-1, y1=-1, x2=-1, y2=-1, deflt=-1,
-                 embedded=False, width=None, height=None):
+                 embedded=False, width=None, height=None, table=None):
         """
         Constructs a chooser window.
         @param title: The chooser title
@@ -81,6 +84,7 @@ class Choose2(object):
         @param embedded: Create as embedded chooser
         @param width: Embedded chooser width
         @param height: Embedded chooser height
+        @param table: The rows, given up front as a list of columns (see SetTable())
         """
         self.title = title
         self.flags = flags
@@ -93,6 +97,7 @@ class Choose2(object):
         self.x2 = x2
         self.y2 = y2
         self.embedded = embedded
+        self.table = table
         if embedded:
 	        self.x1 = width
 	        self.y1 = height
@@ -146,7 +151,10 @@ class Choose2(object):
 
 
     def Refresh(self):
-        """Causes the refresh callback to trigger"""
+        """
+        Causes the refresh callback to trigger.
+        The rows cached from OnGetLines() are requested again.
+        """
         return _idaapi.choose2_refresh(self)
 
 
@@ -155,6 +163,43 @@ class Choose2(object):
         return _idaapi.choose2_close(self)
 
 
+    def SetTable(self, table):
+        """
+        Gives the rows up front. The table is copied when the chooser is
+        created and is then displayed, sorted and filtered without calling
+        OnGetSize() and OnGetLine(), which become optional. The line numbers
+        passed to the other callbacks are indices in the table.
+
+        @param table: A list with one entry per column: either a list (of
+            str, or of numbers) or an array.array of numbers.
+            Numbers are displayed in hexadecimal in the CHCOL_HEX columns.
+        @return: False if the chooser is not displayed yet (the table will be
+            used when it is); raises ValueError if the table is invalid
+        """
+        self.table = table
+        return _idaapi.choose2_set_table(self, table)
+
+
+    def Sort(self, col, descending=False):
+        """
+        Sorts the rows of the table (strings are compared case insensitively,
+        as Filter() does)
+        @param col: Column number, or -1 to restore the table order
+        @return: False if the chooser has no table or is not displayed
+        """
+        return _idaapi.choose2_sort(self, col, descending)
+
+
+    def Filter(self, text, col=-1):
+        """
+        Only displays the rows of the table containing a text (case insensitive)
+        @param text: The text to look for, an empty string displays all the rows
+        @param col: Column number, or -1 to look in all the columns
+        @return: False if the chooser has no table or is not displayed
+        """
+        return _idaapi.choose2_filter(self, text, col)
+
+
     def AddCommand(self,
                    caption,
                    flags = _idaapi.CHOOSER_POPUP_MENU,
@@ -187,16 +232,31 @@ class Choose2(object):
 #
 #    def OnGetLine(self, n):
 #        """Called when the chooser window requires lines.
-#        This callback is mandatory.
+#        This callback is mandatory unless OnGetLines() is implemented
+#        or the chooser has a table.
 #        @param n: Line number (0-based)
 #        @return: The user should return a list with ncols elements.
 #            example: a list [col1, col2, col3, ...] describing the n-th line
 #        """
 #        return ["col1 val", "col2 val"]
 #
+#    def OnGetLines(self, start, count):
+#        """Called when the chooser window requires a block of lines.
+#        If implemented, it is used instead of OnGetLine() and the returned
+#        rows, as well as OnGetSize(), are cached until the chooser is
+#        refreshed or edited (Refresh(), OnRefresh(), OnEditLine(), ...)
+#        @param start: First line number (0-based)
+#        @param count: Maximum number of lines to return
+#        @return: A list of up to count rows. Each row is either a list
+#            of ncols elements (as returned by OnGetLine()) or a tuple
+#            (cols, attrs) where attrs is what OnGetLineAttr() would return.
+#            OnGetLine() is used for the rows that were not returned.
+#        """
+#        return [ self.items[n] for n in xrange(start, min(start + count, len(self.items))) ]
+#
 #    def OnGetSize(self):
 #        """Returns the element count.
-#        This callback is mandatory.
+#        This callback is mandatory, unless the chooser has a table.
 #        @return: Number of elements
 #        """
 #        return len(self.the_list)
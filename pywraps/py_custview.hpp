@@ -12,7 +12,59 @@ public:
 };
 
 //---------------------------------------------------------------------------
-class cvdata_simpleline_t: public custviewer_data_t
+// Convert a tuple (String, [color, [bgcolor]]) to a simpleline_t
+static bool py_to_simpleline(PyObject *py, simpleline_t &sl)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+
+  if ( PyString_Check(py) )
+  {
+    sl.line = PyString_AsString(py);
+    return true;
+  }
+  Py_ssize_t sz;
+  if ( !PyTuple_Check(py) || (sz = PyTuple_Size(py)) <= 0 )
+    return false;
+
+  PyObject *py_val = PyTuple_GetItem(py, 0);
+  if ( !PyString_Check(py_val) )
+    return false;
+
+  sl.line = PyString_AsString(py_val);
+
+  if ( (sz > 1) && (py_val = PyTuple_GetItem(py, 1)) && PyLong_Check(py_val)  )
+    sl.color = color_t(PyLong_AsUnsignedLong(py_val));
+
+  if ( (sz > 2) && (py_val = PyTuple_GetItem(py, 2)) && PyLong_Check(py_val)  )
+    sl.bgcolor = PyLong_AsUnsignedLong(py_val);
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// Lines of a simple custom viewer
+class cvdata_lines_t: public custviewer_data_t
+{
+public:
+  virtual ~cvdata_lines_t() {}
+  virtual size_t count() const = 0;
+  virtual bool get_line(size_t nline, simpleline_t *sl) = 0;
+  virtual bool set_line(size_t nline, const simpleline_t &sl) = 0;
+  virtual bool insert_line(size_t nline, const simpleline_t &sl) = 0;
+  virtual bool add_line(const simpleline_t &sl) = 0;
+  virtual bool del_line(size_t nline) = 0;
+  virtual bool patch_line(size_t nline, size_t offs, int value) = 0;
+  virtual void clear_lines() = 0;
+  virtual void set_minmax(size_t start=0, size_t end=size_t(-1)) = 0;
+  virtual size_t to_lineno(place_t *pl) const = 0;
+  // Returns a new place for the line
+  virtual place_t *new_place(size_t nline) const = 0;
+  // Forgets the lines that were cached
+  virtual void invalidate() {}
+};
+
+//---------------------------------------------------------------------------
+class cvdata_simpleline_t: public cvdata_lines_t
 {
 private:
   strvec_t lines;
@@ -54,7 +106,7 @@ public:
     }
   }
 
-  bool set_line(size_t nline, simpleline_t &sl)
+  bool set_line(size_t nline, const simpleline_t &sl)
   {
     if ( nline >= lines.size() )
       return false;
@@ -70,9 +122,10 @@ public:
     return true;
   }
 
-  void add_line(simpleline_t &line)
+  bool add_line(const simpleline_t &line)
   {
     lines.push_back(line);
+    return true;
   }
 
   void add_line(const char *str)
@@ -80,7 +133,7 @@ public:
     lines.push_back(simpleline_t(str));
   }
 
-  bool insert_line(size_t nline, simpleline_t &line)
+  bool insert_line(size_t nline, const simpleline_t &line)
   {
     if ( nline >= lines.size() )
       return false;
@@ -97,11 +150,16 @@ public:
     return true;
   }
 
-  const size_t to_lineno(place_t *pl) const
+  size_t to_lineno(place_t *pl) const
   {
     return ((simpleline_place_t *)pl)->n;
   }
 
+  place_t *new_place(size_t nline) const
+  {
+    return new simpleline_place_t(int(nline));
+  }
+
   bool curline(place_t *pl, size_t *n)
   {
     if ( pl == NULL )
@@ -121,7 +179,15 @@ public:
     return pl == NULL ? NULL : get_line(((simpleline_place_t *)pl)->n);
   }
 
-  const size_t count() const
+  bool get_line(size_t nline, simpleline_t *sl)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    *sl = lines[nline];
+    return true;
+  }
+
+  size_t count() const
   {
     return lines.size();
   }
@@ -133,6 +199,349 @@ public:
   }
 };
 
+//---------------------------------------------------------------------------
+// Place of the viewers whose lines are not kept in a strvec_t.
+// 'ud' is the cvdata_lines_t that gives the lines.
+class pyline_place_t: public place_t
+{
+  static cvdata_lines_t *data(void *ud) { return (cvdata_lines_t *)ud; }
+public:
+  size_t n;
+  pyline_place_t(size_t x=0) : n(x) { lnnum = 0; }
+
+  void idaapi print(void * /*ud*/, char *buf, size_t bufsize) const
+  {
+    qsnprintf(buf, bufsize, "%" FMT_64 "u", uint64(n));
+  }
+  uval_t idaapi touval(void * /*ud*/) const
+  {
+    return uval_t(n);
+  }
+  place_t *idaapi clone(void) const
+  {
+    return new pyline_place_t(*this);
+  }
+  void idaapi copyfrom(const place_t *from)
+  {
+    const pyline_place_t *s = (const pyline_place_t *)from;
+    n = s->n;
+    lnnum = s->lnnum;
+  }
+  place_t *idaapi makeplace(void * /*ud*/, uval_t x, short ln) const
+  {
+    pyline_place_t *p = new pyline_place_t(size_t(x));
+    p->lnnum = ln;
+    return p;
+  }
+  int idaapi compare(const place_t *t2) const
+  {
+    size_t n2 = ((const pyline_place_t *)t2)->n;
+    return n < n2 ? -1 : n > n2 ? 1 : 0;
+  }
+  void idaapi adjust(void *ud)
+  {
+    size_t cnt = data(ud)->count();
+    if ( n >= cnt )
+      n = cnt == 0 ? 0 : cnt - 1;
+    lnnum = 0;
+  }
+  bool idaapi prev(void * /*ud*/)
+  {
+    if ( n == 0 )
+      return false;
+    n--;
+    return true;
+  }
+  bool idaapi next(void *ud)
+  {
+    if ( n + 1 >= data(ud)->count() )
+      return false;
+    n++;
+    return true;
+  }
+  bool idaapi beginning(void * /*ud*/) const
+  {
+    return n == 0;
+  }
+  bool idaapi ending(void *ud) const
+  {
+    return n + 1 >= data(ud)->count();
+  }
+  int idaapi generate(
+        void *ud,
+        char *lines[],
+        int maxsize,
+        int *default_lnnum,
+        color_t *prefix_color,
+        bgcolor_t *bg_color) const
+  {
+    simpleline_t sl;
+    if ( maxsize <= 0 || !data(ud)->get_line(n, &sl) )
+      return 0;
+    lines[0] = qstrdup(sl.line.c_str());
+    *prefix_color = sl.color;
+    *bg_color = sl.bgcolor;
+    *default_lnnum = 0;
+    return 1;
+  }
+};
+
+//---------------------------------------------------------------------------
+// Base of the line stores that use pyline_place_t
+class cvdata_vlines_t: public cvdata_lines_t
+{
+private:
+  pyline_place_t pl_min, pl_max;
+public:
+  void *get_ud()
+  {
+    return static_cast<cvdata_lines_t *>(this);
+  }
+
+  place_t *get_min()
+  {
+    return &pl_min;
+  }
+
+  place_t *get_max()
+  {
+    return &pl_max;
+  }
+
+  void set_minmax(size_t start=0, size_t end=size_t(-1))
+  {
+    if ( start == 0 && end == size_t(-1) )
+    {
+      end = count();
+      pl_min.n = 0;
+      pl_max.n = end == 0 ? 0 : end - 1;
+    }
+    else
+    {
+      pl_min.n = start;
+      pl_max.n = end;
+    }
+  }
+
+  size_t to_lineno(place_t *pl) const
+  {
+    return ((pyline_place_t *)pl)->n;
+  }
+
+  place_t *new_place(size_t nline) const
+  {
+    return new pyline_place_t(nline);
+  }
+};
+
+//---------------------------------------------------------------------------
+// Lines kept as consecutive NUL-terminated strings in a single buffer,
+// with an index of offsets. Edited and deleted lines leave unused text
+// behind; it is reclaimed once it is half of the buffer.
+class cvdata_arena_t: public cvdata_vlines_t
+{
+private:
+  struct line_t
+  {
+    size_t off;
+    bgcolor_t bgcolor;
+    color_t color;
+  };
+  qvector<char> text;
+  qvector<line_t> lines;
+  size_t garbage;
+
+  size_t append_text(const char *str)
+  {
+    size_t off = text.size();
+    size_t len = strlen(str) + 1;
+    text.resize(off + len);
+    memcpy(&text[off], str, len);
+    return off;
+  }
+
+  void make_line(line_t *l, const simpleline_t &sl)
+  {
+    l->off = append_text(sl.line.c_str());
+    l->color = sl.color;
+    l->bgcolor = sl.bgcolor;
+  }
+
+  void forget_text(size_t nline)
+  {
+    garbage += strlen(&text[lines[nline].off]) + 1;
+    if ( garbage < 0x10000 || garbage < text.size() / 2 )
+      return;
+
+    qvector<char> packed;
+    packed.swap(text);
+    text.reserve(packed.size() - garbage);
+    for ( size_t i = 0; i < lines.size(); i++ )
+    {
+      if ( i != nline )
+        lines[i].off = append_text(&packed[lines[i].off]);
+    }
+    garbage = 0;
+  }
+
+public:
+  cvdata_arena_t() : garbage(0) {}
+
+  size_t count() const
+  {
+    return lines.size();
+  }
+
+  bool get_line(size_t nline, simpleline_t *sl)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    const line_t &l = lines[nline];
+    sl->line = &text[l.off];
+    sl->color = l.color;
+    sl->bgcolor = l.bgcolor;
+    return true;
+  }
+
+  bool set_line(size_t nline, const simpleline_t &sl)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    forget_text(nline);
+    make_line(&lines[nline], sl);
+    return true;
+  }
+
+  bool insert_line(size_t nline, const simpleline_t &sl)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    line_t l;
+    make_line(&l, sl);
+    lines.insert(lines.begin() + nline, l);
+    return true;
+  }
+
+  bool add_line(const simpleline_t &sl)
+  {
+    make_line(&lines.push_back(), sl);
+    return true;
+  }
+
+  bool del_line(size_t nline)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    forget_text(nline);
+    lines.erase(lines.begin() + nline);
+    return true;
+  }
+
+  bool patch_line(size_t nline, size_t offs, int value)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    char *str = &text[lines[nline].off];
+    if ( offs >= strlen(str) )
+      return false;
+    str[offs] = char(value & 0xFF);
+    return true;
+  }
+
+  void clear_lines()
+  {
+    text.clear();
+    lines.clear();
+    garbage = 0;
+    set_minmax();
+  }
+};
+
+//---------------------------------------------------------------------------
+// Lines requested from Python (OnGetLine()) when they are displayed.
+// The last ones are kept in a fixed-size cache indexed by line number.
+class cvdata_provider_t: public cvdata_vlines_t
+{
+private:
+  struct cached_line_t
+  {
+    size_t n;
+    simpleline_t sl;
+  };
+  qvector<cached_line_t> cache;
+  size_t nlines;
+  PyObject *self;
+
+public:
+  cvdata_provider_t(size_t cache_size) : nlines(0), self(NULL)
+  {
+    cache.resize(qmax(cache_size, size_t(1)));
+    invalidate();
+  }
+
+  void set_self(PyObject *py_self)
+  {
+    self = py_self;
+  }
+
+  void set_count(size_t n)
+  {
+    nlines = n;
+    invalidate();
+    set_minmax();
+  }
+
+  void invalidate()
+  {
+    for ( size_t i = 0; i < cache.size(); i++ )
+      cache[i].n = size_t(-1);
+  }
+
+  size_t count() const
+  {
+    return nlines;
+  }
+
+  bool get_line(size_t nline, simpleline_t *sl)
+  {
+    if ( nline >= nlines )
+      return false;
+    cached_line_t &cl = cache[nline % cache.size()];
+    if ( cl.n != nline )
+    {
+      if ( self == NULL )
+        return false;
+      PYW_GIL_GET;
+      newref_t py_line(
+              PyObject_CallMethod(
+                      self,
+                      (char *)S_ON_GET_LINE,
+                      PY_FMT64,
+                      pyul_t(nline)));
+      PyW_ShowCbErr(S_ON_GET_LINE);
+      simpleline_t line;
+      if ( py_line == NULL || !py_to_simpleline(py_line.o, line) )
+        return false;
+      cl.sl = line;
+      cl.n = nline;
+    }
+    *sl = cl.sl;
+    return true;
+  }
+
+  // The lines belong to Python
+  bool set_line(size_t, const simpleline_t &) { return false; }
+  bool insert_line(size_t, const simpleline_t &) { return false; }
+  bool add_line(const simpleline_t &) { return false; }
+  bool del_line(size_t) { return false; }
+  bool patch_line(size_t, size_t, int) { return false; }
+
+  void clear_lines()
+  {
+    set_count(0);
+  }
+};
+
 //---------------------------------------------------------------------------
 class customviewer_t
 {
@@ -542,41 +951,20 @@ size_t customviewer_t::_global_popup_id = 0;
 //---------------------------------------------------------------------------
 class py_simplecustview_t: public customviewer_t
 {
+public:
+  // How the lines are stored (see simplecustviewer_t.Create())
+  enum
+  {
+    LINES_LIST,
+    LINES_COMPACT,
+    LINES_PROVIDER,
+  };
 private:
-  cvdata_simpleline_t data;
+  cvdata_lines_t *data;
+  int lines_mode;
   PyObject *py_self, *py_this, *py_last_link;
   int features;
 
-  //--------------------------------------------------------------------------
-  // Convert a tuple (String, [color, [bgcolor]]) to a simpleline_t
-  static bool py_to_simpleline(PyObject *py, simpleline_t &sl)
-  {
-    PYW_GIL_CHECK_LOCKED_SCOPE();
-
-    if ( PyString_Check(py) )
-    {
-      sl.line = PyString_AsString(py);
-      return true;
-    }
-    Py_ssize_t sz;
-    if ( !PyTuple_Check(py) || (sz = PyTuple_Size(py)) <= 0 )
-      return false;
-
-    PyObject *py_val = PyTuple_GetItem(py, 0);
-    if ( !PyString_Check(py_val) )
-      return false;
-
-    sl.line = PyString_AsString(py_val);
-
-    if ( (sz > 1) && (py_val = PyTuple_GetItem(py, 1)) && PyLong_Check(py_val)  )
-      sl.color = color_t(PyLong_AsUnsignedLong(py_val));
-
-    if ( (sz > 2) && (py_val = PyTuple_GetItem(py, 2)) && PyLong_Check(py_val)  )
-      sl.bgcolor = PyLong_AsUnsignedLong(py_val);
-
-    return true;
-  }
-
   //
   // Callbacks
   //
@@ -659,7 +1047,7 @@ private:
   // OnHint
   virtual bool on_hint(place_t *place, int *important_lines, qstring &hint)
   {
-    size_t ln = data.to_lineno(place);
+    size_t ln = data->to_lineno(place);
     PYW_GIL_CHECK_LOCKED_SCOPE();
     newref_t py_result(
             PyObject_CallMethod(
@@ -697,17 +1085,18 @@ private:
   //--------------------------------------------------------------------------
   void refresh_range()
   {
-    data.set_minmax();
+    data->set_minmax();
     set_range();
   }
 
 public:
-  py_simplecustview_t()
+  py_simplecustview_t() : data(NULL), lines_mode(LINES_LIST)
   {
     py_this = py_self = py_last_link = NULL;
   }
   ~py_simplecustview_t()
   {
+    delete data;
   }
 
   //--------------------------------------------------------------------------
@@ -718,13 +1107,13 @@ public:
     if ( !py_to_simpleline(py_sl, sl) )
       return false;
 
-    return data.set_line(nline, sl);
+    return data->set_line(nline, sl);
   }
 
   // Low level: patches a line string directly
   bool patch_line(size_t nline, size_t offs, int value)
   {
-    return data.patch_line(nline, offs, value);
+    return data->patch_line(nline, offs, value);
   }
 
   // Insert a line
@@ -733,24 +1122,58 @@ public:
     simpleline_t sl;
     if ( !py_to_simpleline(py_sl, sl) )
       return false;
-    return data.insert_line(nline, sl);
+    return data->insert_line(nline, sl);
   }
 
   // Adds a line tuple
   bool add_line(PyObject *py_sl)
   {
     simpleline_t sl;
-    if ( !py_to_simpleline(py_sl, sl) )
+    if ( !py_to_simpleline(py_sl, sl) || !data->add_line(sl) )
       return false;
-    data.add_line(sl);
     refresh_range();
     return true;
   }
 
+  // Adds the line tuples of a sequence, stops at the first invalid one.
+  // Returns the number of lines added
+  size_t add_lines(PyObject *py_lines)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t seq(PySequence_Fast(py_lines, "a list of lines is expected"));
+    if ( seq == NULL )
+    {
+      PyErr_Clear();
+      return 0;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq.o);
+    PyObject **items = PySequence_Fast_ITEMS(seq.o);
+    size_t added = 0;
+    for ( ; added < size_t(n); added++ )
+    {
+      simpleline_t sl;
+      if ( !py_to_simpleline(items[added], sl) || !data->add_line(sl) )
+        break;
+    }
+    if ( added > 0 )
+      refresh_range();
+    return added;
+  }
+
+  // Sets the number of lines of a viewer whose lines come from OnGetLine()
+  bool set_line_count(size_t n)
+  {
+    if ( lines_mode != LINES_PROVIDER )
+      return false;
+    ((cvdata_provider_t *)data)->set_count(n);
+    set_range();
+    return true;
+  }
+
   //--------------------------------------------------------------------------
   bool del_line(size_t nline)
   {
-    bool ok = data.del_line(nline);
+    bool ok = data->del_line(nline);
     if ( ok )
       refresh_range();
     return ok;
@@ -766,48 +1189,84 @@ public:
     PYW_GIL_CHECK_LOCKED_SCOPE();
     if ( pl == NULL )
       Py_RETURN_NONE;
-    return Py_BuildValue("(" PY_FMT64 "ii)", pyul_t(data.to_lineno(pl)), x, y);
+    return Py_BuildValue("(" PY_FMT64 "ii)", pyul_t(data->to_lineno(pl)), x, y);
   }
 
   //--------------------------------------------------------------------------
   // Returns the line tuple
   PyObject *get_line(size_t nline)
   {
-    simpleline_t *r = data.get_line(nline);
+    simpleline_t r;
+    bool ok = data->get_line(nline, &r);
     PYW_GIL_CHECK_LOCKED_SCOPE();
-    if ( r == NULL )
+    if ( !ok )
       Py_RETURN_NONE;
-    return Py_BuildValue("(sII)", r->line.c_str(), (unsigned int)r->color, (unsigned int)r->bgcolor);
+    return Py_BuildValue("(sII)", r.line.c_str(), (unsigned int)r.color, (unsigned int)r.bgcolor);
   }
 
   // Returns the count of lines
   const size_t count() const
   {
-    return data.count();
+    return data == NULL ? 0 : data->count();
   }
 
   // Clears lines
   void clear()
   {
-    data.clear_lines();
+    data->clear_lines();
     refresh_range();
   }
 
+  //--------------------------------------------------------------------------
+  bool refresh()
+  {
+    // Lines provided by Python may have changed
+    data->invalidate();
+    return customviewer_t::refresh();
+  }
+
   //--------------------------------------------------------------------------
   bool jumpto(size_t ln, int x, int y)
   {
-    simpleline_place_t l(ln);
-    return customviewer_t::jumpto(&l, x, y);
+    place_t *pl = data->new_place(ln);
+    bool ok = customviewer_t::jumpto(pl, x, y);
+    delete pl;
+    return ok;
   }
 
   //--------------------------------------------------------------------------
   // Initializes and links the Python object to this class
-  bool init(PyObject *py_link, const char *title)
+  bool init(
+        PyObject *py_link,
+        const char *title,
+        int mode = LINES_LIST,
+        size_t cache_size = 1024)
   {
     // Already created?
     if ( _form != NULL )
       return true;
 
+    // The line store is kept when the view is re-created
+    if ( data == NULL )
+    {
+      lines_mode = mode;
+      switch ( mode )
+      {
+        case LINES_COMPACT:
+          data = new cvdata_arena_t();
+          break;
+        case LINES_PROVIDER:
+          data = new cvdata_provider_t(cache_size);
+          break;
+        default:
+          lines_mode = LINES_LIST;
+          data = new cvdata_simpleline_t();
+          break;
+      }
+    }
+    if ( lines_mode == LINES_PROVIDER )
+      ((cvdata_provider_t *)data)->set_self(py_link);
+
     // Probe callbacks
     features = 0;
     static struct
@@ -832,7 +1291,7 @@ public:
         features |= cbtable[i].feature;
     }
 
-    if ( !create(title, features, &data) )
+    if ( !create(title, features, data) )
       return false;
 
     // Hold a reference to this object
@@ -853,7 +1312,7 @@ public:
     if ( _form == NULL && py_last_link != NULL )
     {
       // Re-create the view (with same previous parameters)
-      if ( !init(py_last_link, _title.c_str()) )
+      if ( !init(py_last_link, _title.c_str(), lines_mode) )
         return false;
     }
     return customviewer_t::show();
@@ -870,9 +1329,9 @@ public:
       return false;
 
     if ( y1 != NULL )
-      *y1 = data.to_lineno(p1.at);
+      *y1 = data->to_lineno(p1.at);
     if ( y2 != NULL )
-      *y2 = data.to_lineno(p2.at);
+      *y2 = data->to_lineno(p2.at);
     if ( x1 != NULL )
       *x1 = size_t(p1.x);
     if ( x2 != NULL )
@@ -911,11 +1370,15 @@ public:
 //
 // Pywraps Simple Custom Viewer functions
 //
-PyObject *pyscv_init(PyObject *py_link, const char *title)
+PyObject *pyscv_init(
+        PyObject *py_link,
+        const char *title,
+        int lines_mode = 0,
+        size_t cache_size = 1024)
 {
   PYW_GIL_CHECK_LOCKED_SCOPE();
   py_simplecustview_t *_this = new py_simplecustview_t();
-  bool ok = _this->init(py_link, title);
+  bool ok = _this->init(py_link, title, lines_mode, cache_size);
   if ( !ok )
   {
     delete _this;
@@ -1057,6 +1520,21 @@ bool pyscv_add_line(PyObject *py_this, PyObject *py_sl)
   return _this == NULL ? false : _this->add_line(py_sl);
 }
 
+//--------------------------------------------------------------------------
+// Adds a list of line tuples
+size_t pyscv_add_lines(PyObject *py_this, PyObject *py_lines)
+{
+  DECL_THIS;
+  return _this == NULL ? 0 : _this->add_lines(py_lines);
+}
+
+//--------------------------------------------------------------------------
+bool pyscv_set_line_count(PyObject *py_this, size_t count)
+{
+  DECL_THIS;
+  return _this == NULL ? false : _this->set_line_count(count);
+}
+
 //--------------------------------------------------------------------------
 bool pyscv_insert_line(PyObject *py_this, size_t nline, PyObject *py_sl)
 {
@@ -16,6 +16,8 @@ try:
     _idaapi.pyscv_init = pywraps.pyscv_init
     _idaapi.pyscv_close = pywraps.pyscv_close
     _idaapi.pyscv_add_line = pywraps.pyscv_add_line
+    _idaapi.pyscv_add_lines = pywraps.pyscv_add_lines
+    _idaapi.pyscv_set_line_count = pywraps.pyscv_set_line_count
     _idaapi.pyscv_delete = pywraps.pyscv_delete
     _idaapi.pyscv_refresh = pywraps.pyscv_refresh
     _idaapi.pyscv_show = pywraps.pyscv_show
@@ -43,6 +45,14 @@ except:
 #<pycode(py_custviewer)>
 class simplecustviewer_t(object):
     """The base class for implementing simple custom viewers"""
+
+    LINES_LIST     = 0
+    """Lines are kept in a list of strings (default)"""
+    LINES_COMPACT  = 1
+    """Lines are packed in a single buffer. Suited to large, mostly appended, views"""
+    LINES_PROVIDER = 2
+    """Lines are requested with OnGetLine() when displayed. Use SetLineCount() to set their number"""
+
     def __init__(self):
         self.__this = None
 
@@ -57,16 +67,18 @@ class simplecustviewer_t(object):
     def __make_sl_arg(line, fgcolor=None, bgcolor=None):
         return line if (fgcolor is None and bgcolor is None) else (line, fgcolor, bgcolor)
 
-    def Create(self, title):
+    def Create(self, title, lines=LINES_LIST, cache_size=1024):
         """
         Creates the custom view. This should be the first method called after instantiation
 
         @param title: The title of the view
+        @param lines: How the lines are stored. One of LINES_LIST, LINES_COMPACT or LINES_PROVIDER
+        @param cache_size: With LINES_PROVIDER, the number of lines kept after OnGetLine() returned them
         @return: Boolean whether it succeeds or fails. It may fail if a window with the same title is already open.
                  In this case better close existing windows
         """
         self.title = title
-        self.__this = _idaapi.pyscv_init(self, title)
+        self.__this = _idaapi.pyscv_init(self, title, lines, cache_size)
         return True if self.__this else False
 
     def Close(self):
@@ -116,6 +128,22 @@ class simplecustviewer_t(object):
         """
         return _idaapi.pyscv_add_line(self.__this, self.__make_sl_arg(line, fgcolor, bgcolor))
 
+    def AddLines(self, lines):
+        """
+        Adds several lines to the view at once.
+        @param lines: A list of strings or of tuples (line, fgcolor, bgcolor)
+        @return: The number of lines added. It stops at the first invalid line
+        """
+        return _idaapi.pyscv_add_lines(self.__this, lines)
+
+    def SetLineCount(self, count):
+        """
+        Sets the number of lines of a view created with LINES_PROVIDER.
+        The cached lines are forgotten.
+        @return: Boolean
+        """
+        return _idaapi.pyscv_set_line_count(self.__this, count)
+
     def InsertLine(self, lineno, line, fgcolor=None, bgcolor=None):
         """
         Inserts a line in the given position
@@ -255,6 +283,14 @@ class simplecustviewer_t(object):
 #        """
 #        print "OnPopup"
 #
+#    def OnGetLine(self, lineno):
+#        """
+#        Line requested by a view created with LINES_PROVIDER
+#        @param lineno: The line number (zero based)
+#        @return: A string or a tuple (line, fgcolor, bgcolor)
+#        """
+#        return "line %d" % lineno
+#
 #    def OnHint(self, lineno):
 #        """
 #        Hint requested for the given line number.
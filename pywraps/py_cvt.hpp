@@ -488,6 +488,65 @@ bool PyW_PyListToStrVec(PyObject *py_list, qstrvec_t &strvec)
   return pyvar_walk_list(py_list, pylist_to_strvec_cb, &strvec) != CIP_FAILED;
 }
 
+//---------------------------------------------------------------------------
+char PyW_ArrayTypecode(size_t itemsize)
+{
+  if ( itemsize == sizeof(unsigned char) )
+    return 'B';
+  if ( itemsize == sizeof(unsigned short) )
+    return 'H';
+  if ( itemsize == sizeof(unsigned int) )
+    return 'I';
+  if ( itemsize == sizeof(unsigned long) )
+    return 'L';
+  return '\0';
+}
+
+//---------------------------------------------------------------------------
+// The items are passed to array.array() as one string, so that the
+// array is filled with a single memcpy
+ref_t PyW_CreateArray(char typecode, const void *items, size_t nbytes)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  // (the Try* helpers clear the error: set one for the caller)
+  ref_t py_mod(PyW_TryImportModule("array"));
+  ref_t py_cls;
+  if ( py_mod != NULL )
+    py_cls = PyW_TryGetAttrString(py_mod.o, "array");
+  if ( py_cls == NULL )
+  {
+    PyErr_SetString(PyExc_ImportError, "cannot import array.array");
+    return ref_t();
+  }
+  newref_t py_raw(PyString_FromStringAndSize((const char *)items, Py_ssize_t(nbytes)));
+  if ( py_raw == NULL )
+    return ref_t();
+  newref_t py_arr(PyObject_CallFunction(py_cls.o, "cO", typecode, py_raw.o));
+  return ref_t(py_arr);
+}
+
+//---------------------------------------------------------------------------
+ref_t PyW_EaVecToPyArray(const eavec_t &eavec)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  char typecode = PyW_ArrayTypecode(sizeof(ea_t));
+  if ( typecode != '\0' )
+    return PyW_CreateArray(typecode, eavec.begin(), eavec.size() * sizeof(ea_t));
+
+  size_t c = eavec.size();
+  newref_t py_list(PyList_New(c));
+  if ( py_list == NULL )
+    return ref_t();
+  for ( size_t i=0; i<c; i++ )
+  {
+    PyObject *py_item = Py_BuildValue(PY_FMT64, pyul_t(eavec[i]));
+    if ( py_item == NULL )
+      return ref_t();
+    PyList_SET_ITEM(py_list.o, i, py_item);
+  }
+  return ref_t(py_list);
+}
+
 //-------------------------------------------------------------------------
 // Checks if the given py_var is a special PyIdc_cvt_helper object.
 // It does that by examining the magic attribute and returns its numeric value.
@@ -573,6 +632,302 @@ static error_t idaapi py_idc_opaque_dtor(
   return eOk;
 }
 
+//-------------------------------------------------------------------------
+// Returns the IDC attribute name of the i-th item of a list ("0", "1", ...)
+// The names of the first items are rendered once and then reused.
+#define PY_IDC_CACHED_IDX_NAMES 4096
+static const char *get_idc_idx_name(Py_ssize_t i, char *buf, size_t bufsize)
+{
+  static qstrvec_t names;
+  if ( i < PY_IDC_CACHED_IDX_NAMES )
+  {
+    while ( names.size() <= size_t(i) )
+    {
+      size_t n = names.size();
+      names.push_back().sprnt("%" FMT_Z, n);
+    }
+    return names[i].c_str();
+  }
+  qsnprintf(buf, bufsize, "%" FMT_Z, size_t(i));
+  return buf;
+}
+
+//-------------------------------------------------------------------------
+// Converts a Python list or sequence into an IDC object
+// whose attributes are named after the item indexes
+static int pyvar_seq_to_idcvar(
+        PyObject *py_var,
+        idc_value_t *idc_var,
+        int *gvar_sn)
+{
+  // Create the object
+  VarObject(idc_var);
+
+  // Determine list size and type
+  bool is_seq = !PyList_CheckExact(py_var);
+  Py_ssize_t size = is_seq ? PySequence_Size(py_var) : PyList_GET_SIZE(py_var);
+  char buf[32];
+
+  // Convert each item
+  for ( Py_ssize_t i=0; i<size; i++ )
+  {
+    // Get the item
+    ref_t py_item;
+    if ( is_seq )
+      py_item = newref_t(PySequence_GetItem(py_var, i));
+    else
+      py_item = borref_t(PyList_GET_ITEM(py_var, i));
+
+    // Convert the item into an IDC variable
+    idc_value_t v;
+    if ( pyvar_to_idcvar(py_item, &v, gvar_sn) < CIP_OK )
+      return CIP_FAILED;
+
+    // Store the attribute
+    VarSetAttr(idc_var, get_idc_idx_name(i, buf, sizeof(buf)), &v);
+  }
+  return CIP_OK;
+}
+
+//-------------------------------------------------------------------------
+// Conversion fast paths, selected by the exact type of the Python object
+typedef int (*pyvar_fast_cvt_t)(PyObject *py_var, idc_value_t *idc_var, int *gvar_sn);
+
+static int pyvar_fast_cvt_int(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  idc_var->set_long(PyInt_AS_LONG(py_var));
+  return CIP_OK;
+}
+
+static int pyvar_fast_cvt_long(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  return PyW_GetNumberAsIDC(py_var, idc_var) ? CIP_OK : CIP_FAILED;
+}
+
+static int pyvar_fast_cvt_bool(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  idc_var->set_long(py_var == Py_True ? 1 : 0);
+  return CIP_OK;
+}
+
+static int pyvar_fast_cvt_str(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  idc_var->_set_string(PyString_AS_STRING(py_var), PyString_GET_SIZE(py_var));
+  return CIP_OK;
+}
+
+static int pyvar_fast_cvt_float(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  double dresult = PyFloat_AS_DOUBLE(py_var);
+  ieee_realcvt((void *)&dresult, idc_var->e, 3);
+  idc_var->vtype = VT_FLOAT;
+  return CIP_OK;
+}
+
+static pyvar_fast_cvt_t find_pyvar_fast_cvt(PyTypeObject *type)
+{
+  struct entry_t
+  {
+    PyTypeObject *type;
+    pyvar_fast_cvt_t cvt;
+  };
+  static const entry_t table[] =
+  {
+    { &PyInt_Type,    pyvar_fast_cvt_int },
+    { &PyString_Type, pyvar_fast_cvt_str },
+    { &PyLong_Type,   pyvar_fast_cvt_long },
+    { &PyList_Type,   pyvar_seq_to_idcvar },
+    { &PyFloat_Type,  pyvar_fast_cvt_float },
+    { &PyBool_Type,   pyvar_fast_cvt_bool },
+  };
+  for ( size_t i=0; i < qnumber(table); i++ )
+  {
+    if ( table[i].type == type )
+      return table[i].cvt;
+  }
+  return NULL;
+}
+
+//-------------------------------------------------------------------------
+static bool is_private_attr_name(const char *field_name)
+{
+  size_t len = strlen(field_name);
+  return len > 2
+      && strncmp(field_name, "__", 2) == 0
+      && strncmp(field_name+len-2, "__", 2) == 0;
+}
+
+//-------------------------------------------------------------------------
+// Conversion plans for instances of new-style classes.
+// A plan records the non-private class level attribute names so that dir()
+// is not called and scanned for every converted object. The attributes
+// are converted exactly like in the dir() path (callables included).
+// Python 2 has no dictionary version, so the plan is tied to the type
+// version tag instead: assigning to a class attribute (or to an attribute
+// of a base class) invalidates the tag and the plan gets rebuilt.
+// Instance attributes are always read from the instance __dict__.
+struct pyvar_cvt_plan_t
+{
+  unsigned int version_tag;
+  bool valid;
+  bool empty_dir;     // dir() only lists the instance dictionary keys
+  qvector<ref_t> names;
+};
+typedef std::map<PyTypeObject *, pyvar_cvt_plan_t> pyvar_cvt_plans_t;
+static pyvar_cvt_plans_t pyvar_cvt_plans;
+static ref_t py_dir_attr_name;
+#define PY_IDC_MAX_CVT_PLANS 256
+
+//-------------------------------------------------------------------------
+static void clear_pyvar_cvt_plans()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  pyvar_cvt_plans.clear();
+  py_dir_attr_name = ref_t();
+}
+
+//-------------------------------------------------------------------------
+// Returns the conversion plan of the class of 'py_var', or NULL if the
+// object must be converted by going through dir()
+static const pyvar_cvt_plan_t *get_pyvar_cvt_plan(PyObject *py_var)
+{
+  PyTypeObject *tp = Py_TYPE(py_var);
+
+  // Only plain new-style instances: custom __getattr__/__getattribute__
+  // and classic instances may expose anything
+  if ( !PyType_HasFeature(tp, Py_TPFLAGS_HAVE_VERSION_TAG)
+    || tp->tp_getattro != PyObject_GenericGetAttr )
+  {
+    return NULL;
+  }
+
+  pyvar_cvt_plans_t::iterator p = pyvar_cvt_plans.find(tp);
+  if ( p != pyvar_cvt_plans.end()
+    && p->second.valid
+    && PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG)
+    && p->second.version_tag == tp->tp_version_tag )
+  {
+    return &p->second;
+  }
+
+  // A class with its own __dir__ decides what its attributes are
+  if ( py_dir_attr_name == NULL )
+    py_dir_attr_name = newref_t(PyString_InternFromString("__dir__"));
+  if ( py_dir_attr_name == NULL || _PyType_Lookup(tp, py_dir_attr_name.o) != NULL )
+  {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  newref_t py_dir(PyObject_Dir(py_var));
+  if ( py_dir == NULL || !PyList_Check(py_dir.o) )
+  {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  if ( p == pyvar_cvt_plans.end() )
+  {
+    if ( pyvar_cvt_plans.size() >= PY_IDC_MAX_CVT_PLANS )
+      pyvar_cvt_plans.clear();
+    p = pyvar_cvt_plans.insert(std::make_pair(tp, pyvar_cvt_plan_t())).first;
+  }
+  pyvar_cvt_plan_t &plan = p->second;
+  plan.names.qclear();
+  plan.empty_dir = true;
+
+  Py_ssize_t size = PyList_GET_SIZE(py_dir.o);
+  for ( Py_ssize_t i=0; i<size; i++ )
+  {
+    PyObject *item = PyList_GET_ITEM(py_dir.o, i);
+    if ( !PyString_Check(item) )
+      continue;
+
+    // Names that only exist in the instance dictionary are not recorded
+    if ( _PyType_Lookup(tp, item) == NULL )
+      continue;
+    plan.empty_dir = false;
+
+    if ( !is_private_attr_name(PyString_AS_STRING(item)) )
+      plan.names.push_back(borref_t(item));
+  }
+
+  // Looking up the attributes assigned a version tag to the type
+  plan.valid = PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG);
+  plan.version_tag = tp->tp_version_tag;
+  return &plan;
+}
+
+//-------------------------------------------------------------------------
+// Converts an instance of a new-style class using its class conversion plan
+static int pyvar_obj_to_idcvar(
+        PyObject *py_var,
+        const pyvar_cvt_plan_t &plan,
+        idc_value_t *idc_var,
+        int *gvar_sn)
+{
+  // Nested conversions may rebuild or drop the plan: work on a copy
+  const qvector<ref_t> names(plan.names);
+
+  // Create the IDC object
+  VarObject(idc_var);
+
+  // Instance attributes
+  PyObject **dictptr = _PyObject_GetDictPtr(py_var);
+  PyObject *py_dict = dictptr != NULL && *dictptr != NULL && PyDict_Check(*dictptr) ? *dictptr : NULL;
+  borref_t py_dict_ref(py_dict);
+
+  // Like the dir() path, fail for objects without attributes
+  if ( plan.empty_dir && (py_dict == NULL || PyDict_Size(py_dict) == 0) )
+    return CIP_FAILED;
+
+  if ( py_dict != NULL )
+  {
+    // Take a snapshot: converting the values may run Python code
+    newref_t py_items(PyDict_Items(py_dict));
+    if ( py_items == NULL )
+      return CIP_FAILED;
+
+    Py_ssize_t size = PyList_GET_SIZE(py_items.o);
+    for ( Py_ssize_t i=0; i<size; i++ )
+    {
+      PyObject *py_item = PyList_GET_ITEM(py_items.o, i);
+      PyObject *py_key = PyTuple_GET_ITEM(py_item, 0);
+      if ( !PyString_Check(py_key) )
+        continue;
+
+      const char *field_name = PyString_AS_STRING(py_key);
+      if ( is_private_attr_name(field_name) )
+        continue;
+
+      idc_value_t v;
+      borref_t attr(PyTuple_GET_ITEM(py_item, 1));
+      if ( pyvar_to_idcvar(attr, &v, gvar_sn) < CIP_OK )
+        return CIP_FAILED;
+
+      VarSetAttr(idc_var, field_name, &v);
+    }
+  }
+
+  // Class attributes
+  for ( size_t i=0; i < names.size(); i++ )
+  {
+    const ref_t &py_name = names[i];
+
+    // Already stored from the instance dictionary?
+    if ( py_dict != NULL && PyDict_GetItem(py_dict, py_name.o) != NULL )
+      continue;
+
+    idc_value_t v;
+    newref_t attr(PyObject_GetAttr(py_var, py_name.o));
+    if ( attr == NULL || pyvar_to_idcvar(attr, &v, gvar_sn) < CIP_OK )
+      return CIP_FAILED;
+
+    VarSetAttr(idc_var, PyString_AS_STRING(py_name.o), &v);
+  }
+  return CIP_OK;
+}
+
 //-------------------------------------------------------------------------
 // Converts a Python variable into an IDC variable
 // This function returns on one CIP_XXXX
@@ -583,6 +938,14 @@ int pyvar_to_idcvar(
 {
   PYW_GIL_CHECK_LOCKED_SCOPE();
 
+  // Common exact types
+  if ( py_var != NULL )
+  {
+    pyvar_fast_cvt_t fast_cvt = find_pyvar_fast_cvt(Py_TYPE(py_var.o));
+    if ( fast_cvt != NULL )
+      return fast_cvt(py_var.o, idc_var, gvar_sn);
+  }
+
   // None / NULL
   if ( py_var == NULL || py_var.o == Py_None )
   {
@@ -618,42 +981,7 @@ int pyvar_to_idcvar(
   // Python list?
   else if ( PyList_CheckExact(py_var.o) || PyW_IsSequenceType(py_var.o) )
   {
-    // Create the object
-    VarObject(idc_var);
-
-    // Determine list size and type
-    bool is_seq = !PyList_CheckExact(py_var.o);
-    Py_ssize_t size = is_seq ? PySequence_Size(py_var.o) : PyList_Size(py_var.o);
-    bool ok = true;
-    qstring attr_name;
-
-    // Convert each item
-    for ( Py_ssize_t i=0; i<size; i++ )
-    {
-      // Get the item
-      ref_t py_item;
-      if ( is_seq )
-        py_item = newref_t(PySequence_GetItem(py_var.o, i));
-      else
-        py_item = borref_t(PyList_GetItem(py_var.o, i));
-
-      // Convert the item into an IDC variable
-      idc_value_t v;
-      ok = pyvar_to_idcvar(py_item, &v, gvar_sn) >= CIP_OK;
-      if ( ok )
-      {
-        // Form the attribute name
-        newref_t py_int(PyInt_FromSsize_t(i));
-        ok = PyW_ObjectToString(py_int.o, &attr_name);
-        if ( !ok )
-          break;
-        // Store the attribute
-        VarSetAttr(idc_var, attr_name.c_str(), &v);
-      }
-      if ( !ok )
-        break;
-    }
-    return ok ? CIP_OK : CIP_FAILED;
+    return pyvar_seq_to_idcvar(py_var.o, idc_var, gvar_sn);
   }
   // Dictionary: we convert to an IDC object
   else if ( PyDict_Check(py_var.o) )
@@ -763,6 +1091,11 @@ int pyvar_to_idcvar(
       // Other objects
       //
     default:
+      // A new-style instance with a cached conversion plan?
+      const pyvar_cvt_plan_t *plan = get_pyvar_cvt_plan(py_var.o);
+      if ( plan != NULL )
+        return pyvar_obj_to_idcvar(py_var.o, *plan, idc_var, gvar_sn);
+
       // A normal object?
       newref_t py_dir(PyObject_Dir(py_var.o));
       Py_ssize_t size = PyList_Size(py_dir.o);
@@ -777,15 +1110,9 @@ int pyvar_to_idcvar(
         if ( field_name == NULL )
           continue;
 
-        size_t len = strlen(field_name);
-
         // Skip private attributes
-        if ( (len > 2 )
-          && (strncmp(field_name, "__", 2) == 0 )
-          && (strncmp(field_name+len-2, "__", 2) == 0) )
-        {
+        if ( is_private_attr_name(field_name) )
           continue;
-        }
 
         idc_value_t v;
         // Get the non-private attribute from the object
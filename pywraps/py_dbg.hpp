@@ -37,71 +37,480 @@ static PyObject *meminfo_vec_t_to_py(meminfo_vec_t &areas)
 }
 
 //-------------------------------------------------------------------------
-PyObject *py_appcall(
-  ea_t func_ea,
-  thid_t tid,
-  PyObject *py_type,
-  PyObject *py_fields,
-  PyObject *arg_list)
+// Debugger memory snapshot cache
+//
+// An opt-in, page granular copy of the debuggee memory, read while the
+// process is suspended. Every page is an immutable Python string: the
+// buffers returned by dbg_read_memory_view() keep their pages alive and
+// keep showing the memory of the stop they were read at, even after the
+// cache was invalidated.
+//-------------------------------------------------------------------------
+#define DBGMEM_PAGE_SIZE 0x1000
+#define DBGMEM_MAX_PAGES 4096
+struct dbgmem_cache_t
+{
+  typedef std::map<ea_t, ref_t> pages_t;
+  pages_t pages;
+  thid_t tid;         // the current thread when the pages were read
+  uint64 hits;
+  uint64 misses;
+  uint64 invalidations;
+  bool enabled;
+
+  dbgmem_cache_t() : tid(NO_THREAD), hits(0), misses(0), invalidations(0), enabled(false) {}
+};
+static dbgmem_cache_t dbgmem_cache;
+
+//-------------------------------------------------------------------------
+static void dbgmem_cache_invalidate()
 {
   PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( dbgmem_cache.pages.empty() )
+    return;
+  dbgmem_cache.pages.clear();
+  ++dbgmem_cache.invalidations;
+}
 
-  if ( !PyList_Check(arg_list) )
+//-------------------------------------------------------------------------
+// Forgets the cached pages that overlap [ea, ea+size)
+static void dbgmem_cache_invalidate(ea_t ea, size_t size)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( dbgmem_cache.pages.empty() || size == 0 )
+    return;
+  dbgmem_cache_t::pages_t &pages = dbgmem_cache.pages;
+  ea_t end = ea + size - 1;
+  dbgmem_cache_t::pages_t::iterator p = pages.lower_bound(ea & ~ea_t(DBGMEM_PAGE_SIZE-1));
+  dbgmem_cache_t::pages_t::iterator q = end < ea ? pages.end() : pages.upper_bound(end);
+  if ( p != q )
+  {
+    pages.erase(p, q);
+    ++dbgmem_cache.invalidations;
+  }
+}
+
+//-------------------------------------------------------------------------
+// Every debugger notification means the process ran (or will run, or went
+// away): the snapshot is stale
+static int idaapi dbgmem_cache_cb(void *, int notification_code, va_list)
+{
+  if ( notification_code != dbg_request_error )
+  {
+    PYW_GIL_GET;
+    dbgmem_cache_invalidate();
+  }
+  return 0;
+}
+
+//-------------------------------------------------------------------------
+static bool dbgmem_cache_enable(bool enable)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  bool was_enabled = dbgmem_cache.enabled;
+  if ( enable == was_enabled )
+    return was_enabled;
+  if ( enable )
+    hook_to_notification_point(HT_DBG, dbgmem_cache_cb, NULL);
+  else
+    unhook_from_notification_point(HT_DBG, dbgmem_cache_cb, NULL);
+  dbgmem_cache_invalidate();
+  dbgmem_cache.enabled = enable;
+  return was_enabled;
+}
+
+//-------------------------------------------------------------------------
+void dbgmem_cache_term()
+{
+  dbgmem_cache_enable(false);
+}
+
+//-------------------------------------------------------------------------
+// Can the cache serve reads right now? It only holds memory read while the
+// process is suspended, with the same current thread
+static bool dbgmem_cache_usable()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( !dbgmem_cache.enabled )
+    return false;
+  if ( get_process_state() != DSTATE_SUSP )
+  {
+    dbgmem_cache_invalidate();
+    return false;
+  }
+  thid_t tid = get_current_thread();
+  if ( tid != dbgmem_cache.tid )
+  {
+    dbgmem_cache_invalidate();
+    dbgmem_cache.tid = tid;
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------
+// Returns the (borrowed) page string at 'page_ea', reading it if needed.
+// Returns NULL if the page cannot be read entirely.
+static PyObject *dbgmem_cache_get_page(ea_t page_ea)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  dbgmem_cache_t::pages_t &pages = dbgmem_cache.pages;
+  dbgmem_cache_t::pages_t::iterator p = pages.find(page_ea);
+  if ( p != pages.end() )
+  {
+    ++dbgmem_cache.hits;
+    return p->second.o;
+  }
+  ++dbgmem_cache.misses;
+  newref_t py_page(PyString_FromStringAndSize(NULL, DBGMEM_PAGE_SIZE));
+  if ( py_page == NULL )
+  {
+    PyErr_Clear();
+    return NULL;
+  }
+  char *buf = PyString_AS_STRING(py_page.o);
+  ssize_t got;
+  Py_BEGIN_ALLOW_THREADS;
+  got = read_dbg_memory(page_ea, buf, DBGMEM_PAGE_SIZE);
+  Py_END_ALLOW_THREADS;
+  // The GIL was released: the process may have been resumed meanwhile
+  if ( got != DBGMEM_PAGE_SIZE || !dbgmem_cache_usable() )
     return NULL;
+  if ( pages.size() >= DBGMEM_MAX_PAGES )
+    dbgmem_cache_invalidate();
+  pages[page_ea] = py_page;
+  return py_page.o;
+}
 
-  const char *type   = py_type == Py_None ? NULL : PyString_AS_STRING(py_type);
-  const char *fields = py_fields == Py_None ? NULL : PyString_AS_STRING(py_fields);
+//-------------------------------------------------------------------------
+// Copies [ea, ea+size) out of the cache. Returns false if a page could not
+// be read: the caller should then read the memory directly.
+static bool dbgmem_cache_read(ea_t ea, void *buf, size_t size)
+{
+  uchar *out = (uchar *)buf;
+  while ( size > 0 )
+  {
+    ea_t page_ea = ea & ~ea_t(DBGMEM_PAGE_SIZE-1);
+    size_t off = size_t(ea - page_ea);
+    size_t chunk = qmin(size, size_t(DBGMEM_PAGE_SIZE) - off);
+    PyObject *py_page = dbgmem_cache_get_page(page_ea);
+    if ( py_page == NULL )
+      return false;
+    memcpy(out, PyString_AS_STRING(py_page) + off, chunk);
+    out += chunk;
+    ea += chunk;
+    size -= chunk;
+  }
+  return true;
+}
 
-  // Convert Python arguments into IDC values
-  qvector<idc_value_t> idc_args;
-  int sn = 0;
-  Py_ssize_t nargs = PyList_Size(arg_list);
-  idc_args.resize(nargs);
-  bool ok = true;
-  for ( Py_ssize_t i=0; i<nargs; i++ )
-  {
-    // Get argument
-    borref_t py_item(PyList_GetItem(arg_list, i));
-    if ( (debug & IDA_DEBUG_APPCALL) != 0 )
+//-------------------------------------------------------------------------
+// Reads the debuggee memory through the cache (if it is usable)
+static bool dbgmem_read(ea_t ea, void *buf, size_t size)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( dbgmem_cache_usable() && ea_t(ea + size) >= ea && dbgmem_cache_read(ea, buf, size) )
+    return true;
+  ssize_t got;
+  Py_BEGIN_ALLOW_THREADS;
+  got = read_dbg_memory(ea, buf, size);
+  Py_END_ALLOW_THREADS;
+  return got >= 0 && size_t(got) == size;
+}
+
+//-------------------------------------------------------------------------
+// dbg_read_memory_many() helpers
+//-------------------------------------------------------------------------
+// Ranges that are at most that many bytes apart are read by one call
+#define DBGMEM_COALESCE_GAP  DBGMEM_PAGE_SIZE
+// ...as long as that call does not read more than that
+#define DBGMEM_MAX_BLOCK     0x100000
+struct dbgmem_req_t
+{
+  ea_t ea;
+  size_t size;
+  Py_ssize_t idx;       // position in the caller's sequence
+  size_t off;           // offset of the data in the output buffer
+  bool ok;
+  bool operator<(const dbgmem_req_t &r) const { return ea < r.ea; }
+};
+typedef qvector<dbgmem_req_t> dbgmem_reqvec_t;
+
+struct dbgmem_block_t
+{
+  ea_t ea;
+  size_t size;
+  size_t off;           // offset of the block in the output buffer
+  size_t first, last;   // the (sorted) requests in the block: [first, last)
+};
+typedef qvector<dbgmem_block_t> dbgmem_blockvec_t;
+
+//-------------------------------------------------------------------------
+// Register snapshots
+//-------------------------------------------------------------------------
+// Finds a register by name (or by index). Returns -1 if there is none.
+static int dbg_find_register(PyObject *py_reg)
+{
+  if ( PyString_Check(py_reg) )
+  {
+    const char *name = PyString_AS_STRING(py_reg);
+    for ( int i=0; i < dbg->registers_size; i++ )
     {
-      qstring s;
-      PyW_ObjectToString(py_item.o, &s);
-      msg("obj[%d]->%s\n", int(i), s.c_str());
+      if ( stricmp(name, dbg->registers[i].name) == 0 )
+        return i;
     }
-    // Convert it
-    if ( pyvar_to_idcvar(py_item, &idc_args[i], &sn) < CIP_OK )
+    return -1;
+  }
+  uint64 idx;
+  if ( PyW_GetNumber(py_reg, &idx) && idx < uint64(dbg->registers_size) )
+    return int(idx);
+  return -1;
+}
+
+//-------------------------------------------------------------------------
+static bool dbg_is_float_register(int reg)
+{
+  char dtyp = dbg->registers[reg].dtyp;
+  return dtyp == dt_float || dtyp == dt_double || dtyp == dt_tbyte || dtyp == dt_ldbl;
+}
+
+//-------------------------------------------------------------------------
+// Returns the value of a register as a float, an integer or None
+// (registers wider than 64 bits)
+static PyObject *dbg_regval_to_py(int reg, const regval_t &rv)
+{
+  if ( dbg_is_float_register(reg) )
+  {
+    double x;
+    if ( ph.realcvt(&x, (uint16 *)rv.fval, (sizeof(x)/2-1)|010) != 0 )
+      Py_RETURN_NONE;
+    return PyFloat_FromDouble(x);
+  }
+  if ( get_dtyp_size(dbg->registers[reg].dtyp) > sizeof(rv.ival) )
+    Py_RETURN_NONE;
+  return Py_BuildValue(PY_FMT64, pyul_t(rv.ival));
+}
+
+//-------------------------------------------------------------------------
+static bool dbg_regval_equal(int reg, const regval_t &a, const regval_t &b)
+{
+  if ( dbg_is_float_register(reg) )
+    return memcmp(a.fval, b.fval, sizeof(a.fval)) == 0;
+  return a.ival == b.ival;
+}
+
+//-------------------------------------------------------------------------
+// Reads the registers of a thread with one call to the debugger module.
+// Resolves 'py_names' into 'regs' (and keeps them in 'py_seq') and fills
+// 'values' (indexed like dbg->registers).
+// Returns 1 on success, 0 if the registers cannot be read and -1 (with a
+// Python exception) if the arguments are wrong.
+static int dbg_read_reg_values(
+        PyObject *py_tid,
+        PyObject *py_names,
+        thid_t *tid,
+        ref_t *py_seq,
+        qvector<int> *regs,
+        qvector<regval_t> *values)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  uint64 tid64;
+  if ( !PyW_GetNumber(py_tid, &tid64) )
+  {
+    PyErr_SetString(PyExc_TypeError, "expected a thread id");
+    return -1;
+  }
+  *py_seq = newref_t(PySequence_Fast(py_names, "expected a sequence of register names"));
+  if ( *py_seq == NULL )
+    return -1;
+  if ( dbg == NULL || dbg->read_registers == NULL || get_process_state() != DSTATE_SUSP )
+    return 0;
+
+  // 0 means the current thread
+  *tid = thid_t(tid64);
+  if ( *tid == NO_THREAD )
+    *tid = get_current_thread();
+
+  Py_ssize_t n = PySequence_Fast_GET_SIZE(py_seq->o);
+  regs->resize(n);
+  int clsmask = 0;
+  for ( Py_ssize_t i=0; i < n; i++ )
+  {
+    PyObject *py_reg = PySequence_Fast_GET_ITEM(py_seq->o, i);
+    int reg = dbg_find_register(py_reg);
+    if ( reg < 0 )
     {
-      ok = false;
-      break;
+      ref_t py_repr(newref_t(PyObject_Repr(py_reg)));
+      PyErr_Format(PyExc_ValueError, "unknown register: %s",
+                   py_repr == NULL ? "?" : PyString_AsString(py_repr.o));
+      return -1;
     }
+    (*regs)[i] = reg;
+    clsmask |= dbg->registers[reg].register_class;
   }
 
-  // Set exception message
-  if ( !ok )
+  values->resize(dbg->registers_size);
+  int code;
+  Py_BEGIN_ALLOW_THREADS;
+  code = dbg->read_registers(*tid, clsmask, values->begin());
+  Py_END_ALLOW_THREADS;
+  return code > 0 ? 1 : 0;
+}
+
+//-------------------------------------------------------------------------
+// The registers returned by the last dbg_get_reg_values_delta(), per thread
+struct dbg_reg_snapshot_t
+{
+  qvector<regval_t> values;
+  qvector<uchar> known;
+};
+typedef std::map<thid_t, dbg_reg_snapshot_t> dbg_reg_snapshots_t;
+static dbg_reg_snapshots_t dbg_reg_snapshots;
+static bool dbg_reg_snapshots_hooked = false;
+
+//-------------------------------------------------------------------------
+// Drops the snapshots of the threads that exited, and all of them when a
+// process starts or goes away
+static int idaapi dbg_reg_snapshots_cb(void *, int notification_code, va_list va)
+{
+  switch ( notification_code )
   {
-    PyErr_SetString(
-        PyExc_ValueError,
-        "PyAppCall: Failed to convert Python values to IDC values");
-    return NULL;
+    case dbg_thread_exit:
+      {
+        const debug_event_t *ev = va_arg(va, const debug_event_t *);
+        PYW_GIL_GET;
+        dbg_reg_snapshots.erase(ev->tid);
+      }
+      break;
+    case dbg_process_start:
+    case dbg_process_attach:
+    case dbg_process_exit:
+    case dbg_process_detach:
+      {
+        PYW_GIL_GET;
+        dbg_reg_snapshots.clear();
+      }
+      break;
   }
+  return 0;
+}
 
-  error_t ret;
-  idc_value_t idc_result;
-  Py_BEGIN_ALLOW_THREADS;
+//-------------------------------------------------------------------------
+// Returns the snapshot of a thread, creating it if needed
+static dbg_reg_snapshot_t &dbg_get_reg_snapshot(thid_t tid)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( !dbg_reg_snapshots_hooked )
+    dbg_reg_snapshots_hooked = hook_to_notification_point(HT_DBG, dbg_reg_snapshots_cb, NULL);
+  return dbg_reg_snapshots[tid];
+}
 
-  if ( (debug & IDA_DEBUG_APPCALL) != 0 )
+//-------------------------------------------------------------------------
+void dbg_reg_snapshots_term()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( dbg_reg_snapshots_hooked )
   {
-    msg("input variables:\n"
-        "----------------\n");
+    unhook_from_notification_point(HT_DBG, dbg_reg_snapshots_cb, NULL);
+    dbg_reg_snapshots_hooked = false;
+  }
+  dbg_reg_snapshots.clear();
+}
 
-    qstring s;
+//-------------------------------------------------------------------------
+// The arguments of an Appcall. The slots are reused from call to call
+// by Appcall batches.
+struct appcall_args_t
+{
+  qvector<idc_value_t> idc_args;
+  qvector<uchar> writeback;     // must the argument be converted back?
+
+  // Converts the Python arguments. Sets a Python exception on failure.
+  bool from_py(PyObject **items, Py_ssize_t nargs)
+  {
+    idc_args.resize(nargs);
+    writeback.resize(nargs);
+    int sn = 0;
     for ( Py_ssize_t i=0; i<nargs; i++ )
+    {
+      // Get argument
+      borref_t py_item(items[i]);
+      if ( (debug & IDA_DEBUG_APPCALL) != 0 )
+      {
+        qstring s;
+        PyW_ObjectToString(py_item.o, &s);
+        msg("obj[%d]->%s\n", int(i), s.c_str());
+      }
+      // Convert it
+      if ( pyvar_to_idcvar(py_item, &idc_args[i], &sn) < CIP_OK )
+      {
+        PyErr_SetString(
+            PyExc_ValueError,
+            "PyAppCall: Failed to convert Python values to IDC values");
+        return false;
+      }
+      // Immutable objects cannot receive the values back
+      PyObject *o = py_item.o;
+      writeback[i] = !(o == Py_None
+                    || PyInt_CheckExact(o)
+                    || PyLong_CheckExact(o)
+                    || PyFloat_CheckExact(o)
+                    || PyString_CheckExact(o)
+                    || PyUnicode_CheckExact(o));
+    }
+    return true;
+  }
+
+  // Converts the IDC values back into the mutable Python arguments
+  bool to_py(PyObject **items)
+  {
+    for ( size_t i=0; i<idc_args.size(); i++ )
+    {
+      if ( !writeback[i] )
+        continue;
+      // Get argument
+      borref_t py_item(items[i]);
+      // We convert arguments but fail only on fatal errors
+      // (we ignore failure because of immutable objects)
+      if ( idcvar_to_pyvar(idc_args[i], &py_item) == CIP_FAILED )
+      {
+        PyErr_SetString(PyExc_ValueError, "PyAppCall: Failed while converting IDC values to Python values");
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void print(const char *title) const
+  {
+    msg("%s\n"
+        "----------------\n", title);
+    qstring s;
+    for ( size_t i=0; i<idc_args.size(); i++ )
     {
       VarPrint(&s, &idc_args[i]);
       msg("%d]\n%s\n-----------\n", int(i), s.c_str());
       s.qclear();
     }
   }
+};
+
+//-------------------------------------------------------------------------
+// Runs the Appcall and converts its return value.
+// Returns NULL and sets a Python exception on failure.
+static PyObject *appcall_run(
+  ea_t func_ea,
+  thid_t tid,
+  const char *type,
+  const char *fields,
+  appcall_args_t &args)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+
+  error_t ret;
+  idc_value_t idc_result;
+  Py_BEGIN_ALLOW_THREADS;
+
+  if ( (debug & IDA_DEBUG_APPCALL) != 0 )
+    args.print("input variables:");
 
   // Do Appcall
   ret = appcall(
@@ -109,12 +518,15 @@ PyObject *py_appcall(
     tid,
     (type_t *)type,
     (p_list *)fields,
-    idc_args.size(),
-    idc_args.begin(),
+    args.idc_args.size(),
+    args.idc_args.begin(),
     &idc_result);
 
   Py_END_ALLOW_THREADS;
 
+  // The process ran: the cached memory is stale
+  dbgmem_cache_invalidate();
+
   if ( ret != eOk )
   {
     // An exception was thrown?
@@ -137,31 +549,8 @@ PyObject *py_appcall(
   }
 
   if ( (debug & IDA_DEBUG_APPCALL) != 0 )
-  {
-    msg("return variables:\n"
-        "-----------------\n");
-    qstring s;
-    for ( Py_ssize_t i=0; i<nargs; i++ )
-    {
-      VarPrint(&s, &idc_args[i]);
-      msg("%d]\n%s\n-----------\n", int(i), s.c_str());
-      s.qclear();
-    }
-  }
+    args.print("return variables:");
 
-  // Convert IDC values back to Python values
-  for ( Py_ssize_t i=0; i<nargs; i++ )
-  {
-    // Get argument
-    borref_t py_item(PyList_GetItem(arg_list, i));
-    // We convert arguments but fail only on fatal errors
-    // (we ignore failure because of immutable objects)
-    if ( idcvar_to_pyvar(idc_args[i], &py_item) == CIP_FAILED )
-    {
-      PyErr_SetString(PyExc_ValueError, "PyAppCall: Failed while converting IDC values to Python values");
-      return NULL;
-    }
-  }
   // Convert the result from IDC back to Python
   ref_t py_result;
   if ( idcvar_to_pyvar(idc_result, &py_result) <= CIP_IMMUTABLE )
@@ -181,6 +570,102 @@ PyObject *py_appcall(
   py_result.incref();
   return py_result.o;
 }
+
+//-------------------------------------------------------------------------
+PyObject *py_appcall(
+  ea_t func_ea,
+  thid_t tid,
+  PyObject *py_type,
+  PyObject *py_fields,
+  PyObject *arg_list)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+
+  if ( !PyList_Check(arg_list) )
+    return NULL;
+
+  const char *type   = py_type == Py_None ? NULL : PyString_AS_STRING(py_type);
+  const char *fields = py_fields == Py_None ? NULL : PyString_AS_STRING(py_fields);
+
+  // Convert Python arguments into IDC values
+  PyObject **items = PySequence_Fast_ITEMS(arg_list);
+  appcall_args_t args;
+  if ( !args.from_py(items, PyList_GET_SIZE(arg_list)) )
+    return NULL;
+
+  newref_t py_result(appcall_run(func_ea, tid, type, fields, args));
+  if ( py_result == NULL )
+    return NULL;
+
+  // Convert IDC values back to Python values
+  if ( !args.to_py(items) )
+    return NULL;
+  py_result.incref();
+  return py_result.o;
+}
+
+//-------------------------------------------------------------------------
+PyObject *py_appcall_batch(
+  ea_t func_ea,
+  thid_t tid,
+  PyObject *py_type,
+  PyObject *py_fields,
+  PyObject *py_args_list,
+  bool stop_on_error)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+
+  const char *type   = py_type == Py_None ? NULL : PyString_AS_STRING(py_type);
+  const char *fields = py_fields == Py_None ? NULL : PyString_AS_STRING(py_fields);
+
+  newref_t py_seq(PySequence_Fast(py_args_list, "expected a sequence of argument tuples"));
+  if ( py_seq == NULL )
+    return NULL;
+  Py_ssize_t ncalls = PySequence_Fast_GET_SIZE(py_seq.o);
+  newref_t py_results(PyList_New(ncalls));
+  if ( py_results == NULL )
+    return NULL;
+
+  // The argument slots are shared by all the calls
+  appcall_args_t args;
+  for ( Py_ssize_t i=0; i < ncalls; i++ )
+  {
+    newref_t py_call_args(PySequence_Fast(
+            PySequence_Fast_GET_ITEM(py_seq.o, i),
+            "expected a sequence of argument tuples"));
+    PyObject *py_result = NULL;
+    if ( py_call_args != NULL )
+    {
+      PyObject **items = PySequence_Fast_ITEMS(py_call_args.o);
+      if ( args.from_py(items, PySequence_Fast_GET_SIZE(py_call_args.o)) )
+      {
+        py_result = appcall_run(func_ea, tid, type, fields, args);
+        if ( py_result != NULL && !args.to_py(items) )
+          Py_CLEAR(py_result);
+      }
+    }
+    if ( py_result == NULL )
+    {
+      if ( stop_on_error )
+        return NULL;
+      // Store the exception in place of the result
+      PyObject *py_type_exc, *py_value, *py_tb;
+      PyErr_Fetch(&py_type_exc, &py_value, &py_tb);
+      PyErr_NormalizeException(&py_type_exc, &py_value, &py_tb);
+      Py_XDECREF(py_type_exc);
+      Py_XDECREF(py_tb);
+      if ( py_value == NULL )
+      {
+        Py_INCREF(Py_None);
+        py_value = Py_None;
+      }
+      py_result = py_value;
+    }
+    PyList_SET_ITEM(py_results.o, i, py_result);
+  }
+  py_results.incref();
+  return py_results.o;
+}
 //</code(py_idd)>
 
 //<inline(py_idd)>
@@ -275,6 +760,179 @@ static PyObject *dbg_get_thread_sreg_base(PyObject *py_tid, PyObject *py_sreg_va
   return Py_BuildValue(PY_FMT64, pyul_t(answer));
 }
 
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def dbg_get_reg_values(tid, names, out=None):
+    """
+    Reads many registers of a thread with one call to the debugger module
+    @param tid: thread id (0 means the current thread)
+    @param names: A sequence of register names (or indexes in dbg_get_registers())
+    @param out: None or an array.array with at least len(names) items.
+                The values are stored in it instead of being returned as a tuple.
+                It can have an integer or a floating point typecode.
+                Registers that do not fit in an integer are stored as 0.
+    @return:
+        - A tuple of the values (integers, floats, or None for
+          registers that do not fit in an integer), or 'out'
+        - Or None if the registers cannot be read (the process must be suspended)
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *dbg_get_reg_values(PyObject *py_tid, PyObject *py_names, PyObject *py_out = NULL)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+
+  thid_t tid;
+  ref_t py_seq;
+  qvector<int> regs;
+  qvector<regval_t> values;
+  int code = dbg_read_reg_values(py_tid, py_names, &tid, &py_seq, &regs, &values);
+  if ( code < 0 )
+    return NULL;
+  if ( code == 0 )
+    Py_RETURN_NONE;
+
+  size_t n = regs.size();
+  if ( py_out == NULL || py_out == Py_None )
+  {
+    newref_t py_tuple(PyTuple_New(n));
+    if ( py_tuple == NULL )
+      return NULL;
+    for ( size_t i=0; i < n; i++ )
+    {
+      PyObject *py_val = dbg_regval_to_py(regs[i], values[regs[i]]);
+      if ( py_val == NULL )
+        return NULL;
+      PyTuple_SET_ITEM(py_tuple.o, i, py_val);
+    }
+    py_tuple.incref();
+    return py_tuple.o;
+  }
+
+  // Store the values in the caller's array
+  newref_t py_tc(PyObject_GetAttrString(py_out, "typecode"));
+  Py_ssize_t nitems = PyObject_Size(py_out);
+  pyw_buffer_t buf;
+  if ( py_tc == NULL || !PyString_Check(py_tc.o) || nitems < 0 || !buf.acquire(py_out, true) )
+  {
+    PyErr_Clear();
+    PyErr_SetString(PyExc_TypeError, "'out' must be an array.array");
+    return NULL;
+  }
+  if ( size_t(nitems) < n )
+  {
+    PyErr_Format(PyExc_ValueError, "'out' has %zd items, %zd are needed", nitems, Py_ssize_t(n));
+    return NULL;
+  }
+  char tc = PyString_AS_STRING(py_tc.o)[0];
+  size_t itemsize = nitems == 0 ? 0 : size_t(buf.size / nitems);
+  bool is_float = tc == 'f' || tc == 'd';
+  if ( itemsize != 4 && itemsize != 8 )
+  {
+    PyErr_SetString(PyExc_TypeError, "'out' must have 4 or 8 bytes items");
+    return NULL;
+  }
+  uchar *p = (uchar *)buf.ptr;
+  for ( size_t i=0; i < n; i++, p += itemsize )
+  {
+    int reg = regs[i];
+    const regval_t &rv = values[reg];
+    double x = 0;
+    uint64 v = 0;
+    if ( dbg_is_float_register(reg) )
+    {
+      if ( ph.realcvt(&x, (uint16 *)rv.fval, (sizeof(x)/2-1)|010) != 0 )
+        x = 0;
+      v = uint64(int64(x));
+    }
+    else if ( get_dtyp_size(dbg->registers[reg].dtyp) <= sizeof(rv.ival) )
+    {
+      v = rv.ival;
+      x = double(int64(v));
+    }
+    if ( is_float && itemsize == sizeof(float) )
+      *(float *)p = float(x);
+    else if ( is_float )
+      *(double *)p = x;
+    else if ( itemsize == sizeof(uint32) )
+      *(uint32 *)p = uint32(v);
+    else
+      *(uint64 *)p = v;
+  }
+  Py_INCREF(py_out);
+  return py_out;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def dbg_get_reg_values_delta(tid, names, reset=False):
+    """
+    Reads many registers of a thread with one call to the debugger module,
+    and returns only the ones that changed since the previous call for that thread.
+    Example (a tracer logging the registers changed by each step):
+      names = ("eax", "ebx", "ecx", "edx", "esi", "edi", "ebp", "esp", "eip", "efl")
+      ...
+      changed = dbg_get_reg_values_delta(0, names)
+    @param tid: thread id (0 means the current thread)
+    @param names: A sequence of register names (or indexes in dbg_get_registers())
+    @param reset: Forget the previous snapshot of the thread (all the registers are returned)
+                  The snapshots are also forgotten when their thread exits and
+                  when a process starts or ends.
+    @return:
+        - A dictionary {name: value} of the registers that changed
+          (registers never read before for that thread are reported too)
+        - Or None if the registers cannot be read (the process must be suspended)
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *dbg_get_reg_values_delta(PyObject *py_tid, PyObject *py_names, bool reset = false)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+
+  thid_t tid;
+  ref_t py_seq;
+  qvector<int> regs;
+  qvector<regval_t> values;
+  int code = dbg_read_reg_values(py_tid, py_names, &tid, &py_seq, &regs, &values);
+  if ( code < 0 )
+    return NULL;
+  if ( code == 0 )
+    Py_RETURN_NONE;
+
+  dbg_reg_snapshot_t &snap = dbg_get_reg_snapshot(tid);
+  if ( reset || snap.values.size() != values.size() )
+  {
+    snap.values.resize(values.size());
+    snap.known.clear();
+    snap.known.resize(values.size(), 0);
+  }
+
+  newref_t py_dict(PyDict_New());
+  if ( py_dict == NULL )
+    return NULL;
+  for ( size_t i=0; i < regs.size(); i++ )
+  {
+    int reg = regs[i];
+    const regval_t &rv = values[reg];
+    if ( snap.known[reg] && dbg_regval_equal(reg, snap.values[reg], rv) )
+      continue;
+    snap.values[reg] = rv;
+    snap.known[reg] = 1;
+    newref_t py_val(dbg_regval_to_py(reg, rv));
+    if ( py_val == NULL
+      || PyDict_SetItem(py_dict.o, PySequence_Fast_GET_ITEM(py_seq.o, i), py_val.o) != 0 )
+    {
+      return NULL;
+    }
+  }
+  py_dict.incref();
+  return py_dict.o;
+}
+
 //-------------------------------------------------------------------------
 /*
 #<pydoc>
@@ -284,6 +942,8 @@ def dbg_read_memory(ea, sz):
     @return:
         - The read buffer (as a string)
         - Or None on failure
+    @note: The memory is read through the snapshot cache if it is enabled.
+           See dbg_enable_memory_cache()
     """
     pass
 #</pydoc>
@@ -301,12 +961,8 @@ static PyObject *dbg_read_memory(PyObject *py_ea, PyObject *py_sz)
   if ( ret == NULL )
     Py_RETURN_NONE;
 
-  // Get the internal buffer
-  Py_ssize_t len;
-  char *buf;
-  PyString_AsStringAndSize(ret, &buf, &len);
-
-  if ( (size_t)read_dbg_memory(ea_t(ea), buf, size_t(sz)) != sz )
+  // Read straight into its buffer
+  if ( !dbgmem_read(ea_t(ea), PyString_AS_STRING(ret), size_t(sz)) )
   {
     // Release the string on failure
     Py_DECREF(ret);
@@ -316,12 +972,203 @@ static PyObject *dbg_read_memory(PyObject *py_ea, PyObject *py_sz)
   return ret;
 }
 
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def dbg_read_memory_view(ea, sz):
+    """
+    Reads from the debugee's memory at the specified ea, without copying
+    the memory out of the snapshot cache when the range fits in one page.
+    The returned buffer keeps showing the memory of the current stop, even
+    after the process is resumed.
+    @return:
+        - A read-only buffer object
+        - Or None on failure
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *dbg_read_memory_view(PyObject *py_ea, PyObject *py_sz)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+
+  uint64 ea, sz;
+  if ( !dbg_can_query() || !PyW_GetNumber(py_ea, &ea) || !PyW_GetNumber(py_sz, &sz) )
+    Py_RETURN_NONE;
+
+  // Within one page: a view over the cached page
+  ea_t page_ea = ea_t(ea) & ~ea_t(DBGMEM_PAGE_SIZE-1);
+  size_t off = size_t(ea_t(ea) - page_ea);
+  if ( sz <= DBGMEM_PAGE_SIZE - off && dbgmem_cache_usable() )
+  {
+    PyObject *py_page = dbgmem_cache_get_page(page_ea);
+    if ( py_page != NULL )
+      return PyBuffer_FromObject(py_page, Py_ssize_t(off), Py_ssize_t(sz));
+  }
+
+  // Otherwise: a view over a private copy
+  newref_t py_str(dbg_read_memory(py_ea, py_sz));
+  if ( py_str == NULL || py_str.o == Py_None )
+    Py_RETURN_NONE;
+  return PyBuffer_FromObject(py_str.o, 0, Py_END_OF_BUFFER);
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def dbg_read_memory_many(ranges):
+    """
+    Reads many ranges of the debugee's memory at once.
+    The ranges are sorted and the close ones are merged, so that the
+    debugger module is called as few times as possible.
+    @param ranges: A sequence of (ea, size) tuples
+    @return:
+        - A list with, for each range, the read buffer (as a string) or None
+        - Or None if the debugger cannot be queried
+    @note: This function always reads the live memory (not the snapshot cache)
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *dbg_read_memory_many(PyObject *py_ranges)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+
+  if ( !dbg_can_query() )
+    Py_RETURN_NONE;
+
+  newref_t py_seq(PySequence_Fast(py_ranges, "expected a sequence of (ea, size) tuples"));
+  if ( py_seq == NULL )
+    return NULL;
+
+  // Collect the requests
+  Py_ssize_t n = PySequence_Fast_GET_SIZE(py_seq.o);
+  dbgmem_reqvec_t reqs;
+  reqs.resize(n);
+  for ( Py_ssize_t i=0; i < n; i++ )
+  {
+    PyObject *item = PySequence_Fast_GET_ITEM(py_seq.o, i);
+    uint64 ea, sz;
+    if ( !PyTuple_Check(item)
+      || PyTuple_GET_SIZE(item) != 2
+      || !PyW_GetNumber(PyTuple_GET_ITEM(item, 0), &ea)
+      || !PyW_GetNumber(PyTuple_GET_ITEM(item, 1), &sz) )
+    {
+      PyErr_Format(PyExc_TypeError, "item %zd is not an (ea, size) tuple", i);
+      return NULL;
+    }
+    dbgmem_req_t &r = reqs[i];
+    r.ea = ea_t(ea);
+    r.size = size_t(sz);
+    r.idx = i;
+    // Reject sizes that would wrap around the address space
+    r.ok = ea_t(r.ea + r.size) >= r.ea;
+  }
+  std::sort(reqs.begin(), reqs.end());
+
+  // Merge the requests into blocks
+  dbgmem_blockvec_t blocks;
+  size_t total = 0;
+  for ( size_t i=0; i < reqs.size(); i++ )
+  {
+    dbgmem_req_t &r = reqs[i];
+    if ( !r.ok || r.size == 0 )
+      continue;
+    if ( !blocks.empty() )
+    {
+      dbgmem_block_t &b = blocks.back();
+      ea_t bend = b.ea + b.size;
+      ea_t rend = r.ea + r.size;
+      ea_t nend = qmax(bend, rend);
+      if ( r.ea <= bend + DBGMEM_COALESCE_GAP && bend + DBGMEM_COALESCE_GAP >= bend
+        && nend - b.ea <= DBGMEM_MAX_BLOCK )
+      {
+        total += size_t(nend - bend);
+        b.size = size_t(nend - b.ea);
+        b.last = i + 1;
+        r.off = b.off + size_t(r.ea - b.ea);
+        continue;
+      }
+    }
+    dbgmem_block_t &b = blocks.push_back();
+    b.ea = r.ea;
+    b.size = r.size;
+    b.off = total;
+    b.first = i;
+    b.last = i + 1;
+    r.off = total;
+    total += r.size;
+  }
+
+  bytevec_t data;
+  data.resize(total);
+
+  // Read the blocks, without the GIL
+  Py_BEGIN_ALLOW_THREADS;
+  for ( size_t i=0; i < blocks.size(); i++ )
+  {
+    const dbgmem_block_t &b = blocks[i];
+    ea_t ea = b.ea;
+    ea_t end = b.ea + b.size;
+    size_t j = b.first;
+    while ( true )
+    {
+      ssize_t got = read_dbg_memory(ea, &data[b.off + size_t(ea - b.ea)], size_t(end - ea));
+      ea_t bad = ea + (got < 0 ? 0 : got);
+      if ( bad >= end )
+        break;
+      // The read stopped at unreadable memory: keep the requests that were
+      // read, retry the ones that cross 'bad' on their own, and read the
+      // requests after it as a new block
+      for ( ; j < b.last && reqs[j].ea <= bad; j++ )
+      {
+        dbgmem_req_t &r = reqs[j];
+        if ( !r.ok || r.size == 0 || r.ea + r.size <= bad )
+          continue;
+        // (no need to retry if the read started at the request itself)
+        r.ok = r.ea != ea && (size_t)read_dbg_memory(r.ea, &data[r.off], r.size) == r.size;
+      }
+      if ( j == b.last )
+        break;
+      ea = reqs[j].ea;
+    }
+  }
+  Py_END_ALLOW_THREADS;
+
+  // Build the result list, in the caller's order
+  newref_t py_list(PyList_New(n));
+  if ( py_list == NULL )
+    return NULL;
+  for ( size_t i=0; i < reqs.size(); i++ )
+  {
+    const dbgmem_req_t &r = reqs[i];
+    PyObject *py_item;
+    if ( !r.ok )
+    {
+      Py_INCREF(Py_None);
+      py_item = Py_None;
+    }
+    else
+    {
+      py_item = PyString_FromStringAndSize(
+              r.size == 0 ? NULL : (const char *)&data[r.off],
+              Py_ssize_t(r.size));
+      if ( py_item == NULL )
+        return NULL;
+    }
+    PyList_SET_ITEM(py_list.o, r.idx, py_item);
+  }
+  py_list.incref();
+  return py_list.o;
+}
+
 //-------------------------------------------------------------------------
 /*
 #<pydoc>
 def dbg_write_memory(ea, buffer):
     """
     Writes a buffer to the debugee's memory
+    @param buffer: A string or any object supporting the buffer protocol
     @return: Boolean
     """
     pass
@@ -332,16 +1179,99 @@ static PyObject *dbg_write_memory(PyObject *py_ea, PyObject *py_buf)
   PYW_GIL_CHECK_LOCKED_SCOPE();
 
   uint64 ea;
-  if ( !dbg_can_query() || !PyString_Check(py_buf) || !PyW_GetNumber(py_ea, &ea) )
+  if ( !dbg_can_query() || !PyW_GetNumber(py_ea, &ea) )
     Py_RETURN_NONE;
 
-  size_t sz = PyString_GET_SIZE(py_buf);
-  void *buf = (void *)PyString_AS_STRING(py_buf);
-  if ( write_dbg_memory(ea_t(ea), buf, sz) != sz )
+  // Pin the buffer: it must neither move nor go away while the GIL is released
+  pyw_buffer_t buf;
+  if ( !buf.acquire(py_buf, false) )
+  {
+    PyErr_Clear();
+    Py_RETURN_NONE;
+  }
+  size_t sz = size_t(buf.size);
+  ssize_t written;
+  if ( buf.locked )
+  {
+    Py_BEGIN_ALLOW_THREADS;
+    written = write_dbg_memory(ea_t(ea), buf.ptr, sz);
+    Py_END_ALLOW_THREADS;
+  }
+  else
+  {
+    // (an old style buffer could be resized by another thread)
+    written = write_dbg_memory(ea_t(ea), buf.ptr, sz);
+  }
+  // (after the write: other threads may have read the pages meanwhile)
+  dbgmem_cache_invalidate(ea_t(ea), sz);
+  if ( written < 0 || size_t(written) != sz )
     Py_RETURN_FALSE;
   Py_RETURN_TRUE;
 }
 
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def dbg_enable_memory_cache(enable):
+    """
+    Enables or disables the debugger memory snapshot cache.
+    While the process is suspended, dbg_read_memory() and dbg_read_memory_view()
+    keep the pages they read, so that reading them again does not call the
+    debugger module. The cache is emptied when the process is resumed or
+    stepped, when the current thread changes, and dbg_write_memory()
+    forgets the pages it writes to.
+    @param enable: Boolean
+    @return: Boolean, whether the cache was enabled
+    """
+    pass
+#</pydoc>
+*/
+static bool dbg_enable_memory_cache(bool enable)
+{
+  return dbgmem_cache_enable(enable);
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def dbg_invalidate_memory_cache():
+    """
+    Empties the debugger memory snapshot cache.
+    Call it after modifying the debuggee memory by other means than dbg_write_memory().
+    @return: Nothing
+    """
+    pass
+#</pydoc>
+*/
+static void dbg_invalidate_memory_cache()
+{
+  dbgmem_cache_invalidate();
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def dbg_get_memory_cache_stats():
+    """
+    Returns the debugger memory snapshot cache counters.
+    @return: A dictionary with the 'enabled', 'pages', 'page_size',
+             'hits', 'misses' and 'invalidations' keys
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *dbg_get_memory_cache_stats()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  return Py_BuildValue("{s:N,s:n,s:i,s:K,s:K,s:K}",
+    "enabled", PyBool_FromLong(dbgmem_cache.enabled),
+    "pages", Py_ssize_t(dbgmem_cache.pages.size()),
+    "page_size", DBGMEM_PAGE_SIZE,
+    "hits", (unsigned PY_LONG_LONG)dbgmem_cache.hits,
+    "misses", (unsigned PY_LONG_LONG)dbgmem_cache.misses,
+    "invalidations", (unsigned PY_LONG_LONG)dbgmem_cache.invalidations);
+}
+
 //-------------------------------------------------------------------------
 /*
 #<pydoc>
@@ -391,6 +1321,7 @@ static PyObject *dbg_get_memory_info()
 
   get_dbg_memory_info(&areas);
   Py_END_ALLOW_THREADS;
+  dbgmem_cache_invalidate();
   return meminfo_vec_t_to_py(areas);
 }
 
@@ -417,10 +1348,18 @@ PyObject *py_appcall(
   PyObject *py_type,
   PyObject *py_fields,
   PyObject *arg_list);
+PyObject *py_appcall_batch(
+  ea_t func_ea,
+  thid_t tid,
+  PyObject *py_type,
+  PyObject *py_fields,
+  PyObject *py_args_list,
+  bool stop_on_error);
 //</inline(py_idd)>
 
 //<code(py_dbg)>
 static PyObject *meminfo_vec_t_to_py(meminfo_vec_t &areas);
+static void dbgmem_cache_invalidate();
 //</code(py_dbg)>
 
 //<inline(py_dbg)>
@@ -483,6 +1422,7 @@ static PyObject *refresh_debugger_memory()
   isEnabled(0);
 
   PYW_GIL_CHECK_LOCKED_SCOPE();
+  dbgmem_cache_invalidate();
   Py_RETURN_NONE;
 }
 
@@ -556,7 +1496,7 @@ public:
 int idaapi DBG_Callback(void *ud, int notification_code, va_list va)
 {
   // This hook gets called from the kernel. Ensure we hold the GIL.
-  PYW_GIL_GET;
+  PYW_GIL_GET_HOOK(PYW_HOOK_DBG, notification_code);
 
   class DBG_Hooks *proxy = (class DBG_Hooks *)ud;
   debug_event_t *event;
@@ -17,6 +17,444 @@ int idaapi py_enumerate_files_cb(const char *file, void *ud)
                   NULL));
   return (py_ret == NULL || !PyNumber_Check(py_ret.o)) ? 1 /* stop enum on failure */ : PyInt_AsLong(py_ret.o);
 }
+
+//------------------------------------------------------------------------
+// linput_view: read-only view over a whole input, see loader_input_t.mmap().
+// Local files are memory mapped (on POSIX systems). The other inputs
+// are read in chunks, when the bytes are first accessed, as long as the
+// loader_input_t that created the view keeps the input open.
+// Inputs borrowed from IDA (loader_input_t.from_linput()) can be closed
+// behind our back: when they can't be mapped, they are read at once.
+//------------------------------------------------------------------------
+#ifndef __NT__
+#include <sys/mman.h>
+#endif
+
+#define LV_CHUNK_SHIFT 16
+#define LV_CHUNK_SIZE  (1 << LV_CHUNK_SHIFT)
+
+struct py_linput_view_t
+{
+  PyObject_HEAD
+  py_linput_view_t *owner; // view owning the data (NULL for the owner itself)
+  uchar *data;             // first byte of this view
+  Py_ssize_t size;         // number of bytes in this view
+  // Only valid in the owner:
+  linput_t *li;            // NULL once the input is closed
+  const void *source;      // loader_input_t that created the view
+  bool mapped;             // data is a file mapping
+  qvector<uchar> *loaded;  // one "read" flag per chunk (NULL if mapped)
+};
+
+// Views reading from an input, so they can be detached when it is closed
+static qvector<py_linput_view_t *> lv_owners;
+
+//------------------------------------------------------------------------
+// Called before a loader_input_t closes its input: the views it created
+// can't read anymore
+static void linput_views_detach(const void *source)
+{
+  for ( size_t i=0; i < lv_owners.size(); i++ )
+  {
+    if ( lv_owners[i]->source == source )
+      lv_owners[i]->li = NULL;
+  }
+}
+
+//------------------------------------------------------------------------
+// Maps a local input file. Returns NULL if the input can't be mapped
+// (always on Windows: the views then read the input in chunks)
+static uchar *lv_map(linput_t *li, size_t size)
+{
+#ifdef __NT__
+  qnotused(li);
+  qnotused(size);
+  return NULL;
+#else
+  FILE *fp = qlfile(li);
+  if ( fp == NULL || size == 0 )
+    return NULL;
+  void *p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+  return p == MAP_FAILED ? NULL : (uchar *)p;
+#endif
+}
+
+//------------------------------------------------------------------------
+// Makes sure that bytes [off, off+len) of the view are read.
+// Returns false and sets a Python exception on failure
+static bool lv_fetch(py_linput_view_t *self, Py_ssize_t off, Py_ssize_t len)
+{
+  py_linput_view_t *o = self->owner == NULL ? self : self->owner;
+  if ( len <= 0 || o->loaded == NULL )
+    return true;
+  off += self->data - o->data;
+  size_t c = size_t(off) >> LV_CHUNK_SHIFT;
+  size_t c_end = (size_t(off + len - 1) >> LV_CHUNK_SHIFT) + 1;
+  qvector<uchar> &loaded = *o->loaded;
+  while ( c < c_end )
+  {
+    if ( loaded[c] )
+    {
+      ++c;
+      continue;
+    }
+    if ( o->li == NULL )
+    {
+      PyErr_SetString(PyExc_ValueError, "the input of the view was closed");
+      return false;
+    }
+    // Read the whole run of missing chunks at once, without
+    // disturbing the current position of the input
+    size_t c2 = c + 1;
+    while ( c2 < c_end && !loaded[c2] )
+      ++c2;
+    size_t start = c << LV_CHUNK_SHIFT;
+    size_t end = qmin(c2 << LV_CHUNK_SHIFT, size_t(o->size));
+    // The GIL is kept: the input is shared with the other Python
+    // threads, which could move its position between our calls
+    int32 pos = qltell(o->li);
+    qlseek(o->li, int32(start));
+    ssize_t r = qlread(o->li, o->data + start, end - start);
+    qlseek(o->li, pos);
+    if ( r != ssize_t(end - start) )
+    {
+      PyErr_SetString(PyExc_IOError, "read error");
+      return false;
+    }
+    for ( ; c < c2; c++ )
+      loaded[c] = 1;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+static PyObject *lv_new_slice(py_linput_view_t *self, Py_ssize_t start, Py_ssize_t len);
+
+//------------------------------------------------------------------------
+static void lv_dealloc(PyObject *self)
+{
+  py_linput_view_t *lv = (py_linput_view_t *)self;
+  if ( lv->owner != NULL )
+  {
+    Py_DECREF((PyObject *)lv->owner);
+  }
+  else
+  {
+    lv_owners.del(lv);
+#ifndef __NT__
+    if ( lv->mapped )
+      munmap(lv->data, lv->size);
+    else
+#endif
+      qfree(lv->data);
+    delete lv->loaded;
+  }
+  Py_TYPE(self)->tp_free(self);
+}
+
+//------------------------------------------------------------------------
+static PyObject *lv_repr(PyObject *self)
+{
+  py_linput_view_t *lv = (py_linput_view_t *)self;
+  py_linput_view_t *o = lv->owner == NULL ? lv : lv->owner;
+  char buf[MAXSTR];
+  qsnprintf(buf, sizeof(buf), "<linput_view offset=%" FMT_Z " size=%" FMT_Z "%s>",
+            size_t(lv->data - o->data), size_t(lv->size), o->mapped ? " mapped" : "");
+  return PyString_FromString(buf);
+}
+
+//------------------------------------------------------------------------
+static PyObject *lv_tobytes(PyObject *self, PyObject * /*args*/)
+{
+  py_linput_view_t *lv = (py_linput_view_t *)self;
+  if ( !lv_fetch(lv, 0, lv->size) )
+    return NULL;
+  return PyString_FromStringAndSize((const char *)lv->data, lv->size);
+}
+
+//------------------------------------------------------------------------
+// Only the bytes needed by the format are read
+static PyObject *lv_unpack_from(PyObject *self, PyObject *args)
+{
+  py_linput_view_t *lv = (py_linput_view_t *)self;
+  PyObject *py_fmt;
+  Py_ssize_t offset = 0;
+  if ( !PyArg_ParseTuple(args, "O|n:unpack_from", &py_fmt, &offset) )
+    return NULL;
+  ref_t py_struct(PyW_TryImportModule("struct"));
+  if ( py_struct == NULL )
+  {
+    PyErr_SetString(PyExc_ImportError, "cannot import struct");
+    return NULL;
+  }
+  newref_t py_size(PyObject_CallMethod(py_struct.o, (char *)"calcsize", (char *)"O", py_fmt));
+  if ( py_size == NULL )
+    return NULL;
+  Py_ssize_t n = PyInt_AsSsize_t(py_size.o);
+  if ( offset < 0 )
+    offset += lv->size;
+  if ( offset < 0 || n > lv->size - offset )
+  {
+    PyErr_Format(PyExc_ValueError, "unpack_from requires %zd bytes at offset %zd", n, offset);
+    return NULL;
+  }
+  newref_t py_slice(lv_new_slice(lv, offset, n));
+  if ( py_slice == NULL )
+    return NULL;
+  return PyObject_CallMethod(py_struct.o, (char *)"unpack_from", (char *)"OO", py_fmt, py_slice.o);
+}
+
+//------------------------------------------------------------------------
+static PyObject *lv_get_mapped(PyObject *self, void * /*closure*/)
+{
+  py_linput_view_t *lv = (py_linput_view_t *)self;
+  return PyBool_FromLong((lv->owner == NULL ? lv : lv->owner)->mapped);
+}
+
+//------------------------------------------------------------------------
+static Py_ssize_t lv_length(PyObject *self)
+{
+  return ((py_linput_view_t *)self)->size;
+}
+
+//------------------------------------------------------------------------
+static PyObject *lv_subscript(PyObject *self, PyObject *item)
+{
+  py_linput_view_t *lv = (py_linput_view_t *)self;
+  if ( PyIndex_Check(item) )
+  {
+    Py_ssize_t i = PyNumber_AsSsize_t(item, PyExc_IndexError);
+    if ( i == -1 && PyErr_Occurred() )
+      return NULL;
+    if ( i < 0 )
+      i += lv->size;
+    if ( i < 0 || i >= lv->size )
+    {
+      PyErr_SetString(PyExc_IndexError, "linput_view index out of range");
+      return NULL;
+    }
+    if ( !lv_fetch(lv, i, 1) )
+      return NULL;
+    return PyString_FromStringAndSize((const char *)lv->data + i, 1);
+  }
+  if ( PySlice_Check(item) )
+  {
+    Py_ssize_t start, stop, step, len;
+    if ( PySlice_GetIndicesEx((PySliceObject *)item, lv->size, &start, &stop, &step, &len) < 0 )
+      return NULL;
+    if ( step == 1 )
+      return lv_new_slice(lv, start, len);
+
+    // Strided slices cannot be views: copy them
+    PyObject *py_str = PyString_FromStringAndSize(NULL, len);
+    if ( py_str == NULL )
+      return NULL;
+    char *p = PyString_AS_STRING(py_str);
+    for ( Py_ssize_t i=0; i < len; i++, start += step )
+    {
+      if ( !lv_fetch(lv, start, 1) )
+      {
+        Py_DECREF(py_str);
+        return NULL;
+      }
+      p[i] = lv->data[start];
+    }
+    return py_str;
+  }
+  PyErr_SetString(PyExc_TypeError, "linput_view indices must be integers or slices");
+  return NULL;
+}
+
+//------------------------------------------------------------------------
+// New-style buffer protocol (memoryview, struct.unpack_from, ...)
+static int lv_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+  py_linput_view_t *lv = (py_linput_view_t *)self;
+  if ( !lv_fetch(lv, 0, lv->size) )
+    return -1;
+  return PyBuffer_FillInfo(view, self, lv->data, lv->size, 1, flags);
+}
+
+//------------------------------------------------------------------------
+// Old-style buffer protocol
+static Py_ssize_t lv_getreadbuf(PyObject *self, Py_ssize_t segment, void **ptr)
+{
+  if ( segment != 0 )
+  {
+    PyErr_SetString(PyExc_SystemError, "accessing non-existent linput_view segment");
+    return -1;
+  }
+  py_linput_view_t *lv = (py_linput_view_t *)self;
+  if ( !lv_fetch(lv, 0, lv->size) )
+    return -1;
+  *ptr = lv->data;
+  return lv->size;
+}
+
+static Py_ssize_t lv_getsegcount(PyObject *self, Py_ssize_t *lenp)
+{
+  if ( lenp != NULL )
+    *lenp = ((py_linput_view_t *)self)->size;
+  return 1;
+}
+
+static Py_ssize_t lv_getcharbuf(PyObject *self, Py_ssize_t segment, char **ptr)
+{
+  return lv_getreadbuf(self, segment, (void **)ptr);
+}
+
+//------------------------------------------------------------------------
+static PySequenceMethods lv_as_sequence =
+{
+  lv_length,              // sq_length
+};
+
+static PyMappingMethods lv_as_mapping =
+{
+  lv_length,              // mp_length
+  lv_subscript,           // mp_subscript
+  NULL,                   // mp_ass_subscript
+};
+
+static PyBufferProcs lv_as_buffer =
+{
+  lv_getreadbuf,          // bf_getreadbuffer
+  NULL,                   // bf_getwritebuffer
+  lv_getsegcount,         // bf_getsegcount
+  lv_getcharbuf,          // bf_getcharbuffer
+  lv_getbuffer,           // bf_getbuffer
+  NULL,                   // bf_releasebuffer
+};
+
+static PyMethodDef lv_methods[] =
+{
+  { "tobytes", lv_tobytes, METH_NOARGS, "Returns a copy of the bytes as a string" },
+  { "unpack_from", lv_unpack_from, METH_VARARGS, "unpack_from(fmt, offset=0): struct.unpack_from() that only reads the needed bytes" },
+  { NULL, NULL, 0, NULL }
+};
+
+static PyGetSetDef lv_getset[] =
+{
+  { (char *)"mapped", lv_get_mapped, NULL, (char *)"True if the input file is memory mapped", NULL },
+  { NULL, NULL, NULL, NULL, NULL }
+};
+
+static PyTypeObject linput_view_type =
+{
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "idaapi.linput_view",                   // tp_name
+  sizeof(py_linput_view_t),               // tp_basicsize
+  0,                                      // tp_itemsize
+  lv_dealloc,                             // tp_dealloc
+  NULL,                                   // tp_print
+  NULL,                                   // tp_getattr
+  NULL,                                   // tp_setattr
+  NULL,                                   // tp_compare
+  lv_repr,                                // tp_repr
+  NULL,                                   // tp_as_number
+  &lv_as_sequence,                        // tp_as_sequence
+  &lv_as_mapping,                         // tp_as_mapping
+  NULL,                                   // tp_hash
+  NULL,                                   // tp_call
+  NULL,                                   // tp_str
+  NULL,                                   // tp_getattro
+  NULL,                                   // tp_setattro
+  &lv_as_buffer,                          // tp_as_buffer
+  Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER, // tp_flags
+  "Read-only view over an input file",    // tp_doc
+  NULL,                                   // tp_traverse
+  NULL,                                   // tp_clear
+  NULL,                                   // tp_richcompare
+  0,                                      // tp_weaklistoffset
+  NULL,                                   // tp_iter
+  NULL,                                   // tp_iternext
+  lv_methods,                             // tp_methods
+  NULL,                                   // tp_members
+  lv_getset,                              // tp_getset
+};
+
+//------------------------------------------------------------------------
+static py_linput_view_t *lv_alloc()
+{
+  if ( (linput_view_type.tp_flags & Py_TPFLAGS_READY) == 0
+    && PyType_Ready(&linput_view_type) < 0 )
+  {
+    return NULL;
+  }
+  return PyObject_New(py_linput_view_t, &linput_view_type);
+}
+
+//------------------------------------------------------------------------
+static PyObject *lv_new_slice(py_linput_view_t *self, Py_ssize_t start, Py_ssize_t len)
+{
+  py_linput_view_t *owner = self->owner == NULL ? self : self->owner;
+  py_linput_view_t *lv = lv_alloc();
+  if ( lv == NULL )
+    return NULL;
+  Py_INCREF((PyObject *)owner);
+  lv->owner = owner;
+  lv->data = self->data + start;
+  lv->size = len;
+  lv->li = NULL;
+  lv->source = NULL;
+  lv->mapped = false;
+  lv->loaded = NULL;
+  return (PyObject *)lv;
+}
+
+//------------------------------------------------------------------------
+// 'source' is the loader_input_t reading from 'li'. A borrowed input
+// is mapped or read at once: the view never reads from it later on.
+static PyObject *linput_view_create(linput_t *li, const void *source, bool borrowed)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  int32 size;
+  Py_BEGIN_ALLOW_THREADS;
+  size = qlsize(li);
+  Py_END_ALLOW_THREADS;
+  if ( size < 0 )
+  {
+    PyErr_SetString(PyExc_IOError, "unknown input size");
+    return NULL;
+  }
+
+  py_linput_view_t *lv = lv_alloc();
+  if ( lv == NULL )
+    return NULL;
+  lv->owner = NULL;
+  lv->size = size;
+  lv->li = li;
+  lv->source = source;
+  lv->loaded = NULL;
+  lv->data = lv_map(li, size);
+  lv->mapped = lv->data != NULL;
+  if ( !lv->mapped )
+  {
+    lv->data = (uchar *)qalloc(qmax(size_t(size), size_t(1)));
+    if ( lv->data == NULL )
+    {
+      Py_DECREF((PyObject *)lv);
+      return PyErr_NoMemory();
+    }
+    lv->loaded = new qvector<uchar>();
+    lv->loaded->resize((size_t(size) + LV_CHUNK_SIZE - 1) >> LV_CHUNK_SHIFT, 0);
+    if ( borrowed )
+    {
+      if ( !lv_fetch(lv, 0, lv->size) )
+      {
+        Py_DECREF((PyObject *)lv);
+        return NULL;
+      }
+      delete lv->loaded;
+      lv->loaded = NULL;
+    }
+  }
+  if ( borrowed )
+    lv->li = NULL;
+  else
+    lv_owners.push_back(lv);
+  return (PyObject *)lv;
+}
 //</code(py_diskio)>
 
 //<inline(py_diskio)>
@@ -12,7 +12,7 @@ protected:
   {
     if ( ni == NULL )
     {
-      node_cache.erase(n);
+      node_cache.invalidate(n);
     }
     else
     {
@@ -44,26 +44,65 @@ private:
   {
     qstring text;
     bgcolor_t bgcolor;
-    nodetext_cache_t(const nodetext_cache_t &rhs): text(rhs.text), bgcolor(rhs.bgcolor) { }
-    nodetext_cache_t(const char *t, bgcolor_t c): text(t), bgcolor(c) { }
-    nodetext_cache_t() { }
+    bool cached;
+    nodetext_cache_t(): bgcolor(DEFCOLOR), cached(false) { }
   };
 
-  class nodetext_cache_map_t: public std::map<int, nodetext_cache_t>
+  // Node texts, indexed by node id
+  class nodetext_cache_vec_t: public qvector<nodetext_cache_t>
   {
   public:
     nodetext_cache_t *get(int node_id)
     {
-      iterator it = find(node_id);
-      if ( it == end() )
+      if ( node_id < 0 || size_t(node_id) >= size() )
         return NULL;
-      return &it->second;
+      nodetext_cache_t *c = &(*this)[node_id];
+      return c->cached ? c : NULL;
     }
     nodetext_cache_t *add(const int node_id, const char *text, bgcolor_t bgcolor = DEFCOLOR)
     {
-      return &(insert(std::make_pair(node_id, nodetext_cache_t(text, bgcolor))).first->second);
+      if ( size_t(node_id) >= size() )
+        resize(node_id + 1);
+      nodetext_cache_t *c = &(*this)[node_id];
+      c->text = text;
+      c->bgcolor = bgcolor;
+      c->cached = true;
+      return c;
     }
+    // The text will be asked again
+    void invalidate(int node_id)
+    {
+      if ( node_id < 0 || size_t(node_id) >= size() )
+        return;
+      nodetext_cache_t &c = (*this)[node_id];
+      c.text.qclear();
+      c.cached = false;
+    }
+    // The node was deleted, the following ones are renumbered
+    void del_node(int node_id)
+    {
+      if ( node_id >= 0 && size_t(node_id) < size() )
+        erase(begin() + node_id);
+    }
+  };
+
+  // Graph changes made with the pyg_add_nodes() & co. functions.
+  // They are applied at the next grcode_user_refresh, instead of
+  // rebuilding the graph through OnRefresh()
+  enum
+  {
+    GOP_ADD_NODES,    // a: count
+    GOP_DEL_NODE,     // a: node
+    GOP_ADD_EDGE,     // a: source, b: destination
+    GOP_DEL_EDGE,     // a: source, b: destination
+    GOP_TEXT_CHANGED, // a: node
+  };
+  struct graph_op_t
+  {
+    int code;
+    int a, b;
   };
+  typedef qvector<graph_op_t> graph_ops_t;
 
   class cmdid_map_t: public std::map<Py_ssize_t, py_graph_t *>
   {
@@ -80,6 +119,7 @@ private:
     void add(py_graph_t *pyg)
     {
       (*this)[uid] = pyg;
+      pyg->cmd_ids.push_back(uid);
       ++uid;
     }
 
@@ -90,17 +130,9 @@ private:
 
     void clear(py_graph_t *pyg)
     {
-      iterator e = end();
-      for (iterator it=begin();it!=end();)
-      {
-        if ( it->second == pyg )
-        {
-          iterator temp = it++;
-          erase(temp);
-        }
-        else
-          ++it;
-      }
+      for ( size_t i = 0; i < pyg->cmd_ids.size(); i++ )
+        erase(pyg->cmd_ids[i]);
+      pyg->cmd_ids.clear();
     }
 
     py_graph_t *get(Py_ssize_t id)
@@ -114,7 +146,9 @@ private:
 
   // TForm *form;
   bool refresh_needed;
-  nodetext_cache_map_t node_cache;
+  nodetext_cache_vec_t node_cache;
+  graph_ops_t pending_ops;
+  qvector<Py_ssize_t> cmd_ids;
 
   // instance callback
   int gr_callback(int code, va_list va);
@@ -149,6 +183,9 @@ private:
   // the nodes and edges. The nodes and edges are retrieved and passed to IDA
   void on_user_refresh(mutable_graph_t *g);
 
+  // Applies the pending graph changes
+  void apply_pending_ops(mutable_graph_t *g);
+
   // Retrieves the text for user-defined graph node
   // It expects either a string or a tuple (string, bgcolor)
   bool on_user_text(mutable_graph_t * /*g*/, int node, const char **str, bgcolor_t *bg_color);
@@ -162,6 +199,7 @@ private:
   {
     refresh_needed = true;
     node_cache.clear();
+    pending_ops.clear();
   }
 
   // graph is being clicked
@@ -319,6 +357,65 @@ private:
     inherited::refresh();
   }
 
+  // Queues a graph change, the viewer is refreshed by the caller.
+  // Nothing needs to be queued if the graph is to be rebuilt anyway.
+  void add_op(int code, int a, int b=0)
+  {
+    if ( refresh_needed )
+      return;
+    graph_op_t &op = pending_ops.push_back();
+    op.code = code;
+    op.a = a;
+    op.b = b;
+  }
+
+  // Queues the (source, destination) pairs of a sequence
+  bool add_edge_ops(int code, PyObject *py_edges)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t seq(PySequence_Fast(py_edges, "a sequence of edges is expected"));
+    if ( seq == NULL )
+    {
+      PyErr_Clear();
+      return false;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq.o);
+    PyObject **items = PySequence_Fast_ITEMS(seq.o);
+    for ( Py_ssize_t i = 0; i < n; i++ )
+    {
+      // Each item is a sequence (id1, id2)
+      if ( !PySequence_Check(items[i]) || PySequence_Size(items[i]) != 2 )
+        return false;
+      newref_t src(PySequence_GetItem(items[i], 0));
+      newref_t dst(PySequence_GetItem(items[i], 1));
+      if ( src == NULL || !PyInt_Check(src.o) || dst == NULL || !PyInt_Check(dst.o) )
+        return false;
+      add_op(code, int(PyInt_AS_LONG(src.o)), int(PyInt_AS_LONG(dst.o)));
+    }
+    return true;
+  }
+
+  // Queues the nodes of a sequence
+  bool add_node_ops(int code, PyObject *py_nodes)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t seq(PySequence_Fast(py_nodes, "a sequence of nodes is expected"));
+    if ( seq == NULL )
+    {
+      PyErr_Clear();
+      return false;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq.o);
+    PyObject **items = PySequence_Fast_ITEMS(seq.o);
+    for ( Py_ssize_t i = 0; i < n; i++ )
+    {
+      if ( !PyInt_Check(items[i]) )
+        return false;
+      add_op(code, int(PyInt_AS_LONG(items[i])));
+    }
+    return true;
+  }
+
   int initialize(PyObject *self, const char *title)
   {
     PYW_GIL_CHECK_LOCKED_SCOPE();
@@ -379,6 +476,57 @@ public:
     cmdid_pyg.clear(this);
   }
 
+  // Changes the nodes and edges of a shown graph
+  enum
+  {
+    EDIT_ADD_NODES,
+    EDIT_DEL_NODE,
+    EDIT_ADD_EDGES,
+    EDIT_DEL_EDGE,
+    EDIT_TEXT_CHANGED,
+  };
+  static bool EditGraph(PyObject *self, int what, PyObject *py_arg1, PyObject *py_arg2 = NULL)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    py_graph_t *_this = view_extract_this<py_graph_t>(self);
+    if ( _this == NULL || !lookup_info.find_by_py_view(NULL, NULL, _this) )
+      return false;
+
+    bool ok = true;
+    switch ( what )
+    {
+      case EDIT_ADD_NODES:
+        ok = PyInt_Check(py_arg1);
+        if ( ok )
+          _this->add_op(GOP_ADD_NODES, int(PyInt_AS_LONG(py_arg1)));
+        break;
+      case EDIT_DEL_NODE:
+        ok = PyInt_Check(py_arg1);
+        if ( ok )
+          _this->add_op(GOP_DEL_NODE, int(PyInt_AS_LONG(py_arg1)));
+        break;
+      case EDIT_ADD_EDGES:
+        ok = _this->add_edge_ops(GOP_ADD_EDGE, py_arg1);
+        break;
+      case EDIT_DEL_EDGE:
+        ok = PyInt_Check(py_arg1) && py_arg2 != NULL && PyInt_Check(py_arg2);
+        if ( ok )
+          _this->add_op(GOP_DEL_EDGE, int(PyInt_AS_LONG(py_arg1)), int(PyInt_AS_LONG(py_arg2)));
+        break;
+      case EDIT_TEXT_CHANGED:
+        ok = _this->add_node_ops(GOP_TEXT_CHANGED, py_arg1);
+        break;
+      default:
+        ok = false;
+        break;
+    }
+    // Let the viewer pick up the changes, unless the graph is
+    // being rebuilt by OnRefresh()
+    if ( !_this->refresh_needed )
+      _this->inherited::refresh();
+    return ok;
+  }
+
   static void SelectNode(PyObject *self, int /*nid*/)
   {
     py_graph_t *_this = view_extract_this<py_graph_t>(self);
@@ -470,9 +618,16 @@ void py_graph_t::collect_class_callbacks_ids(callbacks_ids_t *out)
 //-------------------------------------------------------------------------
 void py_graph_t::on_user_refresh(mutable_graph_t *g)
 {
-  if ( !refresh_needed || self == NULL /* Happens at creation-time */ )
+  if ( self == NULL /* Happens at creation-time */ )
     return;
 
+  if ( !refresh_needed )
+  {
+    apply_pending_ops(g);
+    return;
+  }
+  pending_ops.clear();
+
   // Check return value to OnRefresh() call
   PYW_GIL_CHECK_LOCKED_SCOPE();
   newref_t ret(PyObject_CallMethod(self.o, (char *)S_ON_REFRESH, NULL));
@@ -531,6 +686,43 @@ void py_graph_t::on_user_refresh(mutable_graph_t *g)
   }
 }
 
+//-------------------------------------------------------------------------
+void py_graph_t::apply_pending_ops(mutable_graph_t *g)
+{
+  for ( size_t i = 0; i < pending_ops.size(); i++ )
+  {
+    const graph_op_t &op = pending_ops[i];
+    int nodes = g->size();
+    switch ( op.code )
+    {
+      case GOP_ADD_NODES:
+        if ( op.a > 0 )
+          g->resize(nodes + op.a);
+        break;
+      case GOP_DEL_NODE:
+        if ( op.a >= 0 && op.a < nodes )
+        {
+          g->del_node(op.a);
+          node_cache.del_node(op.a);
+        }
+        break;
+      case GOP_ADD_EDGE:
+      case GOP_DEL_EDGE:
+        if ( op.a < 0 || op.a >= nodes || op.b < 0 || op.b >= nodes )
+          break;
+        if ( op.code == GOP_ADD_EDGE )
+          g->add_edge(op.a, op.b, NULL);
+        else
+          g->del_edge(op.a, op.b);
+        break;
+      case GOP_TEXT_CHANGED:
+        node_cache.invalidate(op.a);
+        break;
+    }
+  }
+  pending_ops.clear();
+}
+
 //-------------------------------------------------------------------------
 bool py_graph_t::on_user_text(mutable_graph_t * /*g*/, int node, const char **str, bgcolor_t *bg_color)
 {
@@ -574,6 +766,10 @@ bool py_graph_t::on_user_text(mutable_graph_t * /*g*/, int node, const char **st
 
     c = node_cache.add(node, s, cl);
   }
+  else
+  {
+    return false;
+  }
 
   *str = c->text.c_str();
   if ( bg_color != NULL )
@@ -756,6 +952,31 @@ void pyg_select_node(PyObject *self, int nid)
 {
   py_graph_t::SelectNode(self, nid);
 }
+
+bool pyg_add_nodes(PyObject *self, PyObject *count)
+{
+  return py_graph_t::EditGraph(self, py_graph_t::EDIT_ADD_NODES, count);
+}
+
+bool pyg_del_node(PyObject *self, PyObject *nid)
+{
+  return py_graph_t::EditGraph(self, py_graph_t::EDIT_DEL_NODE, nid);
+}
+
+bool pyg_add_edges(PyObject *self, PyObject *edges)
+{
+  return py_graph_t::EditGraph(self, py_graph_t::EDIT_ADD_EDGES, edges);
+}
+
+bool pyg_del_edge(PyObject *self, PyObject *src, PyObject *dst)
+{
+  return py_graph_t::EditGraph(self, py_graph_t::EDIT_DEL_EDGE, src, dst);
+}
+
+bool pyg_refresh_nodes(PyObject *self, PyObject *nodes)
+{
+  return py_graph_t::EditGraph(self, py_graph_t::EDIT_TEXT_CHANGED, nodes);
+}
 //</code(py_graph)>
 
 //--------------------------------------------------------------------------
@@ -765,5 +986,10 @@ void pyg_close(PyObject *self);
 PyObject *pyg_add_command(PyObject *self, const char *title, const char *hotkey);
 void pyg_select_node(PyObject *self, int nid);
 bool pyg_show(PyObject *self);
+bool pyg_add_nodes(PyObject *self, PyObject *count);
+bool pyg_del_node(PyObject *self, PyObject *nid);
+bool pyg_add_edges(PyObject *self, PyObject *edges);
+bool pyg_del_edge(PyObject *self, PyObject *src, PyObject *dst);
+bool pyg_refresh_nodes(PyObject *self, PyObject *nodes);
 //</inline(py_graph)>
 #endif
@@ -29,6 +29,67 @@ class GraphViewer(CustomIDAMemo):
         self._nodes = []
         self._edges = []
 
+    def AddNodes(self, objs):
+        """
+        Adds nodes to the graph. If the graph is shown, it is updated
+        without an OnRefresh() round trip.
+
+        @param objs: The objects associated with the new nodes
+        @return: The id of the first added node
+        """
+        first = len(self._nodes)
+        self._nodes.extend(objs)
+        _idaapi.pyg_add_nodes(self, len(self._nodes) - first)
+        return first
+
+    def DelNode(self, node_id):
+        """
+        Deletes a node and its edges. The ids of the following nodes are decreased by one.
+        If the graph is shown, it is updated without an OnRefresh() round trip.
+        """
+        del self._nodes[node_id]
+        edges = []
+        for src, dst in self._edges:
+            if src != node_id and dst != node_id:
+                edges.append((src - (src > node_id), dst - (dst > node_id)))
+        self._edges = edges
+        _idaapi.pyg_del_node(self, node_id)
+
+    def AddEdges(self, edges):
+        """
+        Adds a list of (src_node, dest_node) edges.
+        If the graph is shown, it is updated without an OnRefresh() round trip.
+
+        @return: Boolean
+        """
+        edges = list(edges)
+        self._edges.extend(edges)
+        return _idaapi.pyg_add_edges(self, edges)
+
+    def DelEdge(self, src_node, dest_node):
+        """
+        Deletes an edge.
+        If the graph is shown, it is updated without an OnRefresh() round trip.
+
+        @return: Boolean
+        """
+        for i, edge in enumerate(self._edges):
+            if tuple(edge) == (src_node, dest_node):
+                del self._edges[i]
+                break
+        else:
+            return False
+        return _idaapi.pyg_del_edge(self, src_node, dest_node)
+
+    def RefreshNodes(self, node_ids):
+        """
+        Forgets the cached text of the given nodes: OnGetText() will be called
+        again for them when they are displayed. The other nodes are not affected.
+
+        @return: Boolean
+        """
+        return _idaapi.pyg_refresh_nodes(self, list(node_ids))
+
 
     def __iter__(self):
         return (self._nodes[index] for index in xrange(0, len(self._nodes)))
@@ -95,6 +156,7 @@ class GraphViewer(CustomIDAMemo):
 #        Triggered when the graph viewer wants the text and color for a given node.
 #        This callback is triggered one time for a given node (the value will be cached and used later without calling Python).
 #        When you call refresh then again this callback will be called for each node.
+#        Use RefreshNodes() to have it called again for some nodes only.
 #
 #        This callback is mandatory.
 #
@@ -39,6 +39,7 @@ static const char S_ON_POPUP_MENU[]          = "OnPopupMenu";
 static const char S_ON_EDIT_LINE[]           = "OnEditLine";
 static const char S_ON_INSERT_LINE[]         = "OnInsertLine";
 static const char S_ON_GET_LINE[]            = "OnGetLine";
+static const char S_ON_GET_LINES[]           = "OnGetLines";
 static const char S_ON_DELETE_LINE[]         = "OnDeleteLine";
 static const char S_ON_REFRESH[]             = "OnRefresh";
 static const char S_ON_REFRESHED[]           = "OnRefreshed";
@@ -236,6 +237,9 @@ void deinit_pywraps()
   {
     PYW_GIL_CHECK_LOCKED_SCOPE();
     py_cvt_helper_module = ref_t(); // Deref.
+    clear_pyvar_cvt_plans();
+    dbgmem_cache_term();
+    dbg_reg_snapshots_term();
   }
 
   // Unregister the IDC PyInvoke0 method (helper function for add_idc_hotkey())
@@ -622,6 +626,137 @@ void *pyobj_get_clink(PyObject *pyobj)
   return t;
 }
 
+//-------------------------------------------------------------------------
+// Latency statistics of the hook dispatchers, per hook class and
+// notification code. The histograms use power of two buckets:
+// bucket #i counts the calls that took less than 2^i microseconds
+// (and at least 2^(i-1)); the last bucket is unbounded.
+#define HOOK_STATS_BUCKETS 24
+struct hook_latency_t
+{
+  uint64 count;
+  uint64 total_ns;
+  uint64 max_ns;
+  uint64 gil_total_ns;
+  uint64 gil_max_ns;
+  uint32 buckets[HOOK_STATS_BUCKETS];
+  uint32 gil_buckets[HOOK_STATS_BUCKETS];
+  hook_latency_t() { memset(this, 0, sizeof(*this)); }
+};
+typedef std::map<int, hook_latency_t> hook_latency_map_t;
+static hook_latency_map_t hook_stats[PYW_HOOK_LAST];
+static bool hook_stats_enabled = false;
+static const char *const hook_class_names[PYW_HOOK_LAST] =
+{
+  "IDP", "IDB", "DBG", "UI", "Choose2"
+};
+
+//-------------------------------------------------------------------------
+static int get_hook_latency_bucket(uint64 ns)
+{
+  uint64 us = ns / 1000;
+  int b = 0;
+  while ( us != 0 && b < HOOK_STATS_BUCKETS-1 )
+  {
+    us >>= 1;
+    b++;
+  }
+  return b;
+}
+
+//-------------------------------------------------------------------------
+bool PyW_HookStatsEnabled()
+{
+  return hook_stats_enabled;
+}
+
+//-------------------------------------------------------------------------
+// Called with the GIL held
+void PyW_RecordHookLatency(
+        pyw_hook_class_t hclass,
+        int code,
+        uint64 total_ns,
+        uint64 gil_ns)
+{
+  hook_latency_t &h = hook_stats[hclass][code];
+  h.count++;
+  h.total_ns += total_ns;
+  h.gil_total_ns += gil_ns;
+  if ( total_ns > h.max_ns )
+    h.max_ns = total_ns;
+  if ( gil_ns > h.gil_max_ns )
+    h.gil_max_ns = gil_ns;
+  h.buckets[get_hook_latency_bucket(total_ns)]++;
+  h.gil_buckets[get_hook_latency_bucket(gil_ns)]++;
+}
+
+//-------------------------------------------------------------------------
+// Returns the function behind a (bound or unbound) method
+static PyObject *get_method_function(PyObject *py_meth)
+{
+  return PyMethod_Check(py_meth) ? PyMethod_GET_FUNCTION(py_meth) : py_meth;
+}
+
+//-------------------------------------------------------------------------
+void hook_event_mask_t::compute(
+        PyObject *self,
+        const char *clsname,
+        const pyw_hook_event_t *events,
+        size_t nevents)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  all = true;
+  codes.qclear();
+  if ( self == NULL )
+    return;
+
+  ref_t py_base(get_idaapi_attr(clsname));
+  if ( py_base == NULL )
+  {
+    PyErr_Clear();
+    return;
+  }
+
+  for ( size_t i=0; i < nevents; i++ )
+  {
+    const pyw_hook_event_t &e = events[i];
+    newref_t py_meth(PyObject_GetAttrString(self, e.method));
+    newref_t py_base_meth(PyObject_GetAttrString(py_base.o, e.method));
+    PyErr_Clear();
+
+    // Keep the event unless the method is surely the default one
+    if ( py_meth != NULL
+      && py_base_meth != NULL
+      && get_method_function(py_meth.o) == get_method_function(py_base_meth.o) )
+    {
+      continue;
+    }
+    if ( size_t(e.code) >= codes.size() )
+      codes.resize(e.code + 1, 0);
+    codes[e.code] = 1;
+  }
+  all = false;
+}
+
+//-------------------------------------------------------------------------
+static PyObject *hook_buckets_to_tuple(const uint32 *buckets)
+{
+  PyObject *py_tuple = PyTuple_New(HOOK_STATS_BUCKETS);
+  if ( py_tuple == NULL )
+    return NULL;
+  for ( int i=0; i < HOOK_STATS_BUCKETS; i++ )
+  {
+    PyObject *py_count = PyInt_FromLong(long(buckets[i]));
+    if ( py_count == NULL )
+    {
+      Py_DECREF(py_tuple);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(py_tuple, i, py_count);
+  }
+  return py_tuple;
+}
+
 //</code(py_idaapi)>
 
 //<inline(py_idaapi)>
@@ -713,6 +848,93 @@ def enable_extlang_python(enable):
 void enable_extlang_python(bool enable);
 void enable_python_cli(bool enable);
 
+/*
+#<pydoc>
+def get_code_cache_stats():
+    """
+    Returns the statistics of the cache of compiled expressions used
+    when Python is the IDC extlang (see CODE_CACHE_SIZE in python.cfg)
+
+    @return: tuple(hits, misses, count, max_count)
+    """
+    pass
+#</pydoc>
+*/
+PyObject *get_code_cache_stats();
+
+/*
+#<pydoc>
+def clear_code_cache():
+    """
+    Empties the cache of compiled expressions and resets its statistics
+    @return: None
+    """
+    pass
+#</pydoc>
+*/
+void clear_code_cache();
+
+/*
+#<pydoc>
+def set_code_cache_size(size):
+    """
+    Changes the maximum number of cached compiled expressions
+
+    @param size: The new size. Zero disables the cache.
+    @return: Returns the old size
+    """
+    pass
+#</pydoc>
+*/
+int set_code_cache_size(int size);
+
+/*
+#<pydoc>
+def profiler_start(interval_ms=0):
+    """
+    Starts the sampling profiler.
+    Samples of the main thread's frame stack are taken every 'interval_ms'
+    milliseconds. The time spent in native functions (for example in _idaapi)
+    is reported separately from the time spent in Python code.
+    This function must be called from the main thread.
+
+    The samples are taken by the main thread itself, between two bytecodes.
+    This biases the results: a single slow bytecode (a long string
+    concatenation, an operation on a big list or dict, ...) counts as one
+    sample at most, however long it takes. Calls to native functions are
+    timed instead, so they are not affected. The main thread is not
+    sampled while other Python threads hold the GIL.
+
+    @param interval_ms: Interval between two samples.
+                        Zero selects PROFILER_INTERVAL from python.cfg
+    @return: False if the profiler is already running
+    """
+    pass
+#</pydoc>
+*/
+bool profiler_start(int interval_ms = 0);
+
+/*
+#<pydoc>
+def profiler_stop(path=None):
+    """
+    Stops the sampling profiler.
+
+    @param path: If specified, the samples are written to this file as
+                 collapsed stacks ("outer;inner count" lines), which can be
+                 fed to flame graph tools
+    @return: None if the profiler was not running, otherwise a dictionary:
+             - 'python': number of samples in Python code
+             - 'native': number of samples in native functions
+             - 'functions': { "name (file:line)": (self, total) }
+             - 'lines': { "file:line": samples }
+             - 'native_calls': { native_function_name: samples }
+    """
+    pass
+#</pydoc>
+*/
+PyObject *profiler_stop(const char *path = NULL);
+
 /*
 #<pydoc>
 def RunPythonStatement(stmt):
@@ -726,6 +948,152 @@ def RunPythonStatement(stmt):
 #</pydoc>
 */
 
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def enable_hook_stats(enable):
+    """
+    Enables or disables the latency statistics of the hook dispatchers
+    (IDP_Hooks, IDB_Hooks, DBG_Hooks, UI_Hooks and Choose2 item attributes).
+    When enabled, the time spent in each notification, including the time
+    spent waiting for the GIL, is recorded per hook class and notification code.
+
+    @param enable: True to enable, False to disable
+    @return: The previous state
+    """
+    pass
+#</pydoc>
+*/
+static bool enable_hook_stats(bool enable)
+{
+  qswap(enable, hook_stats_enabled);
+  return enable;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def reset_hook_stats():
+    """
+    Clears the latency statistics of the hook dispatchers
+    @return: None
+    """
+    pass
+#</pydoc>
+*/
+static void reset_hook_stats()
+{
+  for ( int i=0; i < PYW_HOOK_LAST; i++ )
+    hook_stats[i].clear();
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_hook_stats():
+    """
+    Returns the latency statistics of the hook dispatchers.
+    Durations are in nanoseconds. The histograms have 24 buckets: bucket #i
+    counts the notifications that took less than 2^i microseconds.
+
+    @return: A list of tuples:
+             (hook_class, code, count, total, max, gil_total, gil_max, histogram, gil_histogram)
+             where hook_class is one of "IDP", "IDB", "DBG", "UI", "Choose2"
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *get_hook_stats()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  newref_t py_list(PyList_New(0));
+  if ( py_list == NULL )
+    return NULL;
+
+  for ( int i=0; i < PYW_HOOK_LAST; i++ )
+  {
+    const hook_latency_map_t &m = hook_stats[i];
+    for ( hook_latency_map_t::const_iterator it=m.begin(); it != m.end(); ++it )
+    {
+      const hook_latency_t &h = it->second;
+      newref_t py_buckets(hook_buckets_to_tuple(h.buckets));
+      if ( py_buckets == NULL )
+        return NULL;
+      newref_t py_gil_buckets(hook_buckets_to_tuple(h.gil_buckets));
+      if ( py_gil_buckets == NULL )
+        return NULL;
+      newref_t py_item(Py_BuildValue("(siKKKKKOO)",
+                                     hook_class_names[i],
+                                     it->first,
+                                     (unsigned PY_LONG_LONG)h.count,
+                                     (unsigned PY_LONG_LONG)h.total_ns,
+                                     (unsigned PY_LONG_LONG)h.max_ns,
+                                     (unsigned PY_LONG_LONG)h.gil_total_ns,
+                                     (unsigned PY_LONG_LONG)h.gil_max_ns,
+                                     py_buckets.o,
+                                     py_gil_buckets.o));
+      if ( py_item == NULL || PyList_Append(py_list.o, py_item.o) != 0 )
+        return NULL;
+    }
+  }
+  py_list.incref();
+  return py_list.o;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def dump_hook_stats(path):
+    """
+    Writes the latency statistics of the hook dispatchers to a CSV file.
+    Durations are in microseconds.
+
+    @param path: The output file name
+    @return: Boolean
+    """
+    pass
+#</pydoc>
+*/
+static bool dump_hook_stats(const char *path)
+{
+  FILE *fp = qfopen(path, "w");
+  if ( fp == NULL )
+    return false;
+
+  qfprintf(fp, "class,code,count,total_us,avg_us,max_us,gil_total_us,gil_max_us");
+  for ( int b=0; b < HOOK_STATS_BUCKETS; b++ )
+  {
+    if ( b == HOOK_STATS_BUCKETS-1 )
+      qfprintf(fp, ",ge_%uus", 1u << (b-1));
+    else
+      qfprintf(fp, ",lt_%uus", 1u << b);
+  }
+  qfprintf(fp, "\n");
+
+  for ( int i=0; i < PYW_HOOK_LAST; i++ )
+  {
+    const hook_latency_map_t &m = hook_stats[i];
+    for ( hook_latency_map_t::const_iterator it=m.begin(); it != m.end(); ++it )
+    {
+      const hook_latency_t &h = it->second;
+      qfprintf(fp, "%s,%d,%" FMT_64 "u,%.3f,%.3f,%.3f,%.3f,%.3f",
+               hook_class_names[i],
+               it->first,
+               h.count,
+               h.total_ns / 1000.0,
+               h.count == 0 ? 0.0 : h.total_ns / 1000.0 / h.count,
+               h.max_ns / 1000.0,
+               h.gil_total_ns / 1000.0,
+               h.gil_max_ns / 1000.0);
+      for ( int b=0; b < HOOK_STATS_BUCKETS; b++ )
+        qfprintf(fp, ",%u", h.buckets[b]);
+      qfprintf(fp, "\n");
+    }
+  }
+  qfclose(fp);
+  return true;
+}
+
 /*
 //---------------------------------------------------------------------------
 // qstrvec_t wrapper
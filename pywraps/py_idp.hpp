@@ -431,6 +431,8 @@ class IDP_Hooks(object):
     def hook(self):
         """
         Creates an IDP hook
+        Only the notifications whose methods are overridden at the time
+        of the call are dispatched to Python.
 
         @return: Boolean true on success
         """
@@ -688,6 +690,9 @@ class IDP_Hooks(object):
 int idaapi IDP_Callback(void *ud, int notification_code, va_list va);
 class IDP_Hooks
 {
+  friend int idaapi IDP_Callback(void *ud, int notification_code, va_list va);
+  hook_event_mask_t event_mask;
+  void compute_event_mask();
 public:
   virtual ~IDP_Hooks()
   {
@@ -696,6 +701,7 @@ public:
 
   bool hook()
   {
+    compute_event_mask();
     return hook_to_notification_point(HT_IDP, IDP_Callback, this);
   }
 
@@ -807,23 +813,93 @@ public:
   }
 };
 
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+class IDB_Hooks(object):
+    def enable_batching(self, max_events = 256, max_delay_ms = 50, coalesce = True):
+        """
+        Switches the hook to batched delivery: the notifications are recorded
+        without entering Python and passed to events_batched() as one list,
+        once max_events were collected or the oldest pending one is
+        max_delay_ms old (0 disables the timer, see flush_events()).
+        The individual notification methods are not called in this mode.
+
+        @param coalesce: merge adjacent byte_patched events into ranges
+                         and drop immediately repeated events
+        @return: Boolean
+        """
+        pass
+
+    def disable_batching(self):
+        """
+        Delivers the pending events and returns to per-event delivery
+        @return: Boolean true if batching was enabled
+        """
+        pass
+
+    def flush_events(self):
+        """
+        Delivers the pending events now
+        """
+        pass
+
+    def events_batched(self, events):
+        """
+        Receives the batched notifications.
+
+        @param events: a list of tuples (name, args...), where name is the
+                       name of the notification method. Object pointers are
+                       replaced by their ids/start addresses: structures and
+                       members by their tid, functions and segments by
+                       their startEA.
+                       byte_patched is reported as (name, ea, size).
+        @return: Ignored
+        """
+        pass
+
+#</pydoc>
+*/
 //---------------------------------------------------------------------------
 // IDB hooks
 //---------------------------------------------------------------------------
 int idaapi IDB_Callback(void *ud, int notification_code, va_list va);
+struct idb_event_batch_t;
 class IDB_Hooks
 {
+  friend int idaapi IDB_Callback(void *ud, int notification_code, va_list va);
+  hook_event_mask_t event_mask;
+  idb_event_batch_t *batch;
+  void compute_event_mask();
+  int batch_event(int code, va_list va);
+  void free_batch();
+  void update_batch_timer();
+  PyObject *build_events_list() const;
+  static int idaapi batch_timer_cb(void *ud);
 public:
-  virtual ~IDB_Hooks() { unhook(); };
+  IDB_Hooks() : batch(NULL) {}
+  virtual ~IDB_Hooks()
+  {
+    free_batch();
+    unhook();
+  };
 
   bool hook()
   {
+    compute_event_mask();
     return hook_to_notification_point(HT_IDB, IDB_Callback, this);
   }
   bool unhook()
   {
     return unhook_from_notification_point(HT_IDB, IDB_Callback, this);
   }
+
+  // Batched delivery
+  bool enable_batching(int max_events = 256, int max_delay_ms = 50, bool coalesce = true);
+  bool disable_batching();
+  void flush_events();
+  virtual int events_batched(PyObject * /*events*/) { return 0; };
+
   // Hook functions to override in Python
   virtual int byte_patched(ea_t /*ea*/) { return 0; };
   virtual int cmt_changed(ea_t, bool /*repeatable_cmt*/) { return 0; };
@@ -862,12 +938,54 @@ public:
 
 //-------------------------------------------------------------------------
 //<code(py_idp)>
+//-------------------------------------------------------------------------
+// Notifications dispatched to the IDP_Hooks methods
+static const pyw_hook_event_t idp_hook_events[] =
+{
+  { processor_t::custom_ana,   "custom_ana" },
+  { processor_t::custom_out,   "custom_out" },
+  { processor_t::custom_emu,   "custom_emu" },
+  { processor_t::custom_outop, "custom_outop" },
+  { processor_t::custom_mnem,  "custom_mnem" },
+  { processor_t::is_sane_insn, "is_sane_insn" },
+  { processor_t::may_be_func,  "may_be_func" },
+  { processor_t::closebase,    "closebase" },
+  { processor_t::savebase,     "savebase" },
+  { processor_t::rename,       "rename" },
+  { processor_t::renamed,      "renamed" },
+  { processor_t::undefine,     "undefine" },
+  { processor_t::make_code,    "make_code" },
+  { processor_t::make_data,    "make_data" },
+  { processor_t::load_idasgn,  "load_idasgn" },
+  { processor_t::add_func,     "add_func" },
+  { processor_t::del_func,     "del_func" },
+  { processor_t::is_call_insn, "is_call_insn" },
+  { processor_t::is_ret_insn,  "is_ret_insn" },
+  { processor_t::assemble,     "assemble" },
+};
+
+//-------------------------------------------------------------------------
+void IDP_Hooks::compute_event_mask()
+{
+  Swig::Director *director = dynamic_cast<Swig::Director *>(this);
+  event_mask.compute(
+        director == NULL ? NULL : director->swig_get_self(),
+        "IDP_Hooks",
+        idp_hook_events,
+        qnumber(idp_hook_events));
+}
+
 //-------------------------------------------------------------------------
 int idaapi IDP_Callback(void *ud, int notification_code, va_list va)
 {
-  // This hook gets called from the kernel. Ensure we hold the GIL.
-  PYW_GIL_GET;
   IDP_Hooks *proxy = (IDP_Hooks *)ud;
+
+  // Do not wake Python up for the notifications it does not handle
+  if ( !proxy->event_mask.has(notification_code) )
+    return 0;
+
+  // This hook gets called from the kernel. Ensure we hold the GIL.
+  PYW_GIL_GET_HOOK(PYW_HOOK_IDP, notification_code);
   int ret = 0;
   try
   {
@@ -1357,12 +1475,455 @@ int idaapi IDP_Callback(void *ud, int notification_code, va_list va)
 }
 
 //---------------------------------------------------------------------------
-int idaapi IDB_Callback(void *ud, int notification_code, va_list va)
+// Notifications dispatched to the IDB_Hooks methods
+static const pyw_hook_event_t idb_hook_events[] =
 {
-  // This hook gets called from the kernel. Ensure we hold the GIL.
+  { idb_event::byte_patched,         "byte_patched" },
+  { idb_event::cmt_changed,          "cmt_changed" },
+  { idb_event::op_type_changed,      "op_type_changed" },
+  { idb_event::enum_created,         "enum_created" },
+  { idb_event::enum_deleted,         "enum_deleted" },
+  { idb_event::enum_bf_changed,      "enum_bf_changed" },
+  { idb_event::enum_cmt_changed,     "enum_cmt_changed" },
+#ifdef NO_OBSOLETE_FUNCS
+  { idb_event::enum_member_created,  "enum_member_created" },
+  { idb_event::enum_member_deleted,  "enum_member_deleted" },
+#else
+  { idb_event::enum_const_created,   "enum_member_created" },
+  { idb_event::enum_const_deleted,   "enum_member_deleted" },
+#endif
+  { idb_event::struc_created,        "struc_created" },
+  { idb_event::struc_deleted,        "struc_deleted" },
+  { idb_event::struc_renamed,        "struc_renamed" },
+  { idb_event::struc_expanded,       "struc_expanded" },
+  { idb_event::struc_cmt_changed,    "struc_cmt_changed" },
+  { idb_event::struc_member_created, "struc_member_created" },
+  { idb_event::struc_member_deleted, "struc_member_deleted" },
+  { idb_event::struc_member_renamed, "struc_member_renamed" },
+  { idb_event::struc_member_changed, "struc_member_changed" },
+  { idb_event::thunk_func_created,   "thunk_func_created" },
+  { idb_event::func_tail_appended,   "func_tail_appended" },
+  { idb_event::func_tail_removed,    "func_tail_removed" },
+  { idb_event::tail_owner_changed,   "tail_owner_changed" },
+  { idb_event::func_noret_changed,   "func_noret_changed" },
+  { idb_event::segm_added,           "segm_added" },
+  { idb_event::segm_deleted,         "segm_deleted" },
+  { idb_event::segm_start_changed,   "segm_start_changed" },
+  { idb_event::segm_end_changed,     "segm_end_changed" },
+  { idb_event::segm_moved,           "segm_moved" },
+};
+
+//-------------------------------------------------------------------------
+void IDB_Hooks::compute_event_mask()
+{
+  Swig::Director *director = dynamic_cast<Swig::Director *>(this);
+  event_mask.compute(
+        director == NULL ? NULL : director->swig_get_self(),
+        "IDB_Hooks",
+        idb_hook_events,
+        qnumber(idb_hook_events));
+}
+
+//-------------------------------------------------------------------------
+// A notification recorded for batched delivery. Pointer arguments are
+// replaced by the ids/addresses of the objects since they may not survive
+// until the batch is delivered.
+struct idb_event_rec_t
+{
+  int code;
+  int nv;
+  uval_t v[3];
+};
+
+//-------------------------------------------------------------------------
+// Notifications are sent from the main thread only, and the batch is only
+// drained from it too: the buffer needs no locking. It is preallocated
+// and reused between flushes.
+struct idb_event_batch_t
+{
+  qvector<idb_event_rec_t> events;
+  size_t max_events;
+  int max_delay_ms;
+  bool coalesce;
+  bool flushing;
+  bool in_timer;
+  bool dispose;
+  uint64 first_stamp;
+  qtimer_t timer;
+
+  idb_event_batch_t()
+    : max_events(0), max_delay_ms(0), coalesce(false), flushing(false),
+      in_timer(false), dispose(false), first_stamp(0), timer(NULL) {}
+
+  void add(const idb_event_rec_t &rec)
+  {
+    if ( coalesce && !events.empty() )
+    {
+      idb_event_rec_t &last = events.back();
+      if ( last.code == rec.code )
+      {
+        if ( rec.code == idb_event::byte_patched )
+        {
+          // v[0] is the start address, v[1] the size of the range
+          ea_t end = ea_t(last.v[0] + last.v[1]);
+          if ( rec.v[0] >= last.v[0] && rec.v[0] <= end )
+          {
+            if ( rec.v[0] == end )
+              last.v[1]++;
+            return;
+          }
+        }
+        else if ( memcmp(last.v, rec.v, rec.nv * sizeof(rec.v[0])) == 0 )
+        {
+          return;
+        }
+      }
+    }
+    if ( events.empty() )
+      first_stamp = get_nsec_stamp();
+    events.push_back(rec);
+  }
+};
+
+//-------------------------------------------------------------------------
+static const char *get_idb_event_name(int code)
+{
+  for ( size_t i = 0; i < qnumber(idb_hook_events); i++ )
+    if ( idb_hook_events[i].code == code )
+      return idb_hook_events[i].method;
+  return NULL;
+}
+
+//-------------------------------------------------------------------------
+static bool get_idb_event_rec(int code, va_list va, idb_event_rec_t *rec)
+{
+  struc_t *sptr;
+  member_t *mptr;
+  func_t *pfn;
+  segment_t *seg;
+
+  rec->code = code;
+  rec->nv = 1;
+  switch ( code )
+  {
+    case idb_event::byte_patched:
+      rec->v[0] = va_arg(va, ea_t);
+      rec->v[1] = 1;
+      rec->nv = 2;
+      break;
+
+    case idb_event::cmt_changed:
+      rec->v[0] = va_arg(va, ea_t);
+      rec->v[1] = va_arg(va, int) != 0;
+      rec->nv = 2;
+      break;
+
+    case idb_event::op_type_changed:
+      rec->v[0] = va_arg(va, ea_t);
+      rec->v[1] = va_arg(va, int);
+      rec->nv = 2;
+      break;
+
+    case idb_event::enum_created:
+    case idb_event::enum_deleted:
+    case idb_event::enum_bf_changed:
+    case idb_event::enum_cmt_changed:
+      rec->v[0] = va_arg(va, enum_t);
+      break;
+
+#ifdef NO_OBSOLETE_FUNCS
+    case idb_event::enum_member_created:
+    case idb_event::enum_member_deleted:
+#else
+    case idb_event::enum_const_created:
+    case idb_event::enum_const_deleted:
+#endif
+      rec->v[0] = va_arg(va, enum_t);
+      rec->v[1] = va_arg(va, const_t);
+      rec->nv = 2;
+      break;
+
+    case idb_event::struc_created:
+    case idb_event::struc_deleted:
+    case idb_event::struc_cmt_changed:
+      rec->v[0] = va_arg(va, tid_t);
+      break;
+
+    case idb_event::struc_renamed:
+    case idb_event::struc_expanded:
+      sptr = va_arg(va, struc_t *);
+      rec->v[0] = sptr == NULL ? BADADDR : sptr->id;
+      break;
+
+    case idb_event::struc_member_created:
+    case idb_event::struc_member_renamed:
+    case idb_event::struc_member_changed:
+      sptr = va_arg(va, struc_t *);
+      mptr = va_arg(va, member_t *);
+      rec->v[0] = sptr == NULL ? BADADDR : sptr->id;
+      rec->v[1] = mptr == NULL ? BADADDR : mptr->id;
+      rec->nv = 2;
+      break;
+
+    case idb_event::struc_member_deleted:
+      sptr = va_arg(va, struc_t *);
+      rec->v[0] = sptr == NULL ? BADADDR : sptr->id;
+      rec->v[1] = va_arg(va, tid_t);
+      rec->v[2] = va_arg(va, ea_t);
+      rec->nv = 3;
+      break;
+
+    case idb_event::thunk_func_created:
+    case idb_event::func_noret_changed:
+      pfn = va_arg(va, func_t *);
+      rec->v[0] = pfn == NULL ? BADADDR : pfn->startEA;
+      break;
+
+    case idb_event::func_tail_appended:
+      pfn = va_arg(va, func_t *);
+      rec->v[0] = pfn == NULL ? BADADDR : pfn->startEA;
+      pfn = va_arg(va, func_t *);
+      rec->v[1] = pfn == NULL ? BADADDR : pfn->startEA;
+      rec->nv = 2;
+      break;
+
+    case idb_event::func_tail_removed:
+    case idb_event::tail_owner_changed:
+      pfn = va_arg(va, func_t *);
+      rec->v[0] = pfn == NULL ? BADADDR : pfn->startEA;
+      rec->v[1] = va_arg(va, ea_t);
+      rec->nv = 2;
+      break;
+
+    case idb_event::segm_added:
+    case idb_event::segm_start_changed:
+    case idb_event::segm_end_changed:
+      seg = va_arg(va, segment_t *);
+      rec->v[0] = seg == NULL ? BADADDR : seg->startEA;
+      break;
+
+    case idb_event::segm_deleted:
+      rec->v[0] = va_arg(va, ea_t);
+      break;
+
+    case idb_event::segm_moved:
+      rec->v[0] = va_arg(va, ea_t);
+      rec->v[1] = va_arg(va, ea_t);
+      rec->v[2] = va_arg(va, asize_t);
+      rec->nv = 3;
+      break;
+
+    default:
+      return false;
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------
+bool IDB_Hooks::enable_batching(int max_events, int max_delay_ms, bool coalesce)
+{
+  if ( batch == NULL )
+    batch = new idb_event_batch_t();
+  max_delay_ms = qmax(max_delay_ms, 0);
+  // Re-create the timer of the pending events with the new delay
+  // (a running timer callback picks it up when it returns)
+  if ( batch->timer != NULL && !batch->in_timer && batch->max_delay_ms != max_delay_ms )
+  {
+    unregister_timer(batch->timer);
+    batch->timer = NULL;
+  }
+  batch->dispose = false;
+  batch->max_events = qmax(max_events, 1);
+  batch->max_delay_ms = max_delay_ms;
+  batch->coalesce = coalesce;
+  batch->events.reserve(batch->max_events);
+  update_batch_timer();
+  return true;
+}
+
+//-------------------------------------------------------------------------
+bool IDB_Hooks::disable_batching()
+{
+  if ( batch == NULL )
+    return false;
+  flush_events();
+  // Called from events_batched(): release the batch once it returns
+  if ( batch->flushing )
+    batch->dispose = true;
+  else
+    free_batch();
+  return true;
+}
+
+//-------------------------------------------------------------------------
+void IDB_Hooks::free_batch()
+{
+  if ( batch == NULL )
+    return;
+  // The timer callback unregisters itself when it finds no batch
+  if ( batch->timer != NULL && !batch->in_timer )
+    unregister_timer(batch->timer);
+  delete batch;
+  batch = NULL;
+}
+
+//-------------------------------------------------------------------------
+// The timer only runs while events are pending
+void IDB_Hooks::update_batch_timer()
+{
+  // batch_timer_cb() decides itself when it returns
+  if ( batch->in_timer )
+    return;
+  bool pending = batch->max_delay_ms > 0 && !batch->events.empty();
+  if ( pending && batch->timer == NULL )
+  {
+    batch->timer = register_timer(batch->max_delay_ms, batch_timer_cb, this);
+  }
+  else if ( !pending && batch->timer != NULL )
+  {
+    unregister_timer(batch->timer);
+    batch->timer = NULL;
+  }
+}
+
+//-------------------------------------------------------------------------
+// Returns a new list of (event name, arguments...) tuples, or NULL
+PyObject *IDB_Hooks::build_events_list() const
+{
+  Py_ssize_t n = batch->events.size();
+  newref_t py_events(PyList_New(n));
+  if ( py_events == NULL )
+    return NULL;
+  for ( Py_ssize_t i = 0; i < n; i++ )
+  {
+    const idb_event_rec_t &rec = batch->events[i];
+    PyObject *py_ev = PyTuple_New(1 + rec.nv);
+    if ( py_ev == NULL )
+      return NULL;
+    PyList_SET_ITEM(py_events.o, i, py_ev);
+    PyObject *py_name = PyString_FromString(get_idb_event_name(rec.code));
+    if ( py_name == NULL )
+      return NULL;
+    PyTuple_SET_ITEM(py_ev, 0, py_name);
+    for ( int j = 0; j < rec.nv; j++ )
+    {
+      PyObject *py_v = Py_BuildValue(PY_FMT64, pyul_t(rec.v[j]));
+      if ( py_v == NULL )
+        return NULL;
+      PyTuple_SET_ITEM(py_ev, 1 + j, py_v);
+    }
+  }
+  Py_INCREF(py_events.o);
+  return py_events.o;
+}
+
+//-------------------------------------------------------------------------
+void IDB_Hooks::flush_events()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( batch == NULL || batch->flushing || batch->events.empty() )
+    return;
+
+  newref_t py_events(build_events_list());
+  if ( py_events == NULL )
+  {
+    // Keep the events for the next flush
+    msg("IDB_Hooks: could not build the batch of events\n");
+    PyErr_Print();
+    return;
+  }
+  // Events sent while Python handles the batch start a new one
+  batch->events.qclear();
+  batch->flushing = true;
+  try
+  {
+    events_batched(py_events.o);
+  }
+  catch (Swig::DirectorException &e)
+  {
+    msg("Exception in IDB Hook function: %s\n", e.getMessage());
+    if ( PyErr_Occurred() )
+      PyErr_Print();
+  }
+  batch->flushing = false;
+  if ( batch->dispose )
+    free_batch();
+  else
+    update_batch_timer();
+}
+
+//-------------------------------------------------------------------------
+int IDB_Hooks::batch_event(int code, va_list va)
+{
+  idb_event_rec_t rec;
+  if ( get_idb_event_rec(code, va, &rec) )
+  {
+    batch->add(rec);
+    if ( batch->events.size() >= batch->max_events && !batch->flushing )
+    {
+      PYW_GIL_GET_HOOK(PYW_HOOK_IDB, code);
+      flush_events();
+    }
+    else
+    {
+      update_batch_timer();
+    }
+  }
+  return 0;
+}
+
+//-------------------------------------------------------------------------
+int idaapi IDB_Hooks::batch_timer_cb(void *ud)
+{
+  IDB_Hooks *proxy = (IDB_Hooks *)ud;
+  idb_event_batch_t *batch = proxy->batch;
+  if ( batch == NULL )
+    return -1;
+  if ( batch->max_delay_ms == 0 || batch->events.empty() )
+  {
+    batch->timer = NULL;
+    return -1;
+  }
+  // Python is handling a batch: try again later
+  if ( batch->flushing )
+    return batch->max_delay_ms;
+  uint64 age_ms = (get_nsec_stamp() - batch->first_stamp) / 1000000;
+  if ( age_ms < uint64(batch->max_delay_ms) )
+    return batch->max_delay_ms - int(age_ms);
+
   PYW_GIL_GET;
+  batch->in_timer = true;
+  proxy->flush_events();
+  // The batch was released by disable_batching() during the flush
+  if ( proxy->batch != batch )
+    return -1;
+  batch->in_timer = false;
+  // Keep running for the events sent during the flush (or kept
+  // because it failed)
+  if ( batch->max_delay_ms == 0 || batch->events.empty() )
+  {
+    batch->timer = NULL;
+    return -1;
+  }
+  return batch->max_delay_ms;
+}
 
+//---------------------------------------------------------------------------
+int idaapi IDB_Callback(void *ud, int notification_code, va_list va)
+{
   class IDB_Hooks *proxy = (class IDB_Hooks *)ud;
+
+  // Batched delivery: only record the notification
+  if ( proxy->batch != NULL )
+    return proxy->batch_event(notification_code, va);
+
+  // Do not wake Python up for the notifications it does not handle
+  if ( !proxy->event_mask.has(notification_code) )
+    return 0;
+
+  // This hook gets called from the kernel. Ensure we hold the GIL.
+  PYW_GIL_GET_HOOK(PYW_HOOK_IDB, notification_code);
+
   ea_t ea, ea2;
   bool repeatable_cmt;
   /*type_t *type;*/
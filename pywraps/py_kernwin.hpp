@@ -869,7 +869,7 @@ public:
 int idaapi UI_Callback(void *ud, int notification_code, va_list va)
 {
   // This hook gets called from the kernel. Ensure we hold the GIL.
-  PYW_GIL_GET;
+  PYW_GIL_GET_HOOK(PYW_HOOK_UI, notification_code);
   UI_Hooks *proxy = (UI_Hooks *)ud;
   int ret = 0;
   try
@@ -66,10 +66,37 @@ class loader_input_t(pyidc_opaque_object_t):
         """Reads from the file. Returns the buffer or None"""
         pass
 
+    def readinto(self, buf):
+        """
+        Reads from the file straight into a writable buffer object
+        (bytearray, array.array, mmap...), as much as the buffer can hold
+        @return: The number of bytes read, 0 at the end of the file
+        """
+        pass
+
     def readbytes(self, size, big_endian):
         """Similar to read() but it respect the endianness"""
         pass
 
+    def mmap(self):
+        """
+        Returns a read-only view over the whole input.
+        The object supports the buffer protocol (memoryview(), struct.unpack_from(), ...),
+        len(), indexing and slicing. Slicing does not copy the bytes.
+        Local files are memory mapped (the 'mapped' attribute is then True),
+        except on Windows where they are never mapped.
+        Other inputs (remote files, memory, local files on Windows) are read
+        in chunks when their bytes are first accessed; using the whole view
+        as a buffer reads it all.
+        The view's unpack_from(fmt, offset) only reads the bytes it needs.
+        A view that still has bytes to read can't be used after the input is closed.
+        Inputs borrowed from IDA (from_linput(), the input given to a loader)
+        may be closed by IDA at any time: if they can't be mapped, they are
+        read entirely when the view is created.
+        @return: The view object
+        """
+        pass
+
     def file2base(self, pos, ea1, ea2, patchable):
         """
         Load portion of file into the database
@@ -146,6 +173,7 @@ public:
       return;
 
     PYW_GIL_GET;
+    linput_views_detach(this);
     Py_BEGIN_ALLOW_THREADS;
     if ( own == OWN_CREATE )
       close_linput(li);
@@ -272,73 +300,112 @@ public:
     return r;
   }
 
+  //--------------------------------------------------------------------------
+  // The read functions fill the string they return in place.
+  // They return None if the string can't be allocated or shrunk.
+  static PyObject *new_read_buffer(size_t size)
+  {
+    PyObject *py_buf = PyString_FromStringAndSize(NULL, Py_ssize_t(size));
+    if ( py_buf == NULL )
+      PyErr_Clear();
+    return py_buf;
+  }
+
+  static bool shrink_read_buffer(PyObject **py_buf, size_t size)
+  {
+    if ( _PyString_Resize(py_buf, Py_ssize_t(size)) == 0 )
+      return true;
+    PyErr_Clear();
+    return false;
+  }
+
   //--------------------------------------------------------------------------
   PyObject *getz(size_t sz, int32 fpos = -1)
   {
     PYW_GIL_CHECK_LOCKED_SCOPE();
-    do
-    {
-      char *buf = (char *) malloc(sz + 5);
-      if ( buf == NULL )
-        break;
-      Py_BEGIN_ALLOW_THREADS;
-      qlgetz(li, fpos, buf, sz);
-      Py_END_ALLOW_THREADS;
-      PyObject *ret = PyString_FromString(buf);
-      free(buf);
-      return ret;
-    } while ( false );
-    Py_RETURN_NONE;
+    if ( sz == 0 )
+      return PyString_FromString("");
+    PyObject *py_buf = new_read_buffer(sz);
+    if ( py_buf == NULL )
+      Py_RETURN_NONE;
+    char *buf = PyString_AS_STRING(py_buf);
+    Py_BEGIN_ALLOW_THREADS;
+    qlgetz(li, fpos, buf, sz);
+    Py_END_ALLOW_THREADS;
+    if ( !shrink_read_buffer(&py_buf, strlen(buf)) )
+      Py_RETURN_NONE;
+    return py_buf;
   }
 
   //--------------------------------------------------------------------------
   PyObject *gets(size_t len)
   {
     PYW_GIL_CHECK_LOCKED_SCOPE();
-    do
+    if ( len == 0 )
+      return PyString_FromString("");
+    PyObject *py_buf = new_read_buffer(len);
+    if ( py_buf == NULL )
+      Py_RETURN_NONE;
+    char *buf = PyString_AS_STRING(py_buf);
+    bool ok;
+    Py_BEGIN_ALLOW_THREADS;
+    ok = qlgets(buf, len, li) != NULL;
+    Py_END_ALLOW_THREADS;
+    if ( !ok )
     {
-      char *buf = (char *) malloc(len + 5);
-      if ( buf == NULL )
-        break;
-      bool ok;
-      Py_BEGIN_ALLOW_THREADS;
-      ok = qlgets(buf, len, li) != NULL;
-      Py_END_ALLOW_THREADS;
-      if ( !ok )
-      {
-        free(buf);
-        break;
-      }
-      PyObject *ret = PyString_FromString(buf);
-      free(buf);
-      return ret;
-    } while ( false );
-    Py_RETURN_NONE;
+      Py_DECREF(py_buf);
+      Py_RETURN_NONE;
+    }
+    if ( !shrink_read_buffer(&py_buf, strlen(buf)) )
+      Py_RETURN_NONE;
+    return py_buf;
   }
 
   //--------------------------------------------------------------------------
   PyObject *read(size_t size)
   {
     PYW_GIL_CHECK_LOCKED_SCOPE();
-    do
+    PyObject *py_buf = new_read_buffer(size);
+    if ( py_buf == NULL )
+      Py_RETURN_NONE;
+    ssize_t r;
+    Py_BEGIN_ALLOW_THREADS;
+    r = qlread(li, PyString_AS_STRING(py_buf), size);
+    Py_END_ALLOW_THREADS;
+    if ( r == -1 )
+    {
+      Py_DECREF(py_buf);
+      Py_RETURN_NONE;
+    }
+    if ( size_t(r) < size && !shrink_read_buffer(&py_buf, r) )
+      Py_RETURN_NONE;
+    return py_buf;
+  }
+
+  //--------------------------------------------------------------------------
+  PyObject *readinto(PyObject *py_buf)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    pyw_buffer_t buf;
+    if ( !buf.acquire(py_buf, true) )
+      return NULL;
+    ssize_t r = 0;
+    if ( buf.size > 0 )
     {
-      char *buf = (char *) malloc(size + 5);
-      if ( buf == NULL )
-        break;
-      ssize_t r;
-      Py_BEGIN_ALLOW_THREADS;
-      r = qlread(li, buf, size);
-      Py_END_ALLOW_THREADS;
-      if ( r == -1 )
+      if ( buf.locked )
       {
-        free(buf);
-        break;
+        Py_BEGIN_ALLOW_THREADS;
+        r = qlread(li, buf.ptr, buf.size);
+        Py_END_ALLOW_THREADS;
       }
-      PyObject *ret = PyString_FromStringAndSize(buf, r);
-      free(buf);
-      return ret;
-    } while ( false );
-    Py_RETURN_NONE;
+      else
+      {
+        r = qlread(li, buf.ptr, buf.size);
+      }
+    }
+    if ( r < 0 )
+      return PyErr_SetFromErrno(PyExc_IOError);
+    return PyInt_FromSsize_t(r);
   }
 
   //--------------------------------------------------------------------------
@@ -351,25 +418,31 @@ public:
   PyObject *readbytes(size_t size, bool big_endian)
   {
     PYW_GIL_CHECK_LOCKED_SCOPE();
-    do
+    PyObject *py_buf = new_read_buffer(size);
+    if ( py_buf == NULL )
+      Py_RETURN_NONE;
+    int r;
+    Py_BEGIN_ALLOW_THREADS;
+    r = lreadbytes(li, PyString_AS_STRING(py_buf), size, big_endian);
+    Py_END_ALLOW_THREADS;
+    if ( r == -1 )
+    {
+      Py_DECREF(py_buf);
+      Py_RETURN_NONE;
+    }
+    return py_buf;
+  }
+
+  //--------------------------------------------------------------------------
+  PyObject *mmap()
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    if ( li == NULL )
     {
-      char *buf = (char *) malloc(size + 5);
-      if ( buf == NULL )
-        break;
-      int r;
-      Py_BEGIN_ALLOW_THREADS;
-      r = lreadbytes(li, buf, size, big_endian);
-      Py_END_ALLOW_THREADS;
-      if ( r == -1 )
-      {
-        free(buf);
-        break;
-      }
-      PyObject *ret = PyString_FromStringAndSize(buf, r);
-      free(buf);
-      return ret;
-    } while ( false );
-    Py_RETURN_NONE;
+      PyErr_SetString(PyExc_ValueError, "the input is not opened");
+      return NULL;
+    }
+    return linput_view_create(li, this, own == OWN_FROM_LI);
   }
 
   //--------------------------------------------------------------------------
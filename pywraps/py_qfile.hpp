@@ -48,6 +48,14 @@ class qfile_t(pyidc_opaque_object_t):
         """Reads from the file. Returns the buffer or None"""
         pass
 
+    def readinto(self, buf):
+        """
+        Reads from the file straight into a writable buffer object
+        (bytearray, array.array, mmap...), as much as the buffer can hold
+        @return: The number of bytes read, 0 at the end of the file
+        """
+        pass
+
     def write(self, buf):
         """Writes to the file. Returns 0 or the number of bytes written"""
         pass
@@ -227,79 +235,110 @@ public:
   }
 
   //--------------------------------------------------------------------------
+  // The read functions fill the string they return in place.
+  // They return None if the string can't be allocated.
   PyObject *readbytes(int size, bool big_endian)
   {
-    do
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    PyObject *py_buf = size < 0 ? NULL : PyString_FromStringAndSize(NULL, size);
+    if ( py_buf == NULL )
     {
-      char *buf = (char *) malloc(size + 5);
-      if ( buf == NULL )
-        break;
-      PYW_GIL_CHECK_LOCKED_SCOPE();
-      int r;
-      Py_BEGIN_ALLOW_THREADS;
-      r = freadbytes(fp, buf, size, big_endian);
-      Py_END_ALLOW_THREADS;
-      if ( r != 0 )
-      {
-        free(buf);
-        break;
-      }
-
-      PyObject *ret = PyString_FromStringAndSize(buf, r);
-      free(buf);
-      return ret;
-    } while ( false );
-    Py_RETURN_NONE;
+      PyErr_Clear();
+      Py_RETURN_NONE;
+    }
+    char *buf = PyString_AS_STRING(py_buf);
+    int r;
+    Py_BEGIN_ALLOW_THREADS;
+    r = freadbytes(fp, buf, size, big_endian);
+    Py_END_ALLOW_THREADS;
+    if ( r != 0 )
+    {
+      Py_DECREF(py_buf);
+      Py_RETURN_NONE;
+    }
+    return py_buf;
   }
 
   //--------------------------------------------------------------------------
   PyObject *read(int size)
   {
-    do
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    PyObject *py_buf = size <= 0 ? NULL : PyString_FromStringAndSize(NULL, size);
+    if ( py_buf == NULL )
     {
-      char *buf = (char *) malloc(size + 5);
-      if ( buf == NULL )
-        break;
-      PYW_GIL_CHECK_LOCKED_SCOPE();
-      int r;
-      Py_BEGIN_ALLOW_THREADS;
-      r = qfread(fp, buf, size);
-      Py_END_ALLOW_THREADS;
-      if ( r <= 0 )
+      PyErr_Clear();
+      Py_RETURN_NONE;
+    }
+    char *buf = PyString_AS_STRING(py_buf);
+    ssize_t r;
+    Py_BEGIN_ALLOW_THREADS;
+    r = qfread(fp, buf, size);
+    Py_END_ALLOW_THREADS;
+    if ( r <= 0 )
+    {
+      Py_DECREF(py_buf);
+      Py_RETURN_NONE;
+    }
+    if ( r < size && _PyString_Resize(&py_buf, r) != 0 )
+    {
+      PyErr_Clear();
+      Py_RETURN_NONE;
+    }
+    return py_buf;
+  }
+
+  //--------------------------------------------------------------------------
+  PyObject *readinto(PyObject *py_buf)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    pyw_buffer_t buf;
+    if ( !buf.acquire(py_buf, true) )
+      return NULL;
+    ssize_t r = 0;
+    if ( buf.size > 0 )
+    {
+      if ( buf.locked )
+      {
+        Py_BEGIN_ALLOW_THREADS;
+        r = qfread(fp, buf.ptr, buf.size);
+        Py_END_ALLOW_THREADS;
+      }
+      else
       {
-        free(buf);
-        break;
+        r = qfread(fp, buf.ptr, buf.size);
       }
-      PyObject *ret = PyString_FromStringAndSize(buf, r);
-      free(buf);
-      return ret;
-    } while ( false );
-    Py_RETURN_NONE;
+    }
+    if ( r < 0 )
+      return PyErr_SetFromErrno(PyExc_IOError);
+    return PyInt_FromSsize_t(r);
   }
 
   //--------------------------------------------------------------------------
   PyObject *gets(int size)
   {
-    do
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    PyObject *py_buf = size <= 0 ? NULL : PyString_FromStringAndSize(NULL, size);
+    if ( py_buf == NULL )
     {
-      char *buf = (char *) malloc(size + 5);
-      if ( buf == NULL )
-        break;
-      PYW_GIL_CHECK_LOCKED_SCOPE();
-      char *p;
-      Py_BEGIN_ALLOW_THREADS;
-      p = qfgets(buf, size, fp);
-      Py_END_ALLOW_THREADS;
-      if ( p == NULL )
-      {
-        free(buf);
-        break;
-      }
-      PyObject *ret = PyString_FromString(buf);
-      free(buf);
-      return ret;
-    } while ( false );
-    Py_RETURN_NONE;
+      PyErr_Clear();
+      Py_RETURN_NONE;
+    }
+    char *buf = PyString_AS_STRING(py_buf);
+    char *p;
+    Py_BEGIN_ALLOW_THREADS;
+    p = qfgets(buf, size, fp);
+    Py_END_ALLOW_THREADS;
+    if ( p == NULL )
+    {
+      Py_DECREF(py_buf);
+      Py_RETURN_NONE;
+    }
+    if ( _PyString_Resize(&py_buf, strlen(buf)) != 0 )
+    {
+      PyErr_Clear();
+      Py_RETURN_NONE;
+    }
+    return py_buf;
   }
 
   //--------------------------------------------------------------------------
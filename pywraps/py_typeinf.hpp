@@ -61,6 +61,66 @@ PyObject *py_calc_type_size(const til_t *ti, PyObject *tp)
   }
 }
 
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_scalar_typecode(ti, tp):
+    """
+    Returns the array.array typecode matching a scalar type
+    (integer, enum, pointer or floating point type).
+    Plain chars are not scalars here: arrays of chars are strings.
+    @param ti: Type info. 'idaapi.cvar.idati' can be passed.
+    @param tp: type string
+    @return:
+        - None if the type is not a scalar or if no typecode has its size
+        - The typecode
+    """
+    pass
+#</pydoc>
+*/
+PyObject *py_get_scalar_typecode(const til_t *ti, PyObject *tp)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( !PyString_Check(tp) )
+  {
+    PyErr_SetString(PyExc_ValueError, "String expected!");
+    return NULL;
+  }
+  const type_t *data = (type_t *)PyString_AsString(tp);
+  tinfo_t tif;
+  if ( !tif.deserialize(ti, &data, NULL, NULL) )
+    Py_RETURN_NONE;
+  type_t t = tif.get_realtype();
+  size_t sz = tif.get_size();
+  char tc = '\0';
+  if ( is_type_floating(t) )
+  {
+    if ( sz == sizeof(float) )
+      tc = 'f';
+    else if ( sz == sizeof(double) )
+      tc = 'd';
+  }
+  else if ( get_base_type(t) == BT_INT8 && get_type_flags(t) == BTMT_CHAR )
+  {
+    // Arrays of chars are strings
+  }
+  else if ( is_type_integral(t) || is_type_enum(t) || is_type_ptr(t) )
+  {
+    tc = PyW_ArrayTypecode(sz);
+    // Signed integers use the lowercase typecodes
+    if ( tc != '\0'
+      && is_type_integral(t)
+      && get_base_type(t) != BT_BOOL
+      && get_type_flags(t) != BTMT_USIGNED )
+    {
+      tc = qtolower(tc);
+    }
+  }
+  if ( tc == '\0' )
+    Py_RETURN_NONE;
+  return PyString_FromStringAndSize(&tc, 1);
+}
+
 //-------------------------------------------------------------------------
 /*
 #<pydoc>
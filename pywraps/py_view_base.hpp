@@ -179,6 +179,11 @@ public:
   }
   void set_node_info(PyObject *py_node_idx, PyObject *py_node_info, PyObject *py_flags);
   void set_nodes_infos(PyObject *dict);
+  PyObject *set_nodes_infos_arrays(
+          PyObject *py_nodes,
+          PyObject *py_bg_colors,
+          PyObject *py_frame_colors,
+          PyObject *py_texts);
   PyObject *get_node_info(PyObject *py_node_idx);
   void del_nodes_infos(PyObject *py_nodes);
   PyObject *get_current_renderer_type();
@@ -330,6 +335,174 @@ void py_customidamemo_t::set_nodes_infos(PyObject *dict)
   }
 }
 
+//-------------------------------------------------------------------------
+// A column of integers for set_nodes_infos_arrays(): None, a single number
+// used for all the nodes, an array.array or a sequence of numbers.
+// Returns false and sets a Python exception if it can't be converted
+static bool get_nodes_infos_column(
+        qvector<uint64> *out,
+        bool *present,
+        PyObject *py_col,
+        Py_ssize_t count,
+        const char *name)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  *present = py_col != NULL && py_col != Py_None;
+  if ( !*present )
+    return true;
+
+  if ( PyInt_Check(py_col) || PyLong_Check(py_col) )
+  {
+    uint64 v = PyInt_AsUnsignedLongLongMask(py_col);
+    if ( PyErr_Occurred() )
+      return false;
+    out->resize(count, v);
+    return true;
+  }
+
+  ref_t py_code(PyW_TryGetAttrString(py_col, "typecode"));
+  const char *code = py_code == NULL ? NULL : PyString_AsString(py_code.o);
+  const void *buf;
+  Py_ssize_t len;
+  if ( code != NULL && PyObject_AsReadBuffer(py_col, &buf, &len) == 0 )
+  {
+    size_t isz;
+    switch ( *code )
+    {
+      case 'b': case 'B': isz = 1; break;
+      case 'h': case 'H': isz = 2; break;
+      case 'i': case 'I': isz = sizeof(int); break;
+      case 'l': case 'L': isz = sizeof(long); break;
+      default:
+        PyErr_Format(PyExc_TypeError, "%s: unsupported array type '%s'", name, code);
+        return false;
+    }
+    size_t n = size_t(len) / isz;
+    if ( n != size_t(count) )
+    {
+      PyErr_Format(PyExc_ValueError, "%s: %zd items expected", name, count);
+      return false;
+    }
+    out->resize(n);
+    for ( size_t i = 0; i < n; i++ )
+    {
+      switch ( *code )
+      {
+        case 'b': (*out)[i] = uint64(((const signed char *)buf)[i]);    break;
+        case 'B': (*out)[i] = ((const unsigned char *)buf)[i];          break;
+        case 'h': (*out)[i] = uint64(((const short *)buf)[i]);          break;
+        case 'H': (*out)[i] = ((const unsigned short *)buf)[i];         break;
+        case 'i': (*out)[i] = uint64(((const int *)buf)[i]);            break;
+        case 'I': (*out)[i] = ((const unsigned int *)buf)[i];           break;
+        case 'l': (*out)[i] = uint64(((const long *)buf)[i]);           break;
+        default:  (*out)[i] = ((const unsigned long *)buf)[i];          break;
+      }
+    }
+    return true;
+  }
+  PyErr_Clear();
+
+  newref_t seq(PySequence_Fast(py_col, "a sequence of numbers is expected"));
+  if ( seq == NULL )
+    return false;
+  if ( PySequence_Fast_GET_SIZE(seq.o) != count )
+  {
+    PyErr_Format(PyExc_ValueError, "%s: %zd items expected", name, count);
+    return false;
+  }
+  PyObject **items = PySequence_Fast_ITEMS(seq.o);
+  out->resize(count);
+  for ( Py_ssize_t i = 0; i < count; i++ )
+  {
+    if ( !PyInt_Check(items[i]) && !PyLong_Check(items[i]) )
+    {
+      PyErr_Format(PyExc_TypeError, "%s: item %zd is not a number", name, i);
+      return false;
+    }
+    (*out)[i] = PyInt_AsUnsignedLongLongMask(items[i]);
+  }
+  return !PyErr_Occurred();
+}
+
+//-------------------------------------------------------------------------
+PyObject *py_customidamemo_t::set_nodes_infos_arrays(
+        PyObject *py_nodes,
+        PyObject *py_bg_colors,
+        PyObject *py_frame_colors,
+        PyObject *py_texts)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  if ( py_nodes == Py_None || PyInt_Check(py_nodes) || PyLong_Check(py_nodes) )
+  {
+    PyErr_SetString(PyExc_TypeError, "nodes: a sequence of node numbers is expected");
+    return NULL;
+  }
+  Py_ssize_t count = PyObject_Size(py_nodes);
+  if ( count < 0 )
+    return NULL;
+
+  qvector<uint64> nodes, bg_colors, frame_colors;
+  bool has_nodes, has_bg, has_frame;
+  if ( !get_nodes_infos_column(&nodes, &has_nodes, py_nodes, count, "nodes")
+    || !get_nodes_infos_column(&bg_colors, &has_bg, py_bg_colors, count, "bg_colors")
+    || !get_nodes_infos_column(&frame_colors, &has_frame, py_frame_colors, count, "frame_colors") )
+  {
+    return NULL;
+  }
+
+  // The texts: None, a single string or a sequence of strings
+  // (items that are not strings leave the node text alone)
+  bool has_texts = py_texts != NULL && py_texts != Py_None;
+  const char *text = has_texts && PyString_Check(py_texts) ? PyString_AsString(py_texts) : NULL;
+  PyObject **texts = NULL;
+  newref_t texts_seq(has_texts && text == NULL
+                   ? PySequence_Fast(py_texts, "texts: a string or a sequence of strings is expected")
+                   : NULL);
+  if ( has_texts && text == NULL )
+  {
+    if ( texts_seq == NULL )
+      return NULL;
+    if ( PySequence_Fast_GET_SIZE(texts_seq.o) != count )
+    {
+      PyErr_Format(PyExc_ValueError, "texts: %zd items expected", count);
+      return NULL;
+    }
+    texts = PySequence_Fast_ITEMS(texts_seq.o);
+  }
+
+  for ( Py_ssize_t i = 0; i < count; i++ )
+  {
+    node_info_t ni;
+    uint32 flags = 0;
+    if ( has_bg )
+    {
+      ni.bg_color = bgcolor_t(bg_colors[i]);
+      flags |= NIF_BG_COLOR;
+    }
+    if ( has_frame )
+    {
+      ni.frame_color = bgcolor_t(frame_colors[i]);
+      flags |= NIF_FRAME_COLOR;
+    }
+    if ( texts != NULL && PyString_Check(texts[i]) )
+    {
+      ni.text = PyString_AS_STRING(texts[i]);
+      flags |= NIF_TEXT;
+    }
+    else if ( text != NULL )
+    {
+      ni.text = text;
+      flags |= NIF_TEXT;
+    }
+    if ( flags == 0 )
+      continue;
+    int idx = int(nodes[i]);
+    viewer_set_node_info(view, idx, ni, flags);
+    node_info_modified(idx, &ni, flags);
+  }
+  return PyInt_FromSsize_t(count);
+}
+
 //-------------------------------------------------------------------------
 PyObject *py_customidamemo_t::get_node_info(PyObject *py_node_idx)
 {
@@ -728,6 +901,18 @@ void pygc_set_nodes_infos(PyObject *self, PyObject *values)
   _this->set_nodes_infos(values);
 }
 
+//-------------------------------------------------------------------------
+PyObject *pygc_set_nodes_infos_arrays(
+        PyObject *self,
+        PyObject *nodes,
+        PyObject *bg_colors,
+        PyObject *frame_colors,
+        PyObject *texts)
+{
+  CHK_THIS_OR_NONE();
+  return _this->set_nodes_infos_arrays(nodes, bg_colors, frame_colors, texts);
+}
+
 //-------------------------------------------------------------------------
 PyObject *pygc_get_node_info(PyObject *self, PyObject *py_node_idx)
 {
@@ -795,6 +980,7 @@ lookup_info_t py_customidamemo_t::lookup_info;
 void pygc_refresh(PyObject *self);
 void pygc_set_node_info(PyObject *self, PyObject *py_node_idx, PyObject *py_node_info, PyObject *py_flags);
 void pygc_set_nodes_infos(PyObject *self, PyObject *values);
+PyObject *pygc_set_nodes_infos_arrays(PyObject *self, PyObject *nodes, PyObject *bg_colors, PyObject *frame_colors, PyObject *texts);
 PyObject *pygc_get_node_info(PyObject *self, PyObject *py_node_idx);
 void pygc_del_nodes_infos(PyObject *self, PyObject *py_nodes);
 PyObject *pygc_get_current_renderer_type(PyObject *self);
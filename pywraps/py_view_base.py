@@ -45,9 +45,29 @@ class CustomIDAMemo(object):
           inst.SetNodesInfos({0 : p, 1 : p, 2 : p})
 
         @param values: A dictionary of 'int -> node_info_t' objects.
+        @note: SetNodesInfosArrays() is much faster to update many nodes.
         """
         _idaapi.pygc_set_nodes_infos(self, values)
 
+    def SetNodesInfosArrays(self, nodes, bg_colors=None, frame_colors=None, texts=None):
+        """
+        Set the colors and/or texts of many nodes in one pass, without
+        creating a node_info_t per node.
+
+        Example usage (color nodes after a diff):
+          inst.SetNodesInfosArrays(
+                array.array('i', changed), bg_colors=array.array('L', colors))
+          inst.SetNodesInfosArrays(matched, bg_colors=0x00ff00, frame_colors=0)
+
+        @param nodes: A list or an array.array of node IDs
+        @param bg_colors: None, a color for all the nodes, or a list/array.array of colors (one per node)
+        @param frame_colors: Same as bg_colors, for the frame colors
+        @param texts: None, a text for all the nodes, or a list of strings (an item
+                      that is not a string leaves the text of its node unchanged)
+        @return: The number of nodes
+        """
+        return _idaapi.pygc_set_nodes_infos_arrays(self, nodes, bg_colors, frame_colors, texts)
+
     def GetNodeInfo(self, node):
         """
         Get the properties for the given node.
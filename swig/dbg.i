@@ -39,6 +39,7 @@ typedef struct
 %{
 //<code(py_dbg)>
 static PyObject *meminfo_vec_t_to_py(meminfo_vec_t &areas);
+static void dbgmem_cache_invalidate();
 //</code(py_dbg)>
 %}
 
@@ -120,6 +121,7 @@ static PyObject *refresh_debugger_memory()
   isEnabled(0);
 
   PYW_GIL_CHECK_LOCKED_SCOPE();
+  dbgmem_cache_invalidate();
   Py_RETURN_NONE;
 }
 
@@ -193,7 +195,7 @@ public:
 int idaapi DBG_Callback(void *ud, int notification_code, va_list va)
 {
   // This hook gets called from the kernel. Ensure we hold the GIL.
-  PYW_GIL_GET;
+  PYW_GIL_GET_HOOK(PYW_HOOK_DBG, notification_code);
 
   class DBG_Hooks *proxy = (class DBG_Hooks *)ud;
   debug_event_t *event;
@@ -103,6 +103,7 @@ static PyObject *type##_get_clink_ptr(PyObject *self)
 #include "err.h"
 #include "fpro.h"
 #include <map>
+#include <algorithm>
 #include "graph.hpp"
 #ifdef WITH_HEXRAYS
 #include "hexrays.hpp"
@@ -596,6 +597,65 @@ bool PyW_PyListToStrVec(PyObject *py_list, qstrvec_t &strvec)
   return pyvar_walk_list(py_list, pylist_to_strvec_cb, &strvec) != CIP_FAILED;
 }
 
+//---------------------------------------------------------------------------
+char PyW_ArrayTypecode(size_t itemsize)
+{
+  if ( itemsize == sizeof(unsigned char) )
+    return 'B';
+  if ( itemsize == sizeof(unsigned short) )
+    return 'H';
+  if ( itemsize == sizeof(unsigned int) )
+    return 'I';
+  if ( itemsize == sizeof(unsigned long) )
+    return 'L';
+  return '\0';
+}
+
+//---------------------------------------------------------------------------
+// The items are passed to array.array() as one string, so that the
+// array is filled with a single memcpy
+ref_t PyW_CreateArray(char typecode, const void *items, size_t nbytes)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  // (the Try* helpers clear the error: set one for the caller)
+  ref_t py_mod(PyW_TryImportModule("array"));
+  ref_t py_cls;
+  if ( py_mod != NULL )
+    py_cls = PyW_TryGetAttrString(py_mod.o, "array");
+  if ( py_cls == NULL )
+  {
+    PyErr_SetString(PyExc_ImportError, "cannot import array.array");
+    return ref_t();
+  }
+  newref_t py_raw(PyString_FromStringAndSize((const char *)items, Py_ssize_t(nbytes)));
+  if ( py_raw == NULL )
+    return ref_t();
+  newref_t py_arr(PyObject_CallFunction(py_cls.o, "cO", typecode, py_raw.o));
+  return ref_t(py_arr);
+}
+
+//---------------------------------------------------------------------------
+ref_t PyW_EaVecToPyArray(const eavec_t &eavec)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  char typecode = PyW_ArrayTypecode(sizeof(ea_t));
+  if ( typecode != '\0' )
+    return PyW_CreateArray(typecode, eavec.begin(), eavec.size() * sizeof(ea_t));
+
+  size_t c = eavec.size();
+  newref_t py_list(PyList_New(c));
+  if ( py_list == NULL )
+    return ref_t();
+  for ( size_t i=0; i<c; i++ )
+  {
+    PyObject *py_item = Py_BuildValue(PY_FMT64, pyul_t(eavec[i]));
+    if ( py_item == NULL )
+      return ref_t();
+    PyList_SET_ITEM(py_list.o, i, py_item);
+  }
+  return ref_t(py_list);
+}
+
 //-------------------------------------------------------------------------
 // Checks if the given py_var is a special PyIdc_cvt_helper object.
 // It does that by examining the magic attribute and returns its numeric value.
@@ -681,6 +741,302 @@ static error_t idaapi py_idc_opaque_dtor(
   return eOk;
 }
 
+//-------------------------------------------------------------------------
+// Returns the IDC attribute name of the i-th item of a list ("0", "1", ...)
+// The names of the first items are rendered once and then reused.
+#define PY_IDC_CACHED_IDX_NAMES 4096
+static const char *get_idc_idx_name(Py_ssize_t i, char *buf, size_t bufsize)
+{
+  static qstrvec_t names;
+  if ( i < PY_IDC_CACHED_IDX_NAMES )
+  {
+    while ( names.size() <= size_t(i) )
+    {
+      size_t n = names.size();
+      names.push_back().sprnt("%" FMT_Z, n);
+    }
+    return names[i].c_str();
+  }
+  qsnprintf(buf, bufsize, "%" FMT_Z, size_t(i));
+  return buf;
+}
+
+//-------------------------------------------------------------------------
+// Converts a Python list or sequence into an IDC object
+// whose attributes are named after the item indexes
+static int pyvar_seq_to_idcvar(
+        PyObject *py_var,
+        idc_value_t *idc_var,
+        int *gvar_sn)
+{
+  // Create the object
+  VarObject(idc_var);
+
+  // Determine list size and type
+  bool is_seq = !PyList_CheckExact(py_var);
+  Py_ssize_t size = is_seq ? PySequence_Size(py_var) : PyList_GET_SIZE(py_var);
+  char buf[32];
+
+  // Convert each item
+  for ( Py_ssize_t i=0; i<size; i++ )
+  {
+    // Get the item
+    ref_t py_item;
+    if ( is_seq )
+      py_item = newref_t(PySequence_GetItem(py_var, i));
+    else
+      py_item = borref_t(PyList_GET_ITEM(py_var, i));
+
+    // Convert the item into an IDC variable
+    idc_value_t v;
+    if ( pyvar_to_idcvar(py_item, &v, gvar_sn) < CIP_OK )
+      return CIP_FAILED;
+
+    // Store the attribute
+    VarSetAttr(idc_var, get_idc_idx_name(i, buf, sizeof(buf)), &v);
+  }
+  return CIP_OK;
+}
+
+//-------------------------------------------------------------------------
+// Conversion fast paths, selected by the exact type of the Python object
+typedef int (*pyvar_fast_cvt_t)(PyObject *py_var, idc_value_t *idc_var, int *gvar_sn);
+
+static int pyvar_fast_cvt_int(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  idc_var->set_long(PyInt_AS_LONG(py_var));
+  return CIP_OK;
+}
+
+static int pyvar_fast_cvt_long(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  return PyW_GetNumberAsIDC(py_var, idc_var) ? CIP_OK : CIP_FAILED;
+}
+
+static int pyvar_fast_cvt_bool(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  idc_var->set_long(py_var == Py_True ? 1 : 0);
+  return CIP_OK;
+}
+
+static int pyvar_fast_cvt_str(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  idc_var->_set_string(PyString_AS_STRING(py_var), PyString_GET_SIZE(py_var));
+  return CIP_OK;
+}
+
+static int pyvar_fast_cvt_float(PyObject *py_var, idc_value_t *idc_var, int *)
+{
+  double dresult = PyFloat_AS_DOUBLE(py_var);
+  ieee_realcvt((void *)&dresult, idc_var->e, 3);
+  idc_var->vtype = VT_FLOAT;
+  return CIP_OK;
+}
+
+static pyvar_fast_cvt_t find_pyvar_fast_cvt(PyTypeObject *type)
+{
+  struct entry_t
+  {
+    PyTypeObject *type;
+    pyvar_fast_cvt_t cvt;
+  };
+  static const entry_t table[] =
+  {
+    { &PyInt_Type,    pyvar_fast_cvt_int },
+    { &PyString_Type, pyvar_fast_cvt_str },
+    { &PyLong_Type,   pyvar_fast_cvt_long },
+    { &PyList_Type,   pyvar_seq_to_idcvar },
+    { &PyFloat_Type,  pyvar_fast_cvt_float },
+    { &PyBool_Type,   pyvar_fast_cvt_bool },
+  };
+  for ( size_t i=0; i < qnumber(table); i++ )
+  {
+    if ( table[i].type == type )
+      return table[i].cvt;
+  }
+  return NULL;
+}
+
+//-------------------------------------------------------------------------
+static bool is_private_attr_name(const char *field_name)
+{
+  size_t len = strlen(field_name);
+  return len > 2
+      && strncmp(field_name, "__", 2) == 0
+      && strncmp(field_name+len-2, "__", 2) == 0;
+}
+
+//-------------------------------------------------------------------------
+// Conversion plans for instances of new-style classes.
+// A plan records the non-private class level attribute names so that dir()
+// is not called and scanned for every converted object. The attributes
+// are converted exactly like in the dir() path (callables included).
+// Python 2 has no dictionary version, so the plan is tied to the type
+// version tag instead: assigning to a class attribute (or to an attribute
+// of a base class) invalidates the tag and the plan gets rebuilt.
+// Instance attributes are always read from the instance __dict__.
+struct pyvar_cvt_plan_t
+{
+  unsigned int version_tag;
+  bool valid;
+  bool empty_dir;     // dir() only lists the instance dictionary keys
+  qvector<ref_t> names;
+};
+typedef std::map<PyTypeObject *, pyvar_cvt_plan_t> pyvar_cvt_plans_t;
+static pyvar_cvt_plans_t pyvar_cvt_plans;
+static ref_t py_dir_attr_name;
+#define PY_IDC_MAX_CVT_PLANS 256
+
+//-------------------------------------------------------------------------
+static void clear_pyvar_cvt_plans()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  pyvar_cvt_plans.clear();
+  py_dir_attr_name = ref_t();
+}
+
+//-------------------------------------------------------------------------
+// Returns the conversion plan of the class of 'py_var', or NULL if the
+// object must be converted by going through dir()
+static const pyvar_cvt_plan_t *get_pyvar_cvt_plan(PyObject *py_var)
+{
+  PyTypeObject *tp = Py_TYPE(py_var);
+
+  // Only plain new-style instances: custom __getattr__/__getattribute__
+  // and classic instances may expose anything
+  if ( !PyType_HasFeature(tp, Py_TPFLAGS_HAVE_VERSION_TAG)
+    || tp->tp_getattro != PyObject_GenericGetAttr )
+  {
+    return NULL;
+  }
+
+  pyvar_cvt_plans_t::iterator p = pyvar_cvt_plans.find(tp);
+  if ( p != pyvar_cvt_plans.end()
+    && p->second.valid
+    && PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG)
+    && p->second.version_tag == tp->tp_version_tag )
+  {
+    return &p->second;
+  }
+
+  // A class with its own __dir__ decides what its attributes are
+  if ( py_dir_attr_name == NULL )
+    py_dir_attr_name = newref_t(PyString_InternFromString("__dir__"));
+  if ( py_dir_attr_name == NULL || _PyType_Lookup(tp, py_dir_attr_name.o) != NULL )
+  {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  newref_t py_dir(PyObject_Dir(py_var));
+  if ( py_dir == NULL || !PyList_Check(py_dir.o) )
+  {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  if ( p == pyvar_cvt_plans.end() )
+  {
+    if ( pyvar_cvt_plans.size() >= PY_IDC_MAX_CVT_PLANS )
+      pyvar_cvt_plans.clear();
+    p = pyvar_cvt_plans.insert(std::make_pair(tp, pyvar_cvt_plan_t())).first;
+  }
+  pyvar_cvt_plan_t &plan = p->second;
+  plan.names.qclear();
+  plan.empty_dir = true;
+
+  Py_ssize_t size = PyList_GET_SIZE(py_dir.o);
+  for ( Py_ssize_t i=0; i<size; i++ )
+  {
+    PyObject *item = PyList_GET_ITEM(py_dir.o, i);
+    if ( !PyString_Check(item) )
+      continue;
+
+    // Names that only exist in the instance dictionary are not recorded
+    if ( _PyType_Lookup(tp, item) == NULL )
+      continue;
+    plan.empty_dir = false;
+
+    if ( !is_private_attr_name(PyString_AS_STRING(item)) )
+      plan.names.push_back(borref_t(item));
+  }
+
+  // Looking up the attributes assigned a version tag to the type
+  plan.valid = PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG);
+  plan.version_tag = tp->tp_version_tag;
+  return &plan;
+}
+
+//-------------------------------------------------------------------------
+// Converts an instance of a new-style class using its class conversion plan
+static int pyvar_obj_to_idcvar(
+        PyObject *py_var,
+        const pyvar_cvt_plan_t &plan,
+        idc_value_t *idc_var,
+        int *gvar_sn)
+{
+  // Nested conversions may rebuild or drop the plan: work on a copy
+  const qvector<ref_t> names(plan.names);
+
+  // Create the IDC object
+  VarObject(idc_var);
+
+  // Instance attributes
+  PyObject **dictptr = _PyObject_GetDictPtr(py_var);
+  PyObject *py_dict = dictptr != NULL && *dictptr != NULL && PyDict_Check(*dictptr) ? *dictptr : NULL;
+  borref_t py_dict_ref(py_dict);
+
+  // Like the dir() path, fail for objects without attributes
+  if ( plan.empty_dir && (py_dict == NULL || PyDict_Size(py_dict) == 0) )
+    return CIP_FAILED;
+
+  if ( py_dict != NULL )
+  {
+    // Take a snapshot: converting the values may run Python code
+    newref_t py_items(PyDict_Items(py_dict));
+    if ( py_items == NULL )
+      return CIP_FAILED;
+
+    Py_ssize_t size = PyList_GET_SIZE(py_items.o);
+    for ( Py_ssize_t i=0; i<size; i++ )
+    {
+      PyObject *py_item = PyList_GET_ITEM(py_items.o, i);
+      PyObject *py_key = PyTuple_GET_ITEM(py_item, 0);
+      if ( !PyString_Check(py_key) )
+        continue;
+
+      const char *field_name = PyString_AS_STRING(py_key);
+      if ( is_private_attr_name(field_name) )
+        continue;
+
+      idc_value_t v;
+      borref_t attr(PyTuple_GET_ITEM(py_item, 1));
+      if ( pyvar_to_idcvar(attr, &v, gvar_sn) < CIP_OK )
+        return CIP_FAILED;
+
+      VarSetAttr(idc_var, field_name, &v);
+    }
+  }
+
+  // Class attributes
+  for ( size_t i=0; i < names.size(); i++ )
+  {
+    const ref_t &py_name = names[i];
+
+    // Already stored from the instance dictionary?
+    if ( py_dict != NULL && PyDict_GetItem(py_dict, py_name.o) != NULL )
+      continue;
+
+    idc_value_t v;
+    newref_t attr(PyObject_GetAttr(py_var, py_name.o));
+    if ( attr == NULL || pyvar_to_idcvar(attr, &v, gvar_sn) < CIP_OK )
+      return CIP_FAILED;
+
+    VarSetAttr(idc_var, PyString_AS_STRING(py_name.o), &v);
+  }
+  return CIP_OK;
+}
+
 //-------------------------------------------------------------------------
 // Converts a Python variable into an IDC variable
 // This function returns on one CIP_XXXX
@@ -691,6 +1047,14 @@ int pyvar_to_idcvar(
 {
   PYW_GIL_CHECK_LOCKED_SCOPE();
 
+  // Common exact types
+  if ( py_var != NULL )
+  {
+    pyvar_fast_cvt_t fast_cvt = find_pyvar_fast_cvt(Py_TYPE(py_var.o));
+    if ( fast_cvt != NULL )
+      return fast_cvt(py_var.o, idc_var, gvar_sn);
+  }
+
   // None / NULL
   if ( py_var == NULL || py_var.o == Py_None )
   {
@@ -726,42 +1090,7 @@ int pyvar_to_idcvar(
   // Python list?
   else if ( PyList_CheckExact(py_var.o) || PyW_IsSequenceType(py_var.o) )
   {
-    // Create the object
-    VarObject(idc_var);
-
-    // Determine list size and type
-    bool is_seq = !PyList_CheckExact(py_var.o);
-    Py_ssize_t size = is_seq ? PySequence_Size(py_var.o) : PyList_Size(py_var.o);
-    bool ok = true;
-    qstring attr_name;
-
-    // Convert each item
-    for ( Py_ssize_t i=0; i<size; i++ )
-    {
-      // Get the item
-      ref_t py_item;
-      if ( is_seq )
-        py_item = newref_t(PySequence_GetItem(py_var.o, i));
-      else
-        py_item = borref_t(PyList_GetItem(py_var.o, i));
-
-      // Convert the item into an IDC variable
-      idc_value_t v;
-      ok = pyvar_to_idcvar(py_item, &v, gvar_sn) >= CIP_OK;
-      if ( ok )
-      {
-        // Form the attribute name
-        newref_t py_int(PyInt_FromSsize_t(i));
-        ok = PyW_ObjectToString(py_int.o, &attr_name);
-        if ( !ok )
-          break;
-        // Store the attribute
-        VarSetAttr(idc_var, attr_name.c_str(), &v);
-      }
-      if ( !ok )
-        break;
-    }
-    return ok ? CIP_OK : CIP_FAILED;
+    return pyvar_seq_to_idcvar(py_var.o, idc_var, gvar_sn);
   }
   // Dictionary: we convert to an IDC object
   else if ( PyDict_Check(py_var.o) )
@@ -871,6 +1200,11 @@ int pyvar_to_idcvar(
       // Other objects
       //
     default:
+      // A new-style instance with a cached conversion plan?
+      const pyvar_cvt_plan_t *plan = get_pyvar_cvt_plan(py_var.o);
+      if ( plan != NULL )
+        return pyvar_obj_to_idcvar(py_var.o, *plan, idc_var, gvar_sn);
+
       // A normal object?
       newref_t py_dir(PyObject_Dir(py_var.o));
       Py_ssize_t size = PyList_Size(py_dir.o);
@@ -885,15 +1219,9 @@ int pyvar_to_idcvar(
         if ( field_name == NULL )
           continue;
 
-        size_t len = strlen(field_name);
-
         // Skip private attributes
-        if ( (len > 2 )
-          && (strncmp(field_name, "__", 2) == 0 )
-          && (strncmp(field_name+len-2, "__", 2) == 0) )
-        {
+        if ( is_private_attr_name(field_name) )
           continue;
-        }
 
         idc_value_t v;
         // Get the non-private attribute from the object
@@ -1219,6 +1547,7 @@ static const char S_ON_POPUP_MENU[]          = "OnPopupMenu";
 static const char S_ON_EDIT_LINE[]           = "OnEditLine";
 static const char S_ON_INSERT_LINE[]         = "OnInsertLine";
 static const char S_ON_GET_LINE[]            = "OnGetLine";
+static const char S_ON_GET_LINES[]           = "OnGetLines";
 static const char S_ON_DELETE_LINE[]         = "OnDeleteLine";
 static const char S_ON_REFRESH[]             = "OnRefresh";
 static const char S_ON_REFRESHED[]           = "OnRefreshed";
@@ -1416,6 +1745,9 @@ void deinit_pywraps()
   {
     PYW_GIL_CHECK_LOCKED_SCOPE();
     py_cvt_helper_module = ref_t(); // Deref.
+    clear_pyvar_cvt_plans();
+    dbgmem_cache_term();
+    dbg_reg_snapshots_term();
   }
 
   // Unregister the IDC PyInvoke0 method (helper function for add_idc_hotkey())
@@ -1802,6 +2134,137 @@ void *pyobj_get_clink(PyObject *pyobj)
   return t;
 }
 
+//-------------------------------------------------------------------------
+// Latency statistics of the hook dispatchers, per hook class and
+// notification code. The histograms use power of two buckets:
+// bucket #i counts the calls that took less than 2^i microseconds
+// (and at least 2^(i-1)); the last bucket is unbounded.
+#define HOOK_STATS_BUCKETS 24
+struct hook_latency_t
+{
+  uint64 count;
+  uint64 total_ns;
+  uint64 max_ns;
+  uint64 gil_total_ns;
+  uint64 gil_max_ns;
+  uint32 buckets[HOOK_STATS_BUCKETS];
+  uint32 gil_buckets[HOOK_STATS_BUCKETS];
+  hook_latency_t() { memset(this, 0, sizeof(*this)); }
+};
+typedef std::map<int, hook_latency_t> hook_latency_map_t;
+static hook_latency_map_t hook_stats[PYW_HOOK_LAST];
+static bool hook_stats_enabled = false;
+static const char *const hook_class_names[PYW_HOOK_LAST] =
+{
+  "IDP", "IDB", "DBG", "UI", "Choose2"
+};
+
+//-------------------------------------------------------------------------
+static int get_hook_latency_bucket(uint64 ns)
+{
+  uint64 us = ns / 1000;
+  int b = 0;
+  while ( us != 0 && b < HOOK_STATS_BUCKETS-1 )
+  {
+    us >>= 1;
+    b++;
+  }
+  return b;
+}
+
+//-------------------------------------------------------------------------
+bool PyW_HookStatsEnabled()
+{
+  return hook_stats_enabled;
+}
+
+//-------------------------------------------------------------------------
+// Called with the GIL held
+void PyW_RecordHookLatency(
+        pyw_hook_class_t hclass,
+        int code,
+        uint64 total_ns,
+        uint64 gil_ns)
+{
+  hook_latency_t &h = hook_stats[hclass][code];
+  h.count++;
+  h.total_ns += total_ns;
+  h.gil_total_ns += gil_ns;
+  if ( total_ns > h.max_ns )
+    h.max_ns = total_ns;
+  if ( gil_ns > h.gil_max_ns )
+    h.gil_max_ns = gil_ns;
+  h.buckets[get_hook_latency_bucket(total_ns)]++;
+  h.gil_buckets[get_hook_latency_bucket(gil_ns)]++;
+}
+
+//-------------------------------------------------------------------------
+// Returns the function behind a (bound or unbound) method
+static PyObject *get_method_function(PyObject *py_meth)
+{
+  return PyMethod_Check(py_meth) ? PyMethod_GET_FUNCTION(py_meth) : py_meth;
+}
+
+//-------------------------------------------------------------------------
+void hook_event_mask_t::compute(
+        PyObject *self,
+        const char *clsname,
+        const pyw_hook_event_t *events,
+        size_t nevents)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  all = true;
+  codes.qclear();
+  if ( self == NULL )
+    return;
+
+  ref_t py_base(get_idaapi_attr(clsname));
+  if ( py_base == NULL )
+  {
+    PyErr_Clear();
+    return;
+  }
+
+  for ( size_t i=0; i < nevents; i++ )
+  {
+    const pyw_hook_event_t &e = events[i];
+    newref_t py_meth(PyObject_GetAttrString(self, e.method));
+    newref_t py_base_meth(PyObject_GetAttrString(py_base.o, e.method));
+    PyErr_Clear();
+
+    // Keep the event unless the method is surely the default one
+    if ( py_meth != NULL
+      && py_base_meth != NULL
+      && get_method_function(py_meth.o) == get_method_function(py_base_meth.o) )
+    {
+      continue;
+    }
+    if ( size_t(e.code) >= codes.size() )
+      codes.resize(e.code + 1, 0);
+    codes[e.code] = 1;
+  }
+  all = false;
+}
+
+//-------------------------------------------------------------------------
+static PyObject *hook_buckets_to_tuple(const uint32 *buckets)
+{
+  PyObject *py_tuple = PyTuple_New(HOOK_STATS_BUCKETS);
+  if ( py_tuple == NULL )
+    return NULL;
+  for ( int i=0; i < HOOK_STATS_BUCKETS; i++ )
+  {
+    PyObject *py_count = PyInt_FromLong(long(buckets[i]));
+    if ( py_count == NULL )
+    {
+      Py_DECREF(py_tuple);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(py_tuple, i, py_count);
+  }
+  return py_tuple;
+}
+
 
 
 //------------------------------------------------------------------------
@@ -2839,6 +3302,93 @@ def enable_extlang_python(enable):
 void enable_extlang_python(bool enable);
 void enable_python_cli(bool enable);
 
+/*
+#<pydoc>
+def get_code_cache_stats():
+    """
+    Returns the statistics of the cache of compiled expressions used
+    when Python is the IDC extlang (see CODE_CACHE_SIZE in python.cfg)
+
+    @return: tuple(hits, misses, count, max_count)
+    """
+    pass
+#</pydoc>
+*/
+PyObject *get_code_cache_stats();
+
+/*
+#<pydoc>
+def clear_code_cache():
+    """
+    Empties the cache of compiled expressions and resets its statistics
+    @return: None
+    """
+    pass
+#</pydoc>
+*/
+void clear_code_cache();
+
+/*
+#<pydoc>
+def set_code_cache_size(size):
+    """
+    Changes the maximum number of cached compiled expressions
+
+    @param size: The new size. Zero disables the cache.
+    @return: Returns the old size
+    """
+    pass
+#</pydoc>
+*/
+int set_code_cache_size(int size);
+
+/*
+#<pydoc>
+def profiler_start(interval_ms=0):
+    """
+    Starts the sampling profiler.
+    Samples of the main thread's frame stack are taken every 'interval_ms'
+    milliseconds. The time spent in native functions (for example in _idaapi)
+    is reported separately from the time spent in Python code.
+    This function must be called from the main thread.
+
+    The samples are taken by the main thread itself, between two bytecodes.
+    This biases the results: a single slow bytecode (a long string
+    concatenation, an operation on a big list or dict, ...) counts as one
+    sample at most, however long it takes. Calls to native functions are
+    timed instead, so they are not affected. The main thread is not
+    sampled while other Python threads hold the GIL.
+
+    @param interval_ms: Interval between two samples.
+                        Zero selects PROFILER_INTERVAL from python.cfg
+    @return: False if the profiler is already running
+    """
+    pass
+#</pydoc>
+*/
+bool profiler_start(int interval_ms = 0);
+
+/*
+#<pydoc>
+def profiler_stop(path=None):
+    """
+    Stops the sampling profiler.
+
+    @param path: If specified, the samples are written to this file as
+                 collapsed stacks ("outer;inner count" lines), which can be
+                 fed to flame graph tools
+    @return: None if the profiler was not running, otherwise a dictionary:
+             - 'python': number of samples in Python code
+             - 'native': number of samples in native functions
+             - 'functions': { "name (file:line)": (self, total) }
+             - 'lines': { "file:line": samples }
+             - 'native_calls': { native_function_name: samples }
+    """
+    pass
+#</pydoc>
+*/
+PyObject *profiler_stop(const char *path = NULL);
+
 /*
 #<pydoc>
 def RunPythonStatement(stmt):
@@ -2852,6 +3402,152 @@ def RunPythonStatement(stmt):
 #</pydoc>
 */
 
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def enable_hook_stats(enable):
+    """
+    Enables or disables the latency statistics of the hook dispatchers
+    (IDP_Hooks, IDB_Hooks, DBG_Hooks, UI_Hooks and Choose2 item attributes).
+    When enabled, the time spent in each notification, including the time
+    spent waiting for the GIL, is recorded per hook class and notification code.
+
+    @param enable: True to enable, False to disable
+    @return: The previous state
+    """
+    pass
+#</pydoc>
+*/
+static bool enable_hook_stats(bool enable)
+{
+  qswap(enable, hook_stats_enabled);
+  return enable;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def reset_hook_stats():
+    """
+    Clears the latency statistics of the hook dispatchers
+    @return: None
+    """
+    pass
+#</pydoc>
+*/
+static void reset_hook_stats()
+{
+  for ( int i=0; i < PYW_HOOK_LAST; i++ )
+    hook_stats[i].clear();
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def get_hook_stats():
+    """
+    Returns the latency statistics of the hook dispatchers.
+    Durations are in nanoseconds. The histograms have 24 buckets: bucket #i
+    counts the notifications that took less than 2^i microseconds.
+
+    @return: A list of tuples:
+             (hook_class, code, count, total, max, gil_total, gil_max, histogram, gil_histogram)
+             where hook_class is one of "IDP", "IDB", "DBG", "UI", "Choose2"
+    """
+    pass
+#</pydoc>
+*/
+static PyObject *get_hook_stats()
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  newref_t py_list(PyList_New(0));
+  if ( py_list == NULL )
+    return NULL;
+
+  for ( int i=0; i < PYW_HOOK_LAST; i++ )
+  {
+    const hook_latency_map_t &m = hook_stats[i];
+    for ( hook_latency_map_t::const_iterator it=m.begin(); it != m.end(); ++it )
+    {
+      const hook_latency_t &h = it->second;
+      newref_t py_buckets(hook_buckets_to_tuple(h.buckets));
+      if ( py_buckets == NULL )
+        return NULL;
+      newref_t py_gil_buckets(hook_buckets_to_tuple(h.gil_buckets));
+      if ( py_gil_buckets == NULL )
+        return NULL;
+      newref_t py_item(Py_BuildValue("(siKKKKKOO)",
+                                     hook_class_names[i],
+                                     it->first,
+                                     (unsigned PY_LONG_LONG)h.count,
+                                     (unsigned PY_LONG_LONG)h.total_ns,
+                                     (unsigned PY_LONG_LONG)h.max_ns,
+                                     (unsigned PY_LONG_LONG)h.gil_total_ns,
+                                     (unsigned PY_LONG_LONG)h.gil_max_ns,
+                                     py_buckets.o,
+                                     py_gil_buckets.o));
+      if ( py_item == NULL || PyList_Append(py_list.o, py_item.o) != 0 )
+        return NULL;
+    }
+  }
+  py_list.incref();
+  return py_list.o;
+}
+
+//-------------------------------------------------------------------------
+/*
+#<pydoc>
+def dump_hook_stats(path):
+    """
+    Writes the latency statistics of the hook dispatchers to a CSV file.
+    Durations are in microseconds.
+
+    @param path: The output file name
+    @return: Boolean
+    """
+    pass
+#</pydoc>
+*/
+static bool dump_hook_stats(const char *path)
+{
+  FILE *fp = qfopen(path, "w");
+  if ( fp == NULL )
+    return false;
+
+  qfprintf(fp, "class,code,count,total_us,avg_us,max_us,gil_total_us,gil_max_us");
+  for ( int b=0; b < HOOK_STATS_BUCKETS; b++ )
+  {
+    if ( b == HOOK_STATS_BUCKETS-1 )
+      qfprintf(fp, ",ge_%uus", 1u << (b-1));
+    else
+      qfprintf(fp, ",lt_%uus", 1u << b);
+  }
+  qfprintf(fp, "\n");
+
+  for ( int i=0; i < PYW_HOOK_LAST; i++ )
+  {
+    const hook_latency_map_t &m = hook_stats[i];
+    for ( hook_latency_map_t::const_iterator it=m.begin(); it != m.end(); ++it )
+    {
+      const hook_latency_t &h = it->second;
+      qfprintf(fp, "%s,%d,%" FMT_64 "u,%.3f,%.3f,%.3f,%.3f,%.3f",
+               hook_class_names[i],
+               it->first,
+               h.count,
+               h.total_ns / 1000.0,
+               h.count == 0 ? 0.0 : h.total_ns / 1000.0 / h.count,
+               h.max_ns / 1000.0,
+               h.gil_total_ns / 1000.0,
+               h.gil_max_ns / 1000.0);
+      for ( int b=0; b < HOOK_STATS_BUCKETS; b++ )
+        qfprintf(fp, ",%u", h.buckets[b]);
+      qfprintf(fp, "\n");
+    }
+  }
+  qfclose(fp);
+  return true;
+}
+
 /*
 //---------------------------------------------------------------------------
 // qstrvec_t wrapper
@@ -1081,6 +1081,9 @@ int choose2_create(PyObject *self, bool embedded);
 void choose2_activate(PyObject *self);
 PyObject *choose2_get_embedded(PyObject *self);
 PyObject *choose2_get_embedded_selection(PyObject *self);
+PyObject *choose2_set_table(PyObject *self, PyObject *table);
+bool choose2_sort(PyObject *self, int col, bool descending);
+bool choose2_filter(PyObject *self, const char *text, int col);
 
 
 #define DECLARE_FORM_ACTIONS form_actions_t *fa = (form_actions_t *)p_fa;
@@ -1442,7 +1445,7 @@ static size_t py_get_AskUsingForm()
 int idaapi UI_Callback(void *ud, int notification_code, va_list va)
 {
   // This hook gets called from the kernel. Ensure we hold the GIL.
-  PYW_GIL_GET;
+  PYW_GIL_GET_HOOK(PYW_HOOK_UI, notification_code);
   UI_Hooks *proxy = (UI_Hooks *)ud;
   int ret = 0;
   try
@@ -1531,6 +1534,7 @@ bool idaapi py_menu_item_callback(void *userdata)
 // Some defines
 #define POPUP_NAMES_COUNT 4
 #define MAX_CHOOSER_MENU_COMMANDS 20
+#define CHOOSE2_ROWS_PER_BLOCK 128
 #define thisobj ((py_choose2_t *) obj)
 #define thisdecl py_choose2_t *_this = thisobj
 #define MENU_COMMAND_CB(id) \
@@ -1563,6 +1567,306 @@ void choose2_del_instance(PyObject *self)
     choosers.erase(it);
 }
 
+//------------------------------------------------------------------------
+// Columnar table owned by a chooser. Its rows are displayed, sorted and
+// filtered without calling Python.
+class chooser_table_t
+{
+  struct column_t
+  {
+    enum { STR, INT, UINT, DBL };
+    int kind;
+    bool hex;
+    qvector<int64> ints;      // INT and UINT values
+    qvector<double> dbls;     // DBL values
+    qvector<char> chars;      // STR values, as consecutive NUL-terminated strings
+    qvector<uint32> offs;     // offsets of the STR values in 'chars'
+
+    const char *str(int row) const { return &chars[offs[row]]; }
+  };
+  qvector<column_t> columns;
+  size_t nrows;
+
+  // Displayed rows -> table rows
+  intvec_t view;
+  int sort_col;
+  bool sort_desc;
+  qstring filter;
+  int filter_col;
+
+  struct row_less_t
+  {
+    const column_t &col;
+    row_less_t(const column_t &c) : col(c) {}
+    bool operator()(int a, int b) const
+    {
+      switch ( col.kind )
+      {
+        case column_t::STR:  return stricmp(col.str(a), col.str(b)) < 0;
+        case column_t::INT:  return col.ints[a] < col.ints[b];
+        case column_t::UINT: return uint64(col.ints[a]) < uint64(col.ints[b]);
+        default:             return col.dbls[a] < col.dbls[b];
+      }
+    }
+  };
+  struct row_greater_t : public row_less_t
+  {
+    row_greater_t(const column_t &c) : row_less_t(c) {}
+    bool operator()(int a, int b) const { return row_less_t::operator()(b, a); }
+  };
+
+  static bool load_array(column_t *col, PyObject *py_arr, qstring *errbuf)
+  {
+    ref_t py_code(PyW_TryGetAttrString(py_arr, "typecode"));
+    const char *code = py_code == NULL ? NULL : PyString_AsString(py_code.o);
+    const void *buf;
+    Py_ssize_t len;
+    if ( code == NULL || PyObject_AsReadBuffer(py_arr, &buf, &len) != 0 )
+    {
+      PyErr_Clear();
+      *errbuf = "columns must be lists or arrays";
+      return false;
+    }
+
+#define LOAD_ARRAY(T, vec)                        \
+    do                                            \
+    {                                             \
+      const T *p = (const T *)buf;                \
+      size_t n = len / sizeof(T);                 \
+      col->vec.resize(n);                         \
+      for ( size_t k = 0; k < n; k++ )            \
+        col->vec[k] = p[k];                       \
+    } while ( false )
+    switch ( *code )
+    {
+      case 'b': col->kind = column_t::INT;  LOAD_ARRAY(signed char, ints);    break;
+      case 'B': col->kind = column_t::UINT; LOAD_ARRAY(unsigned char, ints);  break;
+      case 'h': col->kind = column_t::INT;  LOAD_ARRAY(short, ints);          break;
+      case 'H': col->kind = column_t::UINT; LOAD_ARRAY(unsigned short, ints); break;
+      case 'i': col->kind = column_t::INT;  LOAD_ARRAY(int, ints);            break;
+      case 'I': col->kind = column_t::UINT; LOAD_ARRAY(unsigned int, ints);   break;
+      case 'l': col->kind = column_t::INT;  LOAD_ARRAY(long, ints);           break;
+      case 'L': col->kind = column_t::UINT; LOAD_ARRAY(unsigned long, ints);  break;
+      case 'f': col->kind = column_t::DBL;  LOAD_ARRAY(float, dbls);          break;
+      case 'd': col->kind = column_t::DBL;  LOAD_ARRAY(double, dbls);         break;
+      default:
+        errbuf->sprnt("unsupported array type '%s'", code);
+        return false;
+    }
+#undef LOAD_ARRAY
+    return true;
+  }
+
+  static bool load_list(column_t *col, PyObject *py_list, qstring *errbuf)
+  {
+    newref_t seq(PySequence_Fast(py_list, "columns must be lists or arrays"));
+    if ( seq == NULL )
+    {
+      PyErr_Clear();
+      *errbuf = "columns must be lists or arrays";
+      return false;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq.o);
+    PyObject **items = PySequence_Fast_ITEMS(seq.o);
+
+    // Numbers are kept as such if the column only contains numbers
+    bool numbers = n > 0;
+    bool negative = false;
+    for ( Py_ssize_t i = 0; numbers && i < n; i++ )
+    {
+      if ( PyInt_Check(items[i]) )
+        negative |= PyInt_AS_LONG(items[i]) < 0;
+      else if ( PyLong_Check(items[i]) )
+        negative |= _PyLong_Sign(items[i]) < 0;
+      else
+        numbers = false;
+    }
+    if ( numbers )
+    {
+      col->kind = negative ? column_t::INT : column_t::UINT;
+      col->ints.resize(n);
+      for ( Py_ssize_t i = 0; i < n; i++ )
+      {
+        col->ints[i] = negative
+                     ? PyLong_AsLongLong(items[i])
+                     : int64(PyInt_AsUnsignedLongLongMask(items[i]));
+      }
+      if ( PyErr_Occurred() )
+      {
+        PyErr_Clear();
+        *errbuf = "integer value out of range";
+        return false;
+      }
+      return true;
+    }
+
+    col->kind = column_t::STR;
+    col->offs.resize(n);
+    for ( Py_ssize_t i = 0; i < n; i++ )
+    {
+      newref_t py_str(PyObject_Str(items[i]));
+      const char *str = py_str == NULL ? NULL : PyString_AsString(py_str.o);
+      if ( str == NULL )
+      {
+        PyErr_Clear();
+        str = "";
+      }
+      size_t off = col->chars.size();
+      size_t len = strlen(str) + 1;
+      col->offs[i] = uint32(off);
+      col->chars.resize(off + len);
+      memcpy(&col->chars[off], str, len);
+    }
+    return true;
+  }
+
+  size_t column_size(const column_t &col) const
+  {
+    switch ( col.kind )
+    {
+      case column_t::STR: return col.offs.size();
+      case column_t::DBL: return col.dbls.size();
+      default:            return col.ints.size();
+    }
+  }
+
+  bool match_filter(int row) const
+  {
+    char buf[MAXSTR];
+    for ( size_t i = 0; i < columns.size(); i++ )
+    {
+      if ( filter_col >= 0 && size_t(filter_col) != i )
+        continue;
+      get_cell(row, i, buf, sizeof(buf));
+      if ( stristr(buf, filter.c_str()) != NULL )
+        return true;
+    }
+    return false;
+  }
+
+  void update_view()
+  {
+    view.qclear();
+    view.reserve(nrows);
+    for ( size_t i = 0; i < nrows; i++ )
+    {
+      if ( filter.empty() || match_filter(int(i)) )
+        view.push_back(int(i));
+    }
+    if ( sort_col >= 0 && size_t(sort_col) < columns.size() )
+    {
+      const column_t &col = columns[sort_col];
+      if ( sort_desc )
+        std::stable_sort(view.begin(), view.end(), row_greater_t(col));
+      else
+        std::stable_sort(view.begin(), view.end(), row_less_t(col));
+    }
+  }
+
+public:
+  chooser_table_t() : nrows(0), sort_col(-1), sort_desc(false), filter_col(-1) {}
+
+  // Copies the columns (a list of lists or array.array objects)
+  bool init(PyObject *py_table, const intvec_t &widths, qstring *errbuf)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t seq(PySequence_Fast(py_table, "the table must be a list of columns"));
+    if ( seq == NULL )
+    {
+      PyErr_Clear();
+      *errbuf = "the table must be a list of columns";
+      return false;
+    }
+    Py_ssize_t ncols = PySequence_Fast_GET_SIZE(seq.o);
+    if ( size_t(ncols) < widths.size() )
+    {
+      errbuf->sprnt("the table has %d columns, %d expected", int(ncols), int(widths.size()));
+      return false;
+    }
+    ncols = widths.size();
+
+    qvector<column_t> cols;
+    cols.resize(ncols);
+    for ( Py_ssize_t i = 0; i < ncols; i++ )
+    {
+      PyObject *py_col = PySequence_Fast_GET_ITEM(seq.o, i);
+      column_t &col = cols[i];
+      col.hex = (widths[i] & CHCOL_FORMAT) == CHCOL_HEX;
+      bool ok = PyList_Check(py_col) || PyTuple_Check(py_col)
+              ? load_list(&col, py_col, errbuf)
+              : load_array(&col, py_col, errbuf);
+      if ( !ok )
+        return false;
+      if ( i > 0 && column_size(col) != column_size(cols[0]) )
+      {
+        *errbuf = "all the columns must have the same length";
+        return false;
+      }
+    }
+    columns.swap(cols);
+    nrows = columns.empty() ? 0 : column_size(columns[0]);
+    update_view();
+    return true;
+  }
+
+  size_t size() const
+  {
+    return view.size();
+  }
+
+  // Displayed row -> table row (both 0-based)
+  int get_row(int n) const
+  {
+    return n >= 0 && size_t(n) < view.size() ? view[n] : n;
+  }
+
+  // Table row -> displayed row, -1 if filtered out
+  int find_view(int row) const
+  {
+    for ( size_t i = 0; i < view.size(); i++ )
+      if ( view[i] == row )
+        return int(i);
+    return -1;
+  }
+
+  void get_cell(int row, size_t colidx, char *buf, size_t bufsize) const
+  {
+    const column_t &col = columns[colidx];
+    switch ( col.kind )
+    {
+      case column_t::STR:
+        qstrncpy(buf, col.str(row), bufsize);
+        break;
+      case column_t::INT:
+        qsnprintf(buf, bufsize, "%" FMT_64 "d", col.ints[row]);
+        break;
+      case column_t::UINT:
+        qsnprintf(buf, bufsize, col.hex ? "%" FMT_64 "X" : "%" FMT_64 "u", uint64(col.ints[row]));
+        break;
+      default:
+        qsnprintf(buf, bufsize, "%g", col.dbls[row]);
+        break;
+    }
+  }
+
+  // Displays the rows sorted by the given column (-1: table order)
+  void sort(int col, bool descending)
+  {
+    sort_col = col;
+    sort_desc = descending;
+    update_view();
+  }
+
+  // Displays the rows that contain the text (case insensitive) in the
+  // given column (-1: in any column)
+  void set_filter(const char *text, int col)
+  {
+    filter = text == NULL ? "" : text;
+    filter_col = col;
+    update_view();
+  }
+};
+
 //------------------------------------------------------------------------
 class py_choose2_t
 {
@@ -1580,7 +1884,25 @@ private:
     CHOOSE2_HAVE_ONCLOSE   = 0x0100,
     CHOOSE2_HAVE_SELECT    = 0x0200,
     CHOOSE2_HAVE_REFRESHED = 0x0400,
+    CHOOSE2_HAVE_GETLINE   = 0x0800,
+    CHOOSE2_HAVE_GETLINES  = 0x1000,
+    CHOOSE2_HAVE_GETSIZE   = 0x2000,
+  };
+
+  // A row returned by OnGetLines()
+  struct cached_row_t
+  {
+    enum { ATTR_UNKNOWN, ATTR_NONE, ATTR_SET };
+    qstrvec_t cells;
+    int attr_state;
+    int color;
+    int attr_flags;
+    cached_row_t() : attr_state(ATTR_UNKNOWN), color(0), attr_flags(0) {}
   };
+  typedef qvector<cached_row_t> cached_rows_t;
+  // Block number -> rows of the block
+  typedef std::map<int, cached_rows_t> row_cache_t;
+
   // Chooser flags
   int flags;
 
@@ -1606,6 +1928,13 @@ private:
   const char **popup_names;
   bool ui_cb_hooked;
 
+  // Rows fetched with OnGetLines(), until the next refresh
+  row_cache_t row_cache;
+  ssize_t cached_size;
+
+  // Rows given up front in the 'table' attribute, if any
+  chooser_table_t *table;
+
   // The number of declarations should follow the MAX_CHOOSER_MENU_COMMANDS value
   MENU_COMMAND_CB(0)   MENU_COMMAND_CB(1)
   MENU_COMMAND_CB(2)   MENU_COMMAND_CB(3)
@@ -1624,9 +1953,6 @@ private:
   //------------------------------------------------------------------------
   static int idaapi ui_cb(void *obj, int notification_code, va_list va)
   {
-    // This hook gets called from the kernel. Ensure we hold the GIL.
-    PYW_GIL_GET;
-
     // UI callback to handle chooser items with attributes
     if ( notification_code != ui_get_chooser_item_attrs )
       return 0;
@@ -1638,7 +1964,12 @@ private:
 
     int n = int(va_arg(va, uint32));
     chooser_item_attrs_t *attr = va_arg(va, chooser_item_attrs_t *);
-    thisobj->on_get_line_attr(n, attr);
+    if ( !thisobj->get_cached_line_attr(n, attr) )
+    {
+      // This hook gets called from the kernel. Ensure we hold the GIL.
+      PYW_GIL_GET_HOOK(PYW_HOOK_CHOOSE2, notification_code);
+      thisobj->on_get_line_attr(n, attr);
+    }
     return 1;
   }
 
@@ -1734,11 +2065,161 @@ private:
     }
   }
 
-  void on_get_line(int lineno, char * const *line_arr)
+  //------------------------------------------------------------------------
+  // Row cache: OnGetLines() is asked for whole blocks of rows, which are
+  // then served without calling Python until the chooser is refreshed
+  //------------------------------------------------------------------------
+  bool use_row_cache() const
   {
-    // Called from s_getl, which itself can be called from the kernel. Ensure GIL
-    PYW_GIL_GET;
+    return table == NULL && (cb_flags & CHOOSE2_HAVE_GETLINES) != 0;
+  }
+
+  // Kernel line number (1-based, in display order) -> Python row number
+  int to_row(int lineno) const
+  {
+    return table == NULL ? lineno - 1 : table->get_row(lineno - 1);
+  }
+
+  // Python row number -> kernel line number
+  int to_lineno(int row) const
+  {
+    return table == NULL ? row + 1 : table->find_view(row) + 1;
+  }
+
+  void invalidate_rows()
+  {
+    row_cache.clear();
+    cached_size = -1;
+  }
+
+  void fetch_rows(int start, cached_rows_t *rows)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t py_rows(
+            PyObject_CallMethod(
+                    self,
+                    (char *)S_ON_GET_LINES,
+                    "ii",
+                    start,
+                    CHOOSE2_ROWS_PER_BLOCK));
+    if ( py_rows == NULL )
+      return;
+
+    newref_t seq(PySequence_Fast(py_rows.o, "OnGetLines() must return a list"));
+    if ( seq == NULL )
+      return;
+
+    Py_ssize_t nrows = qmin(PySequence_Fast_GET_SIZE(seq.o), Py_ssize_t(CHOOSE2_ROWS_PER_BLOCK));
+    rows->resize(nrows);
+    for ( Py_ssize_t r = 0; r < nrows; r++ )
+    {
+      cached_row_t &row = (*rows)[r];
+      PyObject *py_cols = PySequence_Fast_GET_ITEM(seq.o, r);
+      PyObject *py_attr = NULL;
+
+      // A row is either [col1, col2, ...] or ([col1, col2, ...], attrs)
+      if ( PyTuple_Check(py_cols)
+        && PyTuple_GET_SIZE(py_cols) == 2
+        && PySequence_Check(PyTuple_GET_ITEM(py_cols, 0))
+        && !PyString_Check(PyTuple_GET_ITEM(py_cols, 0)) )
+      {
+        py_attr = PyTuple_GET_ITEM(py_cols, 1);
+        py_cols = PyTuple_GET_ITEM(py_cols, 0);
+      }
+
+      row.cells.resize(cols.size());
+      newref_t py_cells(PySequence_Fast(py_cols, "OnGetLines() rows must be lists"));
+      if ( py_cells == NULL )
+      {
+        PyErr_Clear();
+        continue;
+      }
+      Py_ssize_t ncells = qmin(PySequence_Fast_GET_SIZE(py_cells.o), Py_ssize_t(cols.size()));
+      for ( Py_ssize_t i = 0; i < ncells; i++ )
+      {
+        const char *str = PyString_AsString(PySequence_Fast_GET_ITEM(py_cells.o, i));
+        if ( str != NULL )
+          row.cells[i] = str;
+        else
+          PyErr_Clear();
+      }
+
+      if ( py_attr != NULL )
+        set_row_attr(&row, py_attr);
+    }
+  }
+
+  static void set_row_attr(cached_row_t *row, PyObject *py_attr)
+  {
+    row->attr_state = cached_row_t::ATTR_NONE;
+    if ( PyList_Check(py_attr) && PyList_Size(py_attr) >= 2 )
+    {
+      row->color = PyInt_AsLong(PyList_GetItem(py_attr, 0));
+      row->attr_flags = PyInt_AsLong(PyList_GetItem(py_attr, 1));
+      // Not integers: the row has no attributes
+      if ( PyErr_Occurred() )
+        PyErr_Clear();
+      else
+        row->attr_state = cached_row_t::ATTR_SET;
+    }
+  }
+
+  cached_row_t *find_cached_row(int n)
+  {
+    row_cache_t::iterator p = row_cache.find(n / CHOOSE2_ROWS_PER_BLOCK);
+    if ( p == row_cache.end() )
+      return NULL;
+    size_t idx = n % CHOOSE2_ROWS_PER_BLOCK;
+    return idx < p->second.size() ? &p->second[idx] : NULL;
+  }
+
+  // Returns the row (0-based), asking Python for its block if needed
+  cached_row_t *get_cached_row(int n)
+  {
+    if ( n < 0 )
+      return NULL;
+    int block = n / CHOOSE2_ROWS_PER_BLOCK;
+    if ( row_cache.find(block) == row_cache.end() )
+    {
+      // Python may refresh the chooser while the rows are fetched:
+      // only insert the block once it is complete
+      PYW_GIL_GET;
+      cached_rows_t rows;
+      fetch_rows(block * CHOOSE2_ROWS_PER_BLOCK, &rows);
+      row_cache[block].swap(rows);
+    }
+    return find_cached_row(n);
+  }
+
+  // Fills the attributes of a cached row without entering Python
+  bool get_cached_line_attr(int lineno, chooser_item_attrs_t *attr)
+  {
+    if ( !use_row_cache() )
+      return false;
+    cached_row_t *row = get_cached_row(lineno - 1);
+    if ( row == NULL )
+      return false;
+    if ( row->attr_state == cached_row_t::ATTR_UNKNOWN )
+    {
+      if ( (cb_flags & CHOOSE2_HAVE_GETATTR) == 0 )
+        return true;
+      PYW_GIL_GET;
+      newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_GET_LINE_ATTR, "i", lineno - 1));
+      row = find_cached_row(lineno - 1);
+      if ( pyres == NULL || row == NULL )
+        return true;
+      set_row_attr(row, pyres.o);
+    }
+    if ( row->attr_state == cached_row_t::ATTR_SET )
+    {
+      attr->color = row->color;
+      attr->flags = row->attr_flags;
+    }
+    return true;
+  }
 
+  void on_get_line(int lineno, char * const *line_arr)
+  {
     // Get headers?
     if ( lineno == 0 )
     {
@@ -1753,6 +2234,30 @@ private:
     for ( int i=ncols-1; i>=0; i-- )
       line_arr[i][0] = '\0';
 
+    if ( table != NULL )
+    {
+      int row = table->get_row(lineno - 1);
+      for ( int i=ncols-1; i>=0; i-- )
+        table->get_cell(row, i, line_arr[i], MAXSTR);
+      return;
+    }
+
+    if ( use_row_cache() )
+    {
+      const cached_row_t *row = get_cached_row(lineno - 1);
+      if ( row != NULL )
+      {
+        for ( int i=ncols-1; i>=0; i-- )
+          qstrncpy(line_arr[i], row->cells[i].c_str(), MAXSTR);
+        return;
+      }
+      if ( (cb_flags & CHOOSE2_HAVE_GETLINE) == 0 )
+        return;
+    }
+
+    // Called from s_getl, which itself can be called from the kernel. Ensure GIL
+    PYW_GIL_GET;
+
     // Call Python
     PYW_GIL_CHECK_LOCKED_SCOPE();
     newref_t list(PyObject_CallMethod(self, (char *)S_ON_GET_LINE, "i", lineno - 1));
@@ -1774,16 +2279,24 @@ private:
 
   size_t on_get_size()
   {
+    if ( table != NULL )
+      return table->size();
+
+    if ( use_row_cache() && cached_size >= 0 )
+      return cached_size;
+
     PYW_GIL_GET;
     newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_GET_SIZE, NULL));
     if ( pyres == NULL )
       return 0;
 
-    return PyInt_AsLong(pyres.o);
+    cached_size = PyInt_AsLong(pyres.o);
+    return cached_size;
   }
 
   void on_refreshed()
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_REFRESHED, NULL));
   }
@@ -1791,7 +2304,13 @@ private:
   void on_select(const intvec_t &intvec)
   {
     PYW_GIL_GET;
-    ref_t py_list(PyW_IntVecToPyList(intvec));
+    intvec_t rows = intvec;
+    if ( table != NULL )
+    {
+      for ( size_t i = 0; i < rows.size(); i++ )
+        rows[i] = to_row(rows[i]);
+    }
+    ref_t py_list(PyW_IntVecToPyList(rows));
     newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_SELECT, "O", py_list.o));
   }
 
@@ -1807,30 +2326,33 @@ private:
 
   int on_delete_line(int lineno)
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(
             PyObject_CallMethod(
                     self,
                     (char *)S_ON_DELETE_LINE,
                     "i",
-                    lineno - 1));
-    return pyres == NULL ? lineno : PyInt_AsLong(pyres.o) + 1;
+                    to_row(lineno)));
+    return pyres == NULL ? lineno : to_lineno(PyInt_AsLong(pyres.o));
   }
 
   int on_refresh(int lineno)
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(
             PyObject_CallMethod(
                     self,
                     (char *)S_ON_REFRESH,
                     "i",
-                    lineno - 1));
-    return pyres == NULL ? lineno : PyInt_AsLong(pyres.o) + 1;
+                    to_row(lineno)));
+    return pyres == NULL ? lineno : to_lineno(PyInt_AsLong(pyres.o));
   }
 
   void on_insert_line()
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_INSERT_LINE, NULL));
   }
@@ -1843,29 +2365,31 @@ private:
                     self,
                     (char *)S_ON_SELECT_LINE,
                     "i",
-                    lineno - 1));
+                    to_row(lineno)));
   }
 
   void on_edit_line(int lineno)
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(
             PyObject_CallMethod(
                     self,
                     (char *)S_ON_EDIT_LINE,
                     "i",
-                    lineno - 1));
+                    to_row(lineno)));
   }
 
   int on_command(int cmd_id, int lineno)
   {
+    invalidate_rows();
     PYW_GIL_GET;
     newref_t pyres(
             PyObject_CallMethod(
                     self,
                     (char *)S_ON_COMMAND,
                     "ii",
-                    lineno - 1,
+                    to_row(lineno),
                     cmd_id));
     return pyres == NULL ? lineno : PyInt_AsLong(pyres.o);
   }
@@ -1878,14 +2402,14 @@ private:
                     self,
                     (char *)S_ON_GET_ICON,
                     "i",
-                    lineno - 1));
+                    to_row(lineno)));
     return PyInt_AsLong(pyres.o);
   }
 
   void on_get_line_attr(int lineno, chooser_item_attrs_t *attr)
   {
     PYW_GIL_GET;
-    newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_GET_LINE_ATTR, "i", lineno - 1));
+    newref_t pyres(PyObject_CallMethod(self, (char *)S_ON_GET_LINE_ATTR, "i", to_row(lineno)));
     if ( pyres != NULL )
     {
       if ( PyList_Check(pyres.o) )
@@ -1905,7 +2429,8 @@ public:
   //------------------------------------------------------------------------
   py_choose2_t(): flags(0), cb_flags(0),
                   embedded(NULL), menu_cb_idx(0),
-                  self(NULL), popup_names(NULL), ui_cb_hooked(false)
+                  self(NULL), popup_names(NULL), ui_cb_hooked(false),
+                  cached_size(-1), table(NULL)
   {
   }
 
@@ -1918,6 +2443,7 @@ public:
     install_hooks(false);
 
     delete embedded;
+    delete table;
     Py_XDECREF(self);
     clear_popup_names();
   }
@@ -2058,11 +2584,27 @@ public:
       widths.push_back(width);
     }
 
+    // Get the table, if the rows are given up front
+    ref_t table_attr(PyW_TryGetAttrString(self, "table"));
+    if ( table_attr != NULL && table_attr.o != Py_None )
+    {
+      qstring errbuf;
+      table = new chooser_table_t();
+      if ( !table->init(table_attr.o, widths, &errbuf) )
+      {
+        msg("Choose2: %s\n", errbuf.c_str());
+        return -1;
+      }
+    }
+
     // Get *deflt
     int deflt = -1;
     ref_t deflt_attr(PyW_TryGetAttrString(self, "deflt"));
     if ( deflt_attr != NULL )
       deflt = PyInt_AsLong(deflt_attr.o);
+    // *deflt is a 1-based row number: map it to its displayed line
+    if ( deflt > 0 )
+      deflt = to_lineno(deflt - 1);
 
     // Get *icon
     int icon = -1;
@@ -2089,9 +2631,10 @@ public:
       unsigned int have; // 0 = mandatory callback
     } callbacks[] =
     {
-      {S_ON_GET_SIZE,      0},
-      {S_ON_GET_LINE,      0},
       {S_ON_CLOSE,         0},
+      {S_ON_GET_SIZE,         CHOOSE2_HAVE_GETSIZE},
+      {S_ON_GET_LINE,         CHOOSE2_HAVE_GETLINE},
+      {S_ON_GET_LINES,        CHOOSE2_HAVE_GETLINES},
       {S_ON_EDIT_LINE,        CHOOSE2_HAVE_EDIT},
       {S_ON_INSERT_LINE,      CHOOSE2_HAVE_INS},
       {S_ON_DELETE_LINE,      CHOOSE2_HAVE_DEL},
@@ -2120,6 +2663,14 @@ public:
       }
     }
 
+    // Without a table, the rows come from Python: either row provider will do
+    if ( table == NULL
+      && ((cb_flags & CHOOSE2_HAVE_GETSIZE) == 0
+       || (cb_flags & (CHOOSE2_HAVE_GETLINE|CHOOSE2_HAVE_GETLINES)) == 0) )
+    {
+      return -1;
+    }
+
     // Get *popup names
     // An array of 4 strings: ("Insert", "Delete", "Edit", "Refresh"
     ref_t pn_attr(PyW_TryGetAttrString(self, S_POPUP_NAMES));
@@ -2136,8 +2687,10 @@ public:
     }
 
     // Adjust flags (if needed)
-    if ( (cb_flags & CHOOSE2_HAVE_GETATTR) != 0 )
+    // (OnGetLines() may return the row attributes along with the row)
+    if ( (cb_flags & (CHOOSE2_HAVE_GETATTR|CHOOSE2_HAVE_GETLINES)) != 0 )
       flags |= CH_ATTRS;
+    invalidate_rows();
 
     // Increase object reference
     Py_INCREF(self);
@@ -2213,8 +2766,9 @@ public:
       clear_popup_names();
 
       // Modal chooser return the index of the selected item
+      // (to_row() gives -1 if it was cancelled)
       if ( is_modal() )
-        r--;
+        r = to_row(r);
     }
     // Embedded chooser?
     else
@@ -2233,6 +2787,7 @@ public:
 
   void refresh()
   {
+    invalidate_rows();
     refresh_chooser(title.c_str());
   }
 
@@ -2246,10 +2801,53 @@ public:
     return &embedded_sel;
   }
 
+  // The selection of the embedded chooser as 0-based Python row numbers
+  void get_selected_rows(intvec_t *rows) const
+  {
+    *rows = embedded_sel;
+    for ( size_t i = 0; i < rows->size(); i++ )
+      (*rows)[i] = to_row((*rows)[i]);
+  }
+
   chooser_info_t *get_embedded() const
   {
     return embedded;
   }
+
+  PyObject *set_table(PyObject *py_table)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    qstring errbuf;
+    chooser_table_t *t = new chooser_table_t();
+    if ( !t->init(py_table, widths, &errbuf) )
+    {
+      delete t;
+      PyErr_SetString(PyExc_ValueError, errbuf.c_str());
+      return NULL;
+    }
+    delete table;
+    table = t;
+    refresh();
+    Py_RETURN_TRUE;
+  }
+
+  bool sort_table(int col, bool descending)
+  {
+    if ( table == NULL )
+      return false;
+    table->sort(col, descending);
+    refresh();
+    return true;
+  }
+
+  bool filter_table(const char *text, int col)
+  {
+    if ( table == NULL )
+      return false;
+    table->set_filter(text, col);
+    refresh();
+    return true;
+  }
 };
 
 //------------------------------------------------------------------------
@@ -2272,6 +2870,7 @@ chooser_cb_t *py_choose2_t::menu_cbs[MAX_CHOOSER_MENU_COMMANDS] =
 
 #undef POPUP_NAMES_COUNT
 #undef MAX_CHOOSER_MENU_COMMANDS
+#undef CHOOSE2_ROWS_PER_BLOCK
 #undef thisobj
 #undef thisdecl
 #undef MENU_COMMAND_CB
@@ -2355,14 +2954,10 @@ PyObject *choose2_get_embedded_selection(PyObject *self)
   if ( c2 == NULL || (embedded = c2->get_embedded()) == NULL )
     Py_RETURN_NONE;
 
-  // Returned as 1-based
-  intvec_t &intvec = *c2->get_sel_vec();
-
-  // Make 0-based
-  for ( intvec_t::iterator it=intvec.begin(); it != intvec.end(); ++it)
-    (*it)--;
+  intvec_t rows;
+  c2->get_selected_rows(&rows);
 
-  ref_t ret(PyW_IntVecToPyList(intvec));
+  ref_t ret(PyW_IntVecToPyList(rows));
   ret.incref();
   return ret.o;
 }
@@ -2406,6 +3001,30 @@ PyObject *choose2_find(const char *title)
   return c2 == NULL ? NULL : c2->get_self();
 }
 
+//------------------------------------------------------------------------
+PyObject *choose2_set_table(PyObject *self, PyObject *table)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+  py_choose2_t *c2 = choose2_find_instance(self);
+  if ( c2 == NULL )
+    Py_RETURN_FALSE;
+  return c2->set_table(table);
+}
+
+//------------------------------------------------------------------------
+bool choose2_sort(PyObject *self, int col, bool descending)
+{
+  py_choose2_t *c2 = choose2_find_instance(self);
+  return c2 != NULL && c2->sort_table(col, descending);
+}
+
+//------------------------------------------------------------------------
+bool choose2_filter(PyObject *self, const char *text, int col)
+{
+  py_choose2_t *c2 = choose2_find_instance(self);
+  return c2 != NULL && c2->filter_table(text, col);
+}
+
 
 //</code(py_kernwin)>
 
@@ -2794,80 +3413,354 @@ public:
     open_tform(form, options);
     return true;
   }
-
-  void close(int options = 0)
+
+  void close(int options = 0)
+  {
+    if ( form != NULL )
+      close_tform(form, options);
+  }
+
+  static PyObject *create()
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    return PyCObject_FromVoidPtr(new plgform_t(), destroy);
+  }
+
+  static void destroy(void *obj)
+  {
+    delete (plgform_t *)obj;
+  }
+};
+//</code(py_plgform)>
+%}
+
+%inline %{
+//<inline(py_plgform)>
+//---------------------------------------------------------------------------
+#define DECL_PLGFORM PYW_GIL_CHECK_LOCKED_SCOPE(); plgform_t *plgform = (plgform_t *) PyCObject_AsVoidPtr(py_link);
+static PyObject *plgform_new()
+{
+  return plgform_t::create();
+}
+
+static bool plgform_show(
+  PyObject *py_link,
+  PyObject *py_obj,
+  const char *caption,
+  int options = FORM_TAB|FORM_MENU|FORM_RESTORE)
+{
+  DECL_PLGFORM;
+  return plgform->show(py_obj, caption, options);
+}
+
+static void plgform_close(
+  PyObject *py_link,
+  int options)
+{
+  DECL_PLGFORM;
+  plgform->close(options);
+}
+#undef DECL_PLGFORM
+//</inline(py_plgform)>
+%}
+
+%{
+//<code(py_custviewer)>
+//---------------------------------------------------------------------------
+// Base class for all custviewer place_t providers
+class custviewer_data_t
+{
+public:
+  virtual void    *get_ud() = 0;
+  virtual place_t *get_min() = 0;
+  virtual place_t *get_max() = 0;
+};
+
+//---------------------------------------------------------------------------
+// Convert a tuple (String, [color, [bgcolor]]) to a simpleline_t
+static bool py_to_simpleline(PyObject *py, simpleline_t &sl)
+{
+  PYW_GIL_CHECK_LOCKED_SCOPE();
+
+  if ( PyString_Check(py) )
+  {
+    sl.line = PyString_AsString(py);
+    return true;
+  }
+  Py_ssize_t sz;
+  if ( !PyTuple_Check(py) || (sz = PyTuple_Size(py)) <= 0 )
+    return false;
+
+  PyObject *py_val = PyTuple_GetItem(py, 0);
+  if ( !PyString_Check(py_val) )
+    return false;
+
+  sl.line = PyString_AsString(py_val);
+
+  if ( (sz > 1) && (py_val = PyTuple_GetItem(py, 1)) && PyLong_Check(py_val)  )
+    sl.color = color_t(PyLong_AsUnsignedLong(py_val));
+
+  if ( (sz > 2) && (py_val = PyTuple_GetItem(py, 2)) && PyLong_Check(py_val)  )
+    sl.bgcolor = PyLong_AsUnsignedLong(py_val);
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// Lines of a simple custom viewer
+class cvdata_lines_t: public custviewer_data_t
+{
+public:
+  virtual ~cvdata_lines_t() {}
+  virtual size_t count() const = 0;
+  virtual bool get_line(size_t nline, simpleline_t *sl) = 0;
+  virtual bool set_line(size_t nline, const simpleline_t &sl) = 0;
+  virtual bool insert_line(size_t nline, const simpleline_t &sl) = 0;
+  virtual bool add_line(const simpleline_t &sl) = 0;
+  virtual bool del_line(size_t nline) = 0;
+  virtual bool patch_line(size_t nline, size_t offs, int value) = 0;
+  virtual void clear_lines() = 0;
+  virtual void set_minmax(size_t start=0, size_t end=size_t(-1)) = 0;
+  virtual size_t to_lineno(place_t *pl) const = 0;
+  // Returns a new place for the line
+  virtual place_t *new_place(size_t nline) const = 0;
+  // Forgets the lines that were cached
+  virtual void invalidate() {}
+};
+
+//---------------------------------------------------------------------------
+class cvdata_simpleline_t: public cvdata_lines_t
+{
+private:
+  strvec_t lines;
+  simpleline_place_t pl_min, pl_max;
+public:
+
+  void *get_ud()
+  {
+    return &lines;
+  }
+
+  place_t *get_min()
+  {
+    return &pl_min;
+  }
+
+  place_t *get_max()
+  {
+    return &pl_max;
+  }
+
+  strvec_t &get_lines()
+  {
+    return lines;
+  }
+
+  void set_minmax(size_t start=0, size_t end=size_t(-1))
+  {
+    if ( start == 0 && end == size_t(-1) )
+    {
+      end = lines.size();
+      pl_min.n = 0;
+      pl_max.n = end == 0 ? 0 : end - 1;
+    }
+    else
+    {
+      pl_min.n = start;
+      pl_max.n = end;
+    }
+  }
+
+  bool set_line(size_t nline, const simpleline_t &sl)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    lines[nline] = sl;
+    return true;
+  }
+
+  bool del_line(size_t nline)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    lines.erase(lines.begin()+nline);
+    return true;
+  }
+
+  bool add_line(const simpleline_t &line)
+  {
+    lines.push_back(line);
+    return true;
+  }
+
+  void add_line(const char *str)
+  {
+    lines.push_back(simpleline_t(str));
+  }
+
+  bool insert_line(size_t nline, const simpleline_t &line)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    lines.insert(lines.begin()+nline, line);
+    return true;
+  }
+
+  bool patch_line(size_t nline, size_t offs, int value)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    qstring &L = lines[nline].line;
+    L[offs] = (uchar) value & 0xFF;
+    return true;
+  }
+
+  size_t to_lineno(place_t *pl) const
+  {
+    return ((simpleline_place_t *)pl)->n;
+  }
+
+  place_t *new_place(size_t nline) const
+  {
+    return new simpleline_place_t(int(nline));
+  }
+
+  bool curline(place_t *pl, size_t *n)
+  {
+    if ( pl == NULL )
+      return false;
+
+    *n = to_lineno(pl);
+    return true;
+  }
+
+  simpleline_t *get_line(size_t nline)
+  {
+    return nline >= lines.size() ? NULL : &lines[nline];
+  }
+
+  simpleline_t *get_line(place_t *pl)
+  {
+    return pl == NULL ? NULL : get_line(((simpleline_place_t *)pl)->n);
+  }
+
+  bool get_line(size_t nline, simpleline_t *sl)
+  {
+    if ( nline >= lines.size() )
+      return false;
+    *sl = lines[nline];
+    return true;
+  }
+
+  size_t count() const
+  {
+    return lines.size();
+  }
+
+  void clear_lines()
+  {
+    lines.clear();
+    set_minmax();
+  }
+};
+
+//---------------------------------------------------------------------------
+// Place of the viewers whose lines are not kept in a strvec_t.
+// 'ud' is the cvdata_lines_t that gives the lines.
+class pyline_place_t: public place_t
+{
+  static cvdata_lines_t *data(void *ud) { return (cvdata_lines_t *)ud; }
+public:
+  size_t n;
+  pyline_place_t(size_t x=0) : n(x) { lnnum = 0; }
+
+  void idaapi print(void * /*ud*/, char *buf, size_t bufsize) const
+  {
+    qsnprintf(buf, bufsize, "%" FMT_64 "u", uint64(n));
+  }
+  uval_t idaapi touval(void * /*ud*/) const
+  {
+    return uval_t(n);
+  }
+  place_t *idaapi clone(void) const
+  {
+    return new pyline_place_t(*this);
+  }
+  void idaapi copyfrom(const place_t *from)
+  {
+    const pyline_place_t *s = (const pyline_place_t *)from;
+    n = s->n;
+    lnnum = s->lnnum;
+  }
+  place_t *idaapi makeplace(void * /*ud*/, uval_t x, short ln) const
+  {
+    pyline_place_t *p = new pyline_place_t(size_t(x));
+    p->lnnum = ln;
+    return p;
+  }
+  int idaapi compare(const place_t *t2) const
+  {
+    size_t n2 = ((const pyline_place_t *)t2)->n;
+    return n < n2 ? -1 : n > n2 ? 1 : 0;
+  }
+  void idaapi adjust(void *ud)
+  {
+    size_t cnt = data(ud)->count();
+    if ( n >= cnt )
+      n = cnt == 0 ? 0 : cnt - 1;
+    lnnum = 0;
+  }
+  bool idaapi prev(void * /*ud*/)
+  {
+    if ( n == 0 )
+      return false;
+    n--;
+    return true;
+  }
+  bool idaapi next(void *ud)
   {
-    if ( form != NULL )
-      close_tform(form, options);
+    if ( n + 1 >= data(ud)->count() )
+      return false;
+    n++;
+    return true;
   }
-
-  static PyObject *create()
+  bool idaapi beginning(void * /*ud*/) const
   {
-    PYW_GIL_CHECK_LOCKED_SCOPE();
-    return PyCObject_FromVoidPtr(new plgform_t(), destroy);
+    return n == 0;
   }
-
-  static void destroy(void *obj)
+  bool idaapi ending(void *ud) const
   {
-    delete (plgform_t *)obj;
+    return n + 1 >= data(ud)->count();
+  }
+  int idaapi generate(
+        void *ud,
+        char *lines[],
+        int maxsize,
+        int *default_lnnum,
+        color_t *prefix_color,
+        bgcolor_t *bg_color) const
+  {
+    simpleline_t sl;
+    if ( maxsize <= 0 || !data(ud)->get_line(n, &sl) )
+      return 0;
+    lines[0] = qstrdup(sl.line.c_str());
+    *prefix_color = sl.color;
+    *bg_color = sl.bgcolor;
+    *default_lnnum = 0;
+    return 1;
   }
-};
-//</code(py_plgform)>
-%}
-
-%inline %{
-//<inline(py_plgform)>
-//---------------------------------------------------------------------------
-#define DECL_PLGFORM PYW_GIL_CHECK_LOCKED_SCOPE(); plgform_t *plgform = (plgform_t *) PyCObject_AsVoidPtr(py_link);
-static PyObject *plgform_new()
-{
-  return plgform_t::create();
-}
-
-static bool plgform_show(
-  PyObject *py_link,
-  PyObject *py_obj,
-  const char *caption,
-  int options = FORM_TAB|FORM_MENU|FORM_RESTORE)
-{
-  DECL_PLGFORM;
-  return plgform->show(py_obj, caption, options);
-}
-
-static void plgform_close(
-  PyObject *py_link,
-  int options)
-{
-  DECL_PLGFORM;
-  plgform->close(options);
-}
-#undef DECL_PLGFORM
-//</inline(py_plgform)>
-%}
-
-%{
-//<code(py_custviewer)>
-//---------------------------------------------------------------------------
-// Base class for all custviewer place_t providers
-class custviewer_data_t
-{
-public:
-  virtual void    *get_ud() = 0;
-  virtual place_t *get_min() = 0;
-  virtual place_t *get_max() = 0;
 };
 
 //---------------------------------------------------------------------------
-class cvdata_simpleline_t: public custviewer_data_t
+// Base of the line stores that use pyline_place_t
+class cvdata_vlines_t: public cvdata_lines_t
 {
 private:
-  strvec_t lines;
-  simpleline_place_t pl_min, pl_max;
+  pyline_place_t pl_min, pl_max;
 public:
-
   void *get_ud()
   {
-    return &lines;
+    return static_cast<cvdata_lines_t *>(this);
   }
 
   place_t *get_min()
@@ -2880,16 +3773,11 @@ public:
     return &pl_max;
   }
 
-  strvec_t &get_lines()
-  {
-    return lines;
-  }
-
   void set_minmax(size_t start=0, size_t end=size_t(-1))
   {
     if ( start == 0 && end == size_t(-1) )
     {
-      end = lines.size();
+      end = count();
       pl_min.n = 0;
       pl_max.n = end == 0 ? 0 : end - 1;
     }
@@ -2900,37 +3788,117 @@ public:
     }
   }
 
-  bool set_line(size_t nline, simpleline_t &sl)
+  size_t to_lineno(place_t *pl) const
+  {
+    return ((pyline_place_t *)pl)->n;
+  }
+
+  place_t *new_place(size_t nline) const
+  {
+    return new pyline_place_t(nline);
+  }
+};
+
+//---------------------------------------------------------------------------
+// Lines kept as consecutive NUL-terminated strings in a single buffer,
+// with an index of offsets. Edited and deleted lines leave unused text
+// behind; it is reclaimed once it is half of the buffer.
+class cvdata_arena_t: public cvdata_vlines_t
+{
+private:
+  struct line_t
+  {
+    size_t off;
+    bgcolor_t bgcolor;
+    color_t color;
+  };
+  qvector<char> text;
+  qvector<line_t> lines;
+  size_t garbage;
+
+  size_t append_text(const char *str)
+  {
+    size_t off = text.size();
+    size_t len = strlen(str) + 1;
+    text.resize(off + len);
+    memcpy(&text[off], str, len);
+    return off;
+  }
+
+  void make_line(line_t *l, const simpleline_t &sl)
+  {
+    l->off = append_text(sl.line.c_str());
+    l->color = sl.color;
+    l->bgcolor = sl.bgcolor;
+  }
+
+  void forget_text(size_t nline)
+  {
+    garbage += strlen(&text[lines[nline].off]) + 1;
+    if ( garbage < 0x10000 || garbage < text.size() / 2 )
+      return;
+
+    qvector<char> packed;
+    packed.swap(text);
+    text.reserve(packed.size() - garbage);
+    for ( size_t i = 0; i < lines.size(); i++ )
+    {
+      if ( i != nline )
+        lines[i].off = append_text(&packed[lines[i].off]);
+    }
+    garbage = 0;
+  }
+
+public:
+  cvdata_arena_t() : garbage(0) {}
+
+  size_t count() const
+  {
+    return lines.size();
+  }
+
+  bool get_line(size_t nline, simpleline_t *sl)
   {
     if ( nline >= lines.size() )
       return false;
-    lines[nline] = sl;
+    const line_t &l = lines[nline];
+    sl->line = &text[l.off];
+    sl->color = l.color;
+    sl->bgcolor = l.bgcolor;
     return true;
   }
 
-  bool del_line(size_t nline)
+  bool set_line(size_t nline, const simpleline_t &sl)
   {
     if ( nline >= lines.size() )
       return false;
-    lines.erase(lines.begin()+nline);
+    forget_text(nline);
+    make_line(&lines[nline], sl);
     return true;
   }
 
-  void add_line(simpleline_t &line)
+  bool insert_line(size_t nline, const simpleline_t &sl)
   {
-    lines.push_back(line);
+    if ( nline >= lines.size() )
+      return false;
+    line_t l;
+    make_line(&l, sl);
+    lines.insert(lines.begin() + nline, l);
+    return true;
   }
 
-  void add_line(const char *str)
+  bool add_line(const simpleline_t &sl)
   {
-    lines.push_back(simpleline_t(str));
+    make_line(&lines.push_back(), sl);
+    return true;
   }
 
-  bool insert_line(size_t nline, simpleline_t &line)
+  bool del_line(size_t nline)
   {
     if ( nline >= lines.size() )
       return false;
-    lines.insert(lines.begin()+nline, line);
+    forget_text(nline);
+    lines.erase(lines.begin() + nline);
     return true;
   }
 
@@ -2938,44 +3906,104 @@ public:
   {
     if ( nline >= lines.size() )
       return false;
-    qstring &L = lines[nline].line;
-    L[offs] = (uchar) value & 0xFF;
+    char *str = &text[lines[nline].off];
+    if ( offs >= strlen(str) )
+      return false;
+    str[offs] = char(value & 0xFF);
     return true;
   }
 
-  const size_t to_lineno(place_t *pl) const
+  void clear_lines()
   {
-    return ((simpleline_place_t *)pl)->n;
+    text.clear();
+    lines.clear();
+    garbage = 0;
+    set_minmax();
   }
+};
 
-  bool curline(place_t *pl, size_t *n)
+//---------------------------------------------------------------------------
+// Lines requested from Python (OnGetLine()) when they are displayed.
+// The last ones are kept in a fixed-size cache indexed by line number.
+class cvdata_provider_t: public cvdata_vlines_t
+{
+private:
+  struct cached_line_t
   {
-    if ( pl == NULL )
-      return false;
+    size_t n;
+    simpleline_t sl;
+  };
+  qvector<cached_line_t> cache;
+  size_t nlines;
+  PyObject *self;
 
-    *n = to_lineno(pl);
-    return true;
+public:
+  cvdata_provider_t(size_t cache_size) : nlines(0), self(NULL)
+  {
+    cache.resize(qmax(cache_size, size_t(1)));
+    invalidate();
   }
 
-  simpleline_t *get_line(size_t nline)
+  void set_self(PyObject *py_self)
   {
-    return nline >= lines.size() ? NULL : &lines[nline];
+    self = py_self;
   }
 
-  simpleline_t *get_line(place_t *pl)
+  void set_count(size_t n)
   {
-    return pl == NULL ? NULL : get_line(((simpleline_place_t *)pl)->n);
+    nlines = n;
+    invalidate();
+    set_minmax();
   }
 
-  const size_t count() const
+  void invalidate()
   {
-    return lines.size();
+    for ( size_t i = 0; i < cache.size(); i++ )
+      cache[i].n = size_t(-1);
+  }
+
+  size_t count() const
+  {
+    return nlines;
+  }
+
+  bool get_line(size_t nline, simpleline_t *sl)
+  {
+    if ( nline >= nlines )
+      return false;
+    cached_line_t &cl = cache[nline % cache.size()];
+    if ( cl.n != nline )
+    {
+      if ( self == NULL )
+        return false;
+      PYW_GIL_GET;
+      newref_t py_line(
+              PyObject_CallMethod(
+                      self,
+                      (char *)S_ON_GET_LINE,
+                      PY_FMT64,
+                      pyul_t(nline)));
+      PyW_ShowCbErr(S_ON_GET_LINE);
+      simpleline_t line;
+      if ( py_line == NULL || !py_to_simpleline(py_line.o, line) )
+        return false;
+      cl.sl = line;
+      cl.n = nline;
+    }
+    *sl = cl.sl;
+    return true;
   }
 
+  // The lines belong to Python
+  bool set_line(size_t, const simpleline_t &) { return false; }
+  bool insert_line(size_t, const simpleline_t &) { return false; }
+  bool add_line(const simpleline_t &) { return false; }
+  bool del_line(size_t) { return false; }
+  bool patch_line(size_t, size_t, int) { return false; }
+
   void clear_lines()
   {
-    lines.clear();
-    set_minmax();
+    set_count(0);
   }
 };
 
@@ -3388,41 +4416,20 @@ size_t customviewer_t::_global_popup_id = 0;
 //---------------------------------------------------------------------------
 class py_simplecustview_t: public customviewer_t
 {
+public:
+  // How the lines are stored (see simplecustviewer_t.Create())
+  enum
+  {
+    LINES_LIST,
+    LINES_COMPACT,
+    LINES_PROVIDER,
+  };
 private:
-  cvdata_simpleline_t data;
+  cvdata_lines_t *data;
+  int lines_mode;
   PyObject *py_self, *py_this, *py_last_link;
   int features;
 
-  //--------------------------------------------------------------------------
-  // Convert a tuple (String, [color, [bgcolor]]) to a simpleline_t
-  static bool py_to_simpleline(PyObject *py, simpleline_t &sl)
-  {
-    PYW_GIL_CHECK_LOCKED_SCOPE();
-
-    if ( PyString_Check(py) )
-    {
-      sl.line = PyString_AsString(py);
-      return true;
-    }
-    Py_ssize_t sz;
-    if ( !PyTuple_Check(py) || (sz = PyTuple_Size(py)) <= 0 )
-      return false;
-
-    PyObject *py_val = PyTuple_GetItem(py, 0);
-    if ( !PyString_Check(py_val) )
-      return false;
-
-    sl.line = PyString_AsString(py_val);
-
-    if ( (sz > 1) && (py_val = PyTuple_GetItem(py, 1)) && PyLong_Check(py_val)  )
-      sl.color = color_t(PyLong_AsUnsignedLong(py_val));
-
-    if ( (sz > 2) && (py_val = PyTuple_GetItem(py, 2)) && PyLong_Check(py_val)  )
-      sl.bgcolor = PyLong_AsUnsignedLong(py_val);
-
-    return true;
-  }
-
   //
   // Callbacks
   //
@@ -3505,7 +4512,7 @@ private:
   // OnHint
   virtual bool on_hint(place_t *place, int *important_lines, qstring &hint)
   {
-    size_t ln = data.to_lineno(place);
+    size_t ln = data->to_lineno(place);
     PYW_GIL_CHECK_LOCKED_SCOPE();
     newref_t py_result(
             PyObject_CallMethod(
@@ -3543,17 +4550,18 @@ private:
   //--------------------------------------------------------------------------
   void refresh_range()
   {
-    data.set_minmax();
+    data->set_minmax();
     set_range();
   }
 
 public:
-  py_simplecustview_t()
+  py_simplecustview_t() : data(NULL), lines_mode(LINES_LIST)
   {
     py_this = py_self = py_last_link = NULL;
   }
   ~py_simplecustview_t()
   {
+    delete data;
   }
 
   //--------------------------------------------------------------------------
@@ -3564,13 +4572,13 @@ public:
     if ( !py_to_simpleline(py_sl, sl) )
       return false;
 
-    return data.set_line(nline, sl);
+    return data->set_line(nline, sl);
   }
 
   // Low level: patches a line string directly
   bool patch_line(size_t nline, size_t offs, int value)
   {
-    return data.patch_line(nline, offs, value);
+    return data->patch_line(nline, offs, value);
   }
 
   // Insert a line
@@ -3579,24 +4587,58 @@ public:
     simpleline_t sl;
     if ( !py_to_simpleline(py_sl, sl) )
       return false;
-    return data.insert_line(nline, sl);
+    return data->insert_line(nline, sl);
   }
 
   // Adds a line tuple
   bool add_line(PyObject *py_sl)
   {
     simpleline_t sl;
-    if ( !py_to_simpleline(py_sl, sl) )
+    if ( !py_to_simpleline(py_sl, sl) || !data->add_line(sl) )
       return false;
-    data.add_line(sl);
     refresh_range();
     return true;
   }
 
+  // Adds the line tuples of a sequence, stops at the first invalid one.
+  // Returns the number of lines added
+  size_t add_lines(PyObject *py_lines)
+  {
+    PYW_GIL_CHECK_LOCKED_SCOPE();
+    newref_t seq(PySequence_Fast(py_lines, "a list of lines is expected"));
+    if ( seq == NULL )
+    {
+      PyErr_Clear();
+      return 0;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq.o);
+    PyObject **items = PySequence_Fast_ITEMS(seq.o);
+    size_t added = 0;
+    for ( ; added < size_t(n); added++ )
+    {
+      simpleline_t sl;
+      if ( !py_to_simpleline(items[added], sl) || !data->add_line(sl) )
+        break;
+    }
+    if ( added > 0 )
+      refresh_range();
+    return added;
+  }
+
+  // Sets the number of lines of a viewer whose lines come from OnGetLine()
+  bool set_line_count(size_t n)
+  {
+    if ( lines_mode != LINES_PROVIDER )
+      return false;
+    ((cvdata_provider_t *)data)->set_count(n);
+    set_range();
+    return true;
+  }
+
   //--------------------------------------------------------------------------
   bool del_line(size_t nline)
   {
-    bool ok = data.del_line(nline);
+    bool ok = data->del_line(nline);
     if ( ok )
       refresh_range();
     return ok;
@@ -3612,48 +4654,84 @@ public:
     PYW_GIL_CHECK_LOCKED_SCOPE();
     if ( pl == NULL )
       Py_RETURN_NONE;
-    return Py_BuildValue("(" PY_FMT64 "ii)", pyul_t(data.to_lineno(pl)), x, y);
+    return Py_BuildValue("(" PY_FMT64 "ii)", pyul_t(data->to_lineno(pl)), x, y);
   }
 
   //--------------------------------------------------------------------------
   // Returns the line tuple
   PyObject *get_line(size_t nline)
   {
-    simpleline_t *r = data.get_line(nline);
+    simpleline_t r;
+    bool ok = data->get_line(nline, &r);
     PYW_GIL_CHECK_LOCKED_SCOPE();
-    if ( r == NULL )
+    if ( !ok )
       Py_RETURN_NONE;
-    return Py_BuildValue("(sII)", r->line.c_str(), (unsigned int)r->color, (unsigned int)r->bgcolor);
+    return Py_BuildValue("(sII)", r.line.c_str(), (unsigned int)r.color, (unsigned int)r.bgcolor);
   }
 
   // Returns the count of lines
   const size_t count() const
   {
-    return data.count();
+    return data == NULL ? 0 : data->count();
   }
 
   // Clears lines
   void clear()
   {
-    data.clear_lines();
+    data->clear_lines();
     refresh_range();
   }
 
+  //--------------------------------------------------------------------------
+  bool refresh()
+  {
+    // Lines provided by Python may have changed
+    data->invalidate();
+    return customviewer_t::refresh();
+  }
+
   //--------------------------------------------------------------------------
   bool jumpto(size_t ln, int x, int y)
   {
-    simpleline_place_t l(ln);
-    return customviewer_t::jumpto(&l, x, y);
+    place_t *pl = data->new_place(ln);
+    bool ok = customviewer_t::jumpto(pl, x, y);
+    delete pl;
+    return ok;
   }
 
   //--------------------------------------------------------------------------
   // Initializes and links the Python object to this class
-  bool init(PyObject *py_link, const char *title)
+  bool init(
+        PyObject *py_link,
+        const char *title,
+        int mode = LINES_LIST,
+        size_t cache_size = 1024)
   {
     // Already created?
     if ( _form != NULL )
       return true;
 
+    // The line store is kept when the view is re-created
+    if ( data == NULL )
+    {
+      lines_mode = mode;
+      switch ( mode )
+      {
+        case LINES_COMPACT:
+          data = new cvdata_arena_t();
+          break;
+        case LINES_PROVIDER:
+          data = new cvdata_provider_t(cache_size);
+          break;
+        default:
+          lines_mode = LINES_LIST;
+          data = new cvdata_simpleline_t();
+          break;
+      }
+    }
+    if ( lines_mode == LINES_PROVIDER )
+      ((cvdata_provider_t *)data)->set_self(py_link);
+
     // Probe callbacks
     features = 0;
     static struct
@@ -3678,7 +4756,7 @@ public:
         features |= cbtable[i].feature;
     }
 
-    if ( !create(title, features, &data) )
+    if ( !create(title, features, data) )
       return false;
 
     // Hold a reference to this object
@@ -3699,7 +4777,7 @@ public:
     if ( _form == NULL && py_last_link != NULL )
     {
       // Re-create the view (with same previous parameters)
-      if ( !init(py_last_link, _title.c_str()) )
+      if ( !init(py_last_link, _title.c_str(), lines_mode) )
         return false;
     }
     return customviewer_t::show();
@@ -3716,9 +4794,9 @@ public:
       return false;
 
     if ( y1 != NULL )
-      *y1 = data.to_lineno(p1.at);
+      *y1 = data->to_lineno(p1.at);
     if ( y2 != NULL )
-      *y2 = data.to_lineno(p2.at);
+      *y2 = data->to_lineno(p2.at);
     if ( x1 != NULL )
       *x1 = size_t(p1.x);
     if ( x2 != NULL )
@@ -3767,11 +4845,15 @@ static void py_remove_command_interpreter(int cli_idx)
 //
 // Pywraps Simple Custom Viewer functions
 //
-PyObject *pyscv_init(PyObject *py_link, const char *title)
+PyObject *pyscv_init(
+        PyObject *py_link,
+        const char *title,
+        int lines_mode = 0,
+        size_t cache_size = 1024)
 {
   PYW_GIL_CHECK_LOCKED_SCOPE();
   py_simplecustview_t *_this = new py_simplecustview_t();
-  bool ok = _this->init(py_link, title);
+  bool ok = _this->init(py_link, title, lines_mode, cache_size);
   if ( !ok )
   {
     delete _this;
@@ -3913,6 +4995,21 @@ bool pyscv_add_line(PyObject *py_this, PyObject *py_sl)
   return _this == NULL ? false : _this->add_line(py_sl);
 }
 
+//--------------------------------------------------------------------------
+// Adds a list of line tuples
+size_t pyscv_add_lines(PyObject *py_this, PyObject *py_lines)
+{
+  DECL_THIS;
+  return _this == NULL ? 0 : _this->add_lines(py_lines);
+}
+
+//--------------------------------------------------------------------------
+bool pyscv_set_line_count(PyObject *py_this, size_t count)
+{
+  DECL_THIS;
+  return _this == NULL ? false : _this->set_line_count(count);
+}
+
 //--------------------------------------------------------------------------
 bool pyscv_insert_line(PyObject *py_this, size_t nline, PyObject *py_sl)
 {
@@ -4080,7 +5177,7 @@ class Choose2(object):
 
     def __init__(self, title, cols, flags=0, popup_names=None,
                  icon=-1, x1=-1, y1=-1, x2=-1, y2=-1, deflt=-1,
-                 embedded=False, width=None, height=None):
+                 embedded=False, width=None, height=None, table=None):
         """
         Constructs a chooser window.
         @param title: The chooser title
@@ -4094,6 +5191,7 @@ class Choose2(object):
         @param embedded: Create as embedded chooser
         @param width: Embedded chooser width
         @param height: Embedded chooser height
+        @param table: The rows, given up front as a list of columns (see SetTable())
         """
         self.title = title
         self.flags = flags
@@ -4106,6 +5204,7 @@ class Choose2(object):
         self.x2 = x2
         self.y2 = y2
         self.embedded = embedded
+        self.table = table
         if embedded:
 	        self.x1 = width
 	        self.y1 = height
@@ -4159,7 +5258,10 @@ class Choose2(object):
 
 
     def Refresh(self):
-        """Causes the refresh callback to trigger"""
+        """
+        Causes the refresh callback to trigger.
+        The rows cached from OnGetLines() are requested again.
+        """
         return _idaapi.choose2_refresh(self)
 
 
@@ -4168,6 +5270,43 @@ class Choose2(object):
         return _idaapi.choose2_close(self)
 
 
+    def SetTable(self, table):
+        """
+        Gives the rows up front. The table is copied when the chooser is
+        created and is then displayed, sorted and filtered without calling
+        OnGetSize() and OnGetLine(), which become optional. The line numbers
+        passed to the other callbacks are indices in the table.
+
+        @param table: A list with one entry per column: either a list (of
+            str, or of numbers) or an array.array of numbers.
+            Numbers are displayed in hexadecimal in the CHCOL_HEX columns.
+        @return: False if the chooser is not displayed yet (the table will be
+            used when it is); raises ValueError if the table is invalid
+        """
+        self.table = table
+        return _idaapi.choose2_set_table(self, table)
+
+
+    def Sort(self, col, descending=False):
+        """
+        Sorts the rows of the table (strings are compared case insensitively,
+        as Filter() does)
+        @param col: Column number, or -1 to restore the table order
+        @return: False if the chooser has no table or is not displayed
+        """
+        return _idaapi.choose2_sort(self, col, descending)
+
+
+    def Filter(self, text, col=-1):
+        """
+        Only displays the rows of the table containing a text (case insensitive)
+        @param text: The text to look for, an empty string displays all the rows
+        @param col: Column number, or -1 to look in all the columns
+        @return: False if the chooser has no table or is not displayed
+        """
+        return _idaapi.choose2_filter(self, text, col)
+
+
     def AddCommand(self,
                    caption,
                    flags = _idaapi.CHOOSER_POPUP_MENU,
@@ -4200,16 +5339,31 @@ class Choose2(object):
 #
 #    def OnGetLine(self, n):
 #        """Called when the chooser window requires lines.
-#        This callback is mandatory.
+#        This callback is mandatory unless OnGetLines() is implemented
+#        or the chooser has a table.
 #        @param n: Line number (0-based)
 #        @return: The user should return a list with ncols elements.
 #            example: a list [col1, col2, col3, ...] describing the n-th line
 #        """
 #        return ["col1 val", "col2 val"]
 #
+#    def OnGetLines(self, start, count):
+#        """Called when the chooser window requires a block of lines.
+#        If implemented, it is used instead of OnGetLine() and the returned
+#        rows, as well as OnGetSize(), are cached until the chooser is
+#        refreshed or edited (Refresh(), OnRefresh(), OnEditLine(), ...)
+#        @param start: First line number (0-based)
+#        @param count: Maximum number of lines to return
+#        @return: A list of up to count rows. Each row is either a list
+#            of ncols elements (as returned by OnGetLine()) or a tuple
+#            (cols, attrs) where attrs is what OnGetLineAttr() would return.
+#            OnGetLine() is used for the rows that were not returned.
+#        """
+#        return [ self.items[n] for n in xrange(start, min(start + count, len(self.items))) ]
+#
 #    def OnGetSize(self):
 #        """Returns the element count.
-#        This callback is mandatory.
+#        This callback is mandatory, unless the chooser has a table.
 #        @return: Number of elements
 #        """
 #        return len(self.the_list)
@@ -5861,6 +7015,14 @@ class cli_t(pyidc_opaque_object_t):
 #<pycode(py_custviewer)>
 class simplecustviewer_t(object):
     """The base class for implementing simple custom viewers"""
+
+    LINES_LIST     = 0
+    """Lines are kept in a list of strings (default)"""
+    LINES_COMPACT  = 1
+    """Lines are packed in a single buffer. Suited to large, mostly appended, views"""
+    LINES_PROVIDER = 2
+    """Lines are requested with OnGetLine() when displayed. Use SetLineCount() to set their number"""
+
     def __init__(self):
         self.__this = None
 
@@ -5875,16 +7037,18 @@ class simplecustviewer_t(object):
     def __make_sl_arg(line, fgcolor=None, bgcolor=None):
         return line if (fgcolor is None and bgcolor is None) else (line, fgcolor, bgcolor)
 
-    def Create(self, title):
+    def Create(self, title, lines=LINES_LIST, cache_size=1024):
         """
         Creates the custom view. This should be the first method called after instantiation
 
         @param title: The title of the view
+        @param lines: How the lines are stored. One of LINES_LIST, LINES_COMPACT or LINES_PROVIDER
+        @param cache_size: With LINES_PROVIDER, the number of lines kept after OnGetLine() returned them
         @return: Boolean whether it succeeds or fails. It may fail if a window with the same title is already open.
                  In this case better close existing windows
         """
         self.title = title
-        self.__this = _idaapi.pyscv_init(self, title)
+        self.__this = _idaapi.pyscv_init(self, title, lines, cache_size)
         return True if self.__this else False
 
     def Close(self):
@@ -5934,6 +7098,22 @@ class simplecustviewer_t(object):
         """
         return _idaapi.pyscv_add_line(self.__this, self.__make_sl_arg(line, fgcolor, bgcolor))
 
+    def AddLines(self, lines):
+        """
+        Adds several lines to the view at once.
+        @param lines: A list of strings or of tuples (line, fgcolor, bgcolor)
+        @return: The number of lines added. It stops at the first invalid line
+        """
+        return _idaapi.pyscv_add_lines(self.__this, lines)
+
+    def SetLineCount(self, count):
+        """
+        Sets the number of lines of a view created with LINES_PROVIDER.
+        The cached lines are forgotten.
+        @return: Boolean
+        """
+        return _idaapi.pyscv_set_line_count(self.__this, count)
+
     def InsertLine(self, lineno, line, fgcolor=None, bgcolor=None):
         """
         Inserts a line in the given position
@@ -6073,6 +7253,14 @@ class simplecustviewer_t(object):
 #        """
 #        print "OnPopup"
 #
+#    def OnGetLine(self, lineno):
+#        """
+#        Line requested by a view created with LINES_PROVIDER
+#        @param lineno: The line number (zero based)
+#        @return: A string or a tuple (line, fgcolor, bgcolor)
+#        """
+#        return "line %d" % lineno
+#
 #    def OnHint(self, lineno):
 #        """
 #        Hint requested for the given line number.